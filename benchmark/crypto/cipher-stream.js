@@ -5,7 +5,7 @@ var bench = common.createBenchmark(main, {
   cipher: [ 'AES192', 'AES256' ],
   type: ['asc', 'utf', 'buf'],
   len: [2, 1024, 102400, 1024 * 1024],
-  api: ['legacy', 'stream']
+  api: ['legacy', 'stream', 'into']
 });
 
 function main(conf) {
@@ -54,7 +54,17 @@ function main(conf) {
       throw new Error('unknown message type: ' + conf.type);
   }
 
-  var fn = api === 'stream' ? streamWrite : legacyWrite;
+  var fn;
+  switch (api) {
+    case 'stream':
+      fn = streamWrite;
+      break;
+    case 'into':
+      fn = intoWrite;
+      break;
+    default:
+      fn = legacyWrite;
+  }
 
   // write data as fast as possible to alice, and have bob decrypt.
   // use old API for comparison to v0.8
@@ -99,3 +109,22 @@ function legacyWrite(alice, bob, message, encoding, writes) {
   var gbits = written / (1024 * 1024 * 1024);
   bench.end(gbits);
 }
+
+// same as legacyWrite but without allocating a buffer per update
+function intoWrite(alice, bob, message, encoding, writes) {
+  if (!Buffer.isBuffer(message))
+    message = new Buffer(message, encoding);
+  var enc = new Buffer(message.length + 32);
+  var dec = new Buffer(message.length + 64);
+  var written = 0;
+  for (var i = 0; i < writes; i++) {
+    var n = alice.updateInto(message, 0, message.length, enc, 0);
+    written += bob.updateInto(enc, 0, n, dec, 0);
+  }
+  var n = alice.finalInto(enc, 0);
+  written += bob.updateInto(enc, 0, n, dec, 0);
+  written += bob.finalInto(dec, 0);
+  var bits = written * 8;
+  var gbits = bits / (1024 * 1024 * 1024);
+  bench.end(gbits);
+}
@@ -0,0 +1,84 @@
+// signing benchmark
+// hmacs many small messages, one hmac object per message or one batch call
+var common = require('../common.js');
+var crypto = require('crypto');
+
+var bench = common.createBenchmark(main, {
+  n: [100000],
+  batch: [1, 16, 256],
+  algo: ['sha256', 'sha1'],
+  len: [16, 128, 1024],
+  api: ['hmac', 'batch', 'batch-async']
+});
+
+function main(conf) {
+  var n = +conf.n;
+  var batch = +conf.batch;
+  var key = new Buffer('0123456789abcdef0123456789abcdef');
+  var messages = [];
+
+  for (var i = 0; i < batch; i++) {
+    var message = new Buffer(+conf.len);
+    message.fill(i & 0xff);
+    messages.push(message);
+  }
+
+  var fn;
+  switch (conf.api) {
+    case 'hmac':
+      fn = single;
+      break;
+    case 'batch':
+      fn = batched;
+      break;
+    case 'batch-async':
+      fn = batchedAsync;
+      break;
+    default:
+      throw new Error('unknown api: ' + conf.api);
+  }
+
+  bench.start();
+  fn(conf.algo, key, messages, Math.ceil(n / batch), function() {
+    bench.end(n);
+  });
+}
+
+function single(algo, key, messages, rounds, cb) {
+  while (rounds-- > 0) {
+    for (var i = 0; i < messages.length; i++)
+      crypto.createHmac(algo, key).update(messages[i]).digest();
+  }
+  cb();
+}
+
+function batched(algo, key, messages, rounds, cb) {
+  while (rounds-- > 0)
+    crypto.hmacBatch(algo, key, messages);
+  cb();
+}
+
+function batchedAsync(algo, key, messages, rounds, cb) {
+  // Keep a few batches in flight so that the thread pool stays busy.
+  var inflight = 0;
+  var concurrency = Math.min(rounds, 4);
+
+  for (var i = 0; i < concurrency; i++)
+    next();
+
+  function next() {
+    if (rounds === 0) {
+      if (inflight === 0)
+        cb();
+      return;
+    }
+    rounds--;
+    inflight++;
+    crypto.hmacBatch(algo, key, messages, function(err) {
+      if (err)
+        throw err;
+      inflight--;
+      next();
+    });
+  }
+}
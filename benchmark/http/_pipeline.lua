@@ -0,0 +1,14 @@
+-- Sends PIPELINE_DEPTH requests for the benchmark URL at a time.
+
+init = function(args)
+   local depth = tonumber(os.getenv("PIPELINE_DEPTH")) or 1
+   local r = {}
+   for i = 1, depth do
+      r[i] = wrk.format()
+   end
+   req = table.concat(r)
+end
+
+request = function()
+   return req
+end
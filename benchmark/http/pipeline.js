@@ -0,0 +1,26 @@
+var common = require('../common.js');
+var path = require('path');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  depth: [1, 4, 16],  // requests in flight per connection
+  length: [4, 1024],
+  c: [50],
+  native: [0, 1]  // server.nativeParsing
+});
+
+function main(conf) {
+  process.env.PORT = PORT;
+  process.env.PIPELINE_DEPTH = conf.depth;
+  var server = require('../http_simple.js');
+  server.nativeParsing = !!conf.native;
+  setTimeout(function() {
+    var url = '/bytes/' + conf.length + '/0';
+    var args = ['-d', '10s', '-t', 8, '-c', conf.c,
+                '-s', path.join(__dirname, '_pipeline.lua')];
+
+    bench.http(url, args, function() {
+      server.close();
+    });
+  }, 2000);
+}
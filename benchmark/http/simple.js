@@ -6,13 +6,15 @@ var bench = common.createBenchmark(main, {
   type: ['bytes', 'buffer'],
   length: [4, 1024, 102400],
   chunks: [0, 1, 4],  // chunks=0 means 'no chunked encoding'.
-  c: [50, 500]
+  c: [50, 500],
+  native: [0, 1]  // server.nativeParsing
 });
 
 function main(conf) {
   process.env.PORT = PORT;
   var spawn = require('child_process').spawn;
   var server = require('../http_simple.js');
+  server.nativeParsing = !!conf.native;
   setTimeout(function() {
     var path = '/' + conf.type + '/' + conf.length + '/' + conf.chunks;
     var args = ['-d', '10s', '-t', 8, '-c', conf.c];
@@ -22,14 +22,17 @@
 
 var fs = require('fs');
 var path = require('path');
+var spawnSync = require('child_process').spawnSync;
 var common = require('../common.js');
 var packageJson = '{"main": "index.js"}';
 
 var tmpDirectory = path.join(__dirname, '..', 'tmp');
 var benchmarkDirectory = path.join(tmpDirectory, 'nodejs-benchmark-module');
+var resolveCacheFile = path.join(__dirname, '..', 'module-loader.cache');
 
 var bench = common.createBenchmark(main, {
-  thousands: [50]
+  thousands: [50],
+  cache: ['off', 'on']
 });
 
 function main(conf) {
@@ -44,15 +47,37 @@ function main(conf) {
     fs.writeFileSync(benchmarkDirectory + i + '/index.js', 'module.exports = "";');
   }
 
+  if (conf.cache === 'on')
+    warmResolveCache(n);
+
   measure(n);
 }
 
+// Fill NODE_RESOLVE_CACHE from another process, like a previous run would.
+function warmResolveCache(n) {
+  try { fs.unlinkSync(resolveCacheFile); } catch (e) {}
+
+  var env = {};
+  for (var key in process.env)
+    env[key] = process.env[key];
+  env.NODE_RESOLVE_CACHE = resolveCacheFile;
+
+  var script = 'for (var i = 0; i <= ' + n + '; i++) ' +
+               'require(' + JSON.stringify(benchmarkDirectory) + ' + i);';
+  var child = spawnSync(process.execPath, ['-e', script], { env: env });
+  if (child.status !== 0)
+    throw new Error('Failed to warm the resolve cache: ' + child.stderr);
+
+  require('module')._resolveCache = resolveCacheFile;
+}
+
 function measure(n) {
   bench.start();
   for (var i = 0; i <= n; i++) {
     require(benchmarkDirectory + i);
   }
   bench.end(n / 1e3);
+  try { fs.unlinkSync(resolveCacheFile); } catch (e) {}
 }
 
 function rmrf(location) {
@@ -1,40 +1,104 @@
 var common = require('../common.js');
 var spawn = require('child_process').spawn;
+var fs = require('fs');
 var path = require('path');
+var util = require('util');
 var emptyJsFile = path.resolve(__dirname, '../../test/fixtures/semicolon.js');
+var tmpDirectory = path.resolve(__dirname, '../tmp');
+var modulesDirectory = path.join(tmpDirectory, 'startup-modules');
+var cacheDirectory = path.join(tmpDirectory, 'startup-cache');
 var starts = 100;
 var i = 0;
 var start;
 
 var bench = common.createBenchmark(startNode, {
+  script: ['empty', 'modules'],
+  cache: ['off', 'on'],
   dur: [1]
 });
 
+// An entry point that requires `count` modules, each of them a few hundred
+// lines of functions, to give the parser and compiler something to chew on.
+function createModules(count) {
+  rmrf(modulesDirectory);
+  try { fs.mkdirSync(tmpDirectory); } catch (e) {}
+  fs.mkdirSync(modulesDirectory);
+
+  var main = '';
+  for (var i = 0; i < count; i++) {
+    var body = '';
+    for (var j = 0; j < 50; j++) {
+      body += util.format('exports.f%d = function(a, b) {\n' +
+                          '  var s = 0;\n' +
+                          '  for (var i = 0; i < a.length; i++)\n' +
+                          '    s += a[i] * b + %d;\n' +
+                          '  return { sum: s, name: "m%d.f%d" };\n' +
+                          '};\n', j, j, i, j);
+    }
+    fs.writeFileSync(path.join(modulesDirectory, 'm' + i + '.js'), body);
+    main += 'require("./m' + i + '");\n';
+  }
+  var index = path.join(modulesDirectory, 'index.js');
+  fs.writeFileSync(index, main);
+  return index;
+}
+
 function startNode(conf) {
   var dur = +conf.dur;
   var go = true;
   var starts = 0;
   var open = 0;
+  var script = conf.script === 'modules' ? createModules(500) : emptyJsFile;
+  var options = { env: util._extend({}, process.env) };
+
+  delete options.env.NODE_COMPILE_CACHE;
+  if (conf.cache === 'on') {
+    rmrf(cacheDirectory);
+    options.env.NODE_COMPILE_CACHE = cacheDirectory;
+  }
+
+  // Untimed run to fill the cache and the OS page cache
+  spawnNode(function() {
+    setTimeout(function() {
+      go = false;
+    }, dur * 1000);
 
-  setTimeout(function() {
-    go = false;
-  }, dur * 1000);
+    bench.start();
+    spawnNode(onExit);
+  });
 
-  bench.start();
-  start();
+  function onExit() {
+    starts++;
 
-  function start() {
-    var node = spawn(process.execPath || process.argv[0], [emptyJsFile]);
+    if (go)
+      spawnNode(onExit);
+    else
+      bench.end(starts);
+  }
+
+  function spawnNode(cb) {
+    var node = spawn(process.execPath || process.argv[0], [script], options);
     node.on('exit', function(exitCode) {
       if (exitCode !== 0) {
         throw new Error('Error during node startup');
       }
-      starts++;
+      cb();
+    });
+  }
+}
 
-      if (go)
-        start();
-      else
-        bench.end(starts);
+function rmrf(location) {
+  if (fs.existsSync(location)) {
+    var things = fs.readdirSync(location);
+    things.forEach(function(thing) {
+      var cur = path.join(location, thing),
+          isDirectory = fs.statSync(cur).isDirectory();
+      if (isDirectory) {
+        rmrf(cur);
+        return;
+      }
+      fs.unlinkSync(cur);
     });
+    fs.rmdirSync(location);
   }
 }
@@ -1,14 +1,19 @@
 var common = require('../common.js');
+var timers = require('timers');
 
 var bench = common.createBenchmark(main, {
-  thousands: [500],
-  type: ['depth', 'breadth']
+  thousands: [500, 1000],
+  type: ['depth', 'breadth', 'idle', 'idle-wheel']
 });
 
 function main(conf) {
   var n = +conf.thousands * 1e3;
   if (conf.type === 'breadth')
     breadth(n);
+  else if (conf.type === 'idle')
+    idle(n, 0);
+  else if (conf.type === 'idle-wheel')
+    idle(n, 10);
   else
     depth(n);
 }
@@ -38,3 +43,27 @@ function breadth(N) {
     setTimeout(cb);
   }
 }
+
+// Idle timeouts the way sockets use them: many distinct durations, each
+// refreshed once before it expires.
+function idle(N, resolution) {
+  var n = 0;
+  var items = new Array(N);
+  var i;
+
+  timers.setIdleTimeoutResolution(resolution);
+
+  bench.start();
+  function cb() {
+    n++;
+    if (n === N)
+      bench.end(N / 1e3);
+  }
+  for (i = 0; i < N; i++) {
+    items[i] = { _onTimeout: cb };
+    timers.enroll(items[i], 1 + i % 1000);
+    timers.active(items[i]);
+  }
+  for (i = 0; i < N; i++)
+    timers.active(items[i]);
+}
@@ -9,6 +9,16 @@ var urls = [
   'some.ran/dom/url.thing?oh=yes#whoo'
 ];
 
+// What a routing layer sees: request paths and absolute URLs with
+// nothing that needs escaping.
+var simpleUrls = [
+  '/api/v2/users/1234/orders?status=open&sort=desc',
+  '/static/js/app.7f3e9c1b.js',
+  '/search?q=node.js#results',
+  'http://localhost:8080/api/v2/users/1234',
+  'https://Encrypted.Google.com/search?q=url&hl=en#top'
+];
+
 var paths = [
   '../foo/bar?baz=boom',
   'foo/bar',
@@ -17,6 +27,10 @@ var paths = [
 ];
 
 benchmark('parse()', url.parse);
+benchmark('parse(simple)', url.parse, simpleUrls);
+benchmark('parse(simple, true)', function(u) {
+  url.parse(u, true);
+}, simpleUrls);
 benchmark('format()', url.format);
 paths.forEach(function(p) {
   benchmark('resolve("' + p + '")', function(u) {
@@ -24,10 +38,11 @@ paths.forEach(function(p) {
   });
 });
 
-function benchmark(name, fun) {
+function benchmark(name, fun, inputs) {
+  inputs = inputs || urls;
   var timestamp = process.hrtime();
   for (var i = 0; i < n; ++i) {
-    for (var j = 0, k = urls.length; j < k; ++j) fun(urls[j]);
+    for (var j = 0, k = inputs.length; j < k; ++j) fun(inputs[j]);
   }
   timestamp = process.hrtime(timestamp);
 
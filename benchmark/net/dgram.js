@@ -6,10 +6,13 @@ var PORT = common.PORT;
 // `num` is the number of send requests to queue up each time.
 // Keep it reasonably high (>10) otherwise you're benchmarking the speed of
 // event loop cycles more than anything else.
+// With `batch`, the socket reads with recvBatch and the `num` datagrams go
+// out with a single sendBatch() call.
 var bench = common.createBenchmark(main, {
   len: [1, 64, 256, 1024],
   num: [100],
   type: ['send', 'recv'],
+  batch: ['false', 'true'],
   dur: [5]
 });
 
@@ -19,12 +22,14 @@ var num;
 var type;
 var chunk;
 var encoding;
+var batch;
 
 function main(conf) {
   dur = +conf.dur;
   len = +conf.len;
   num = +conf.num;
   type = conf.type;
+  batch = conf.batch === 'true';
   chunk = new Buffer(len);
   server();
 }
@@ -34,7 +39,11 @@ var dgram = require('dgram');
 function server() {
   var sent = 0;
   var received = 0;
-  var socket = dgram.createSocket('udp4');
+  var socket = dgram.createSocket({ type: 'udp4', recvBatch: batch });
+
+  var messages = [];
+  for (var i = 0; i < num; i++)
+    messages.push({ buffer: chunk, port: PORT, address: '127.0.0.1' });
 
   function onsend() {
     if (sent++ % num == 0)
@@ -42,9 +51,19 @@ function server() {
         socket.send(chunk, 0, chunk.length, PORT, '127.0.0.1', onsend);
   }
 
+  function onsendbatch() {
+    socket.sendBatch(messages, function() {
+      sent += num;
+      onsendbatch();
+    });
+  }
+
   socket.on('listening', function() {
     bench.start();
-    onsend();
+    if (batch)
+      onsendbatch();
+    else
+      onsend();
 
     setTimeout(function() {
       var bytes = (type === 'send' ? sent : received) * chunk.length;
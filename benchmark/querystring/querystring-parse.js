@@ -0,0 +1,30 @@
+var common = require('../common.js');
+var querystring = require('querystring');
+
+var inputs = {
+  // What a form post or an API call usually looks like.
+  noencode: 'foo=bar&baz=quux&xyzzy=thud&page=3&per_page=50&sort=desc',
+  // Spaces and reserved characters, all ASCII.
+  encodeascii: 'foo=b%61r&baz=qu%20ux&xyzzy=th%2Fud&q=node.js+http+parser',
+  // Multi-byte UTF-8 escapes.
+  encodemany: '%66%6F%6F=bar&%C3%A9t%C3%A9=%E2%82%AC%20100&x=%F0%9F%98%80',
+  // The same key over and over.
+  multivalue: 'foo=bar&foo=baz&foo=quux&quuy=quuz&foo=abc&foo=def',
+  // Input the fast path hands back to the JS code.
+  malformed: 'foo=%zzbar&baz=%E0%A4%A&x=%'
+};
+
+var bench = common.createBenchmark(main, {
+  type: Object.keys(inputs),
+  n: [1e6]
+});
+
+function main(conf) {
+  var input = inputs[conf.type];
+  var n = conf.n | 0;
+
+  bench.start();
+  for (var i = 0; i < n; i += 1)
+    querystring.parse(input);
+  bench.end(n);
+}
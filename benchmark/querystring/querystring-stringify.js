@@ -0,0 +1,47 @@
+var common = require('../common.js');
+var querystring = require('querystring');
+
+var inputs = {
+  noencode: {
+    foo: 'bar',
+    baz: 'quux',
+    xyzzy: 'thud',
+    page: 3,
+    per_page: 50
+  },
+  encodeascii: {
+    foo: 'b a r',
+    baz: 'qu/ux',
+    xyzzy: 'th&ud',
+    q: 'node.js http parser'
+  },
+  encodemany: {
+    'été': '€ 100',
+    foo: 'bár',
+    x: '😀'
+  },
+  multivalue: {
+    foo: ['bar', 'baz', 'quux', 'abc', 'def'],
+    quuy: 'quuz',
+    flag: true
+  }
+};
+
+var bench = common.createBenchmark(main, {
+  type: Object.keys(inputs),
+  n: [1e6]
+});
+
+function main(conf) {
+  var input = inputs[conf.type];
+  var n = conf.n | 0;
+
+  // Warm up the JS fallback too.
+  for (var j = 0; j < 1000; j += 1)
+    querystring.stringify(input);
+
+  bench.start();
+  for (var i = 0; i < n; i += 1)
+    querystring.stringify(input);
+  bench.end(n);
+}
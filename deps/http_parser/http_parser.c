@@ -29,6 +29,10 @@
 #include <string.h>
 #include <limits.h>
 
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
 #ifndef ULLONG_MAX
 # define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
 #endif
@@ -573,6 +577,89 @@ parse_url_char(enum state s, const char ch)
   return s_dead;
 }
 
+/* Return a pointer to the first CR or LF in [p, end), or end. */
+static const char *
+find_crlf(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+  const __m128i cr = _mm_set1_epi8(CR);
+  const __m128i lf = _mm_set1_epi8(LF);
+
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) p);
+    int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, cr),
+                                              _mm_cmpeq_epi8(v, lf)));
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for (; p != end; p++) {
+    if (*p == CR || *p == LF) {
+      break;
+    }
+  }
+
+  return p;
+}
+
+/* Return a pointer to the first byte in [p, end) that may move the URL
+ * parser out of s_req_path or s_req_query_string, or end. The SSE2 version
+ * only skips printable ASCII and leaves the rest to parse_url_char().
+ */
+static const char *
+skip_url_chars(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i del = _mm_set1_epi8(0x7f);
+  const __m128i question = _mm_set1_epi8('?');
+  const __m128i hash = _mm_set1_epi8('#');
+
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) p);
+    /* Signed compare: bytes >= 0x80 are negative and stop the scan too. */
+    int ok = _mm_movemask_epi8(_mm_cmpgt_epi8(v, space));
+    int stop = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(v, del),
+                     _mm_or_si128(_mm_cmpeq_epi8(v, question),
+                                  _mm_cmpeq_epi8(v, hash))));
+    int mask = (~ok | stop) & 0xffff;
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for (; p != end; p++) {
+    if (!IS_URL_CHAR(*p)) {
+      break;
+    }
+  }
+
+  return p;
+}
+
+/* Move p to the last byte before the one SCAN stops at, so that the main loop
+ * picks up from there. The skipped bytes count towards HTTP_MAX_HEADER_SIZE
+ * and the scan never crosses that limit.
+ */
+#define SKIP_AHEAD(SCAN)                                             \
+do {                                                                 \
+  const char *scan_end = data + len;                                 \
+  const char *scan_stop;                                             \
+  size_t room = HTTP_MAX_HEADER_SIZE - parser->nread;                \
+                                                                     \
+  if ((size_t) (scan_end - (p + 1)) > room) {                        \
+    scan_end = p + 1 + room;                                         \
+  }                                                                  \
+                                                                     \
+  scan_stop = SCAN(p + 1, scan_end);                                 \
+  parser->nread += scan_stop - (p + 1);                              \
+  p = scan_stop - 1;                                                 \
+} while (0)
+
 size_t http_parser_execute (http_parser *parser,
                             const http_parser_settings *settings,
                             const char *data,
@@ -1098,6 +1185,11 @@ size_t http_parser_execute (http_parser *parser,
               SET_ERRNO(HPE_INVALID_URL);
               goto error;
             }
+
+            if (parser->state == s_req_path ||
+                parser->state == s_req_query_string) {
+              SKIP_AHEAD(skip_url_chars);
+            }
         }
         break;
       }
@@ -1490,6 +1582,7 @@ size_t http_parser_execute (http_parser *parser,
 
         switch (parser->header_state) {
           case h_general:
+            SKIP_AHEAD(find_crlf);
             break;
 
           case h_connection:
@@ -2204,7 +2297,12 @@ http_parser_parse_url(const char *buf, size_t buflen, int is_connect,
 
   /* host must be present if there is a schema */
   /* parsing http:///toto will fail */
-  if ((u->field_set & ((1 << UF_SCHEMA) | (1 << UF_HOST))) != 0) {
+  if ((u->field_set & (1 << UF_SCHEMA)) &&
+      (u->field_set & (1 << UF_HOST)) == 0) {
+    return 1;
+  }
+
+  if (u->field_set & (1 << UF_HOST)) {
     if (http_parse_host(buf, u, found_at) != 0) {
       return 1;
     }
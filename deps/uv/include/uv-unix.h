@@ -264,6 +264,8 @@ typedef struct {
   ssize_t status;                                                             \
   uv_udp_send_cb send_cb;                                                     \
   uv_buf_t bufsml[4];                                                         \
+  unsigned int segmented;                                                     \
+  unsigned int nsent;                                                         \
 
 #define UV_HANDLE_PRIVATE_FIELDS                                              \
   uv_handle_t* next_closing;                                                  \
@@ -544,7 +544,14 @@ enum uv_udp_flags {
    * (provided they all set the flag) but only the last one to bind will receive
    * any traffic, in effect "stealing" the port from the previous listener.
    */
-  UV_UDP_REUSEADDR = 4
+  UV_UDP_REUSEADDR = 4,
+  /*
+   * Indicates that the message was received by recvmmsg(2) and that `buf`
+   * points into the buffer that was handed out by the alloc_cb.  That buffer
+   * must not be freed until the recv_cb is called for it with nread == 0 and
+   * addr == NULL.  Used in uv_udp_recv_cb.
+   */
+  UV_UDP_MMSG_CHUNK = 8
 };
 
 typedef void (*uv_udp_send_cb)(uv_udp_send_t* req, int status);
@@ -597,6 +604,14 @@ UV_EXTERN int uv_udp_set_multicast_interface(uv_udp_t* handle,
                                              const char* interface_addr);
 UV_EXTERN int uv_udp_set_broadcast(uv_udp_t* handle, int on);
 UV_EXTERN int uv_udp_set_ttl(uv_udp_t* handle, int ttl);
+/*
+ * Receive up to 20 datagrams per system call with recvmmsg(2) whenever the
+ * alloc_cb hands out a buffer with room for at least two 64 KB datagrams.
+ * The buffer is split into 64 KB slots and the recv_cb is called once per
+ * datagram with the UV_UDP_MMSG_CHUNK flag set.  Returns UV_ENOSYS where
+ * recvmmsg(2) is not available.
+ */
+UV_EXTERN int uv_udp_set_recvmmsg(uv_udp_t* handle, int on);
 UV_EXTERN int uv_udp_send(uv_udp_send_t* req,
                           uv_udp_t* handle,
                           const uv_buf_t bufs[],
@@ -607,6 +622,24 @@ UV_EXTERN int uv_udp_try_send(uv_udp_t* handle,
                               const uv_buf_t bufs[],
                               unsigned int nbufs,
                               const struct sockaddr* addr);
+/*
+ * Like uv_udp_send() but every buffer is a datagram of its own.  All of them
+ * must be as long as the first one, except for the last, which may be
+ * shorter.  There can be at most UV_UDP_SEGMENTS_MAX of them, with no more
+ * than UV_UDP_SEGMENTS_MAXSIZE bytes in total.  Where the kernel supports
+ * UDP_SEGMENT (Linux 4.18 and newer) they go out in a single system call
+ * and are split up by the kernel or the network card, elsewhere they are
+ * sent one by one.  If one of them fails, the send_cb gets its error and the
+ * ones after it aren't sent.  Returns UV_ENOSYS on Windows.
+ */
+#define UV_UDP_SEGMENTS_MAX 64
+#define UV_UDP_SEGMENTS_MAXSIZE 65507
+UV_EXTERN int uv_udp_send_segments(uv_udp_send_t* req,
+                                   uv_udp_t* handle,
+                                   const uv_buf_t bufs[],
+                                   unsigned int nbufs,
+                                   const struct sockaddr* addr,
+                                   uv_udp_send_cb send_cb);
 UV_EXTERN int uv_udp_recv_start(uv_udp_t* handle,
                                 uv_alloc_cb alloc_cb,
                                 uv_udp_recv_cb recv_cb);
@@ -282,6 +282,9 @@ int uv_backend_timeout(const uv_loop_t* loop) {
   if (!QUEUE_EMPTY(&loop->idle_handles))
     return 0;
 
+  if (!QUEUE_EMPTY(&loop->pending_queue))
+    return 0;
+
   if (loop->closing_handles)
     return 0;
 
@@ -694,10 +697,17 @@ int uv_fileno(const uv_handle_t* handle, uv_os_fd_t* fd) {
 
 static void uv__run_pending(uv_loop_t* loop) {
   QUEUE* q;
+  QUEUE pq;
   uv__io_t* w;
 
-  while (!QUEUE_EMPTY(&loop->pending_queue)) {
-    q = QUEUE_HEAD(&loop->pending_queue);
+  /* Only run what is pending now.  Callbacks that feed the queue again, a
+   * UDP send callback that sends the next datagram for example, would
+   * otherwise keep the loop from ever getting to timers and I/O.
+   */
+  QUEUE_MOVE(&loop->pending_queue, &pq);
+
+  while (!QUEUE_EMPTY(&pq)) {
+    q = QUEUE_HEAD(&pq);
     QUEUE_REMOVE(q);
     QUEUE_INIT(q);
 
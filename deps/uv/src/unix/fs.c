@@ -680,7 +680,8 @@ static void uv__to_stat(struct stat* src, uv_stat_t* dst) {
   dst->st_flags = src->st_flags;
   dst->st_gen = src->st_gen;
 #elif !defined(_AIX) && \
-  (defined(_BSD_SOURCE) || defined(_SVID_SOURCE) || defined(_XOPEN_SOURCE))
+  (defined(_BSD_SOURCE) || defined(_SVID_SOURCE) || \
+   defined(_XOPEN_SOURCE) || defined(_DEFAULT_SOURCE))
   dst->st_atim.tv_sec = src->st_atim.tv_sec;
   dst->st_atim.tv_nsec = src->st_atim.tv_nsec;
   dst->st_mtim.tv_sec = src->st_mtim.tv_sec;
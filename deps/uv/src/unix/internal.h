@@ -143,7 +143,10 @@ enum {
   UV_TCP_NODELAY          = 0x400,  /* Disable Nagle. */
   UV_TCP_KEEPALIVE        = 0x800,  /* Turn on keep-alive. */
   UV_TCP_SINGLE_ACCEPT    = 0x1000, /* Only accept() when idle. */
-  UV_HANDLE_IPV6          = 0x10000 /* Handle is bound to a IPv6 socket. */
+  UV_HANDLE_IPV6          = 0x10000, /* Handle is bound to a IPv6 socket. */
+  UV_UDP_RECVMMSG         = 0x20000, /* Use recvmmsg(2) if the buffer fits. */
+  UV_UDP_GSO_CHECKED      = 0x40000, /* Checked for UDP_SEGMENT support. */
+  UV_UDP_GSO              = 0x80000  /* Socket supports UDP_SEGMENT. */
 };
 
 typedef enum {
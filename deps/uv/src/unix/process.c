@@ -19,6 +19,13 @@
  * IN THE SOFTWARE.
  */
 
+/* Expose posix_spawn_file_actions_addchdir_np() and POSIX_SPAWN_SETSID.
+ * Needs to be defined before we include any headers.
+ */
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
+
 #include "uv.h"
 #include "internal.h"
 
@@ -44,6 +51,20 @@ extern char **environ;
 # include <grp.h>
 #endif
 
+/* glibc >= 2.24 implements posix_spawn() with clone(CLONE_VM | CLONE_VFORK),
+ * which doesn't have to copy the page tables of the parent the way fork()
+ * does, and reports exec() errors to the caller.  2.29 is needed for
+ * posix_spawn_file_actions_addchdir_np() and for adddup2(fd, fd) clearing
+ * the close-on-exec flag.
+ */
+#if defined(__linux__) && defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+# if __GLIBC_PREREQ(2, 29)
+#  define UV__HAVE_POSIX_SPAWN 1
+#  include <spawn.h>
+#  include <string.h>
+# endif
+#endif
+
 
 static void uv__chld(uv_signal_t* handle, int signum) {
   uv_process_t* process;
@@ -351,6 +372,120 @@ static void uv__process_child_init(const uv_process_options_t* options,
 }
 
 
+#if defined(UV__HAVE_POSIX_SPAWN)
+static const char* uv__spawn_find_path(char** env) {
+  for (; *env != NULL; env++)
+    if (strncmp(*env, "PATH=", 5) == 0)
+      return *env + 5;
+
+  return NULL;
+}
+
+
+/* Returns 0 if posix_spawn() can start the child exactly the way
+ * uv__process_child_init() would, -ENOSYS if it can't.
+ */
+static int uv__spawn_usable(const uv_process_options_t* options) {
+  const char* path;
+  const char* child_path;
+
+  /* There is no spawn attribute for switching user or group. */
+  if (options->flags & (UV_PROCESS_SETUID | UV_PROCESS_SETGID))
+    return -ENOSYS;
+
+  /* posix_spawnp() searches the PATH of the parent, execvp() in the child
+   * searches the PATH of the new environment.
+   */
+  if (options->env == NULL || strchr(options->file, '/') != NULL)
+    return 0;
+
+  path = getenv("PATH");
+  child_path = uv__spawn_find_path(options->env);
+
+  if (path == NULL && child_path == NULL)
+    return 0;
+
+  if (path != NULL && child_path != NULL && strcmp(path, child_path) == 0)
+    return 0;
+
+  return -ENOSYS;
+}
+
+
+/* The posix_spawn() version of fork() + uv__process_child_init().  The file
+ * actions mirror the steps that function takes, in the same order.  Returns
+ * 0 or a negated errno; failure to exec() is reported here too, and in that
+ * case the child has already been reaped.
+ */
+static int uv__spawn_posix(const uv_process_options_t* options,
+                           int stdio_count,
+                           int (*pipes)[2],
+                           pid_t* pid) {
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attr;
+  char** env;
+  int use_fd;
+  int fd;
+  int err;
+
+  err = posix_spawn_file_actions_init(&actions);
+  if (err)
+    return -err;
+
+  err = posix_spawnattr_init(&attr);
+  if (err) {
+    posix_spawn_file_actions_destroy(&actions);
+    return -err;
+  }
+
+  if (options->flags & UV_PROCESS_DETACHED)
+    err = posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID);
+
+  for (fd = 0; fd < stdio_count && err == 0; fd++) {
+    use_fd = pipes[fd][1];
+
+    if (use_fd < 0) {
+      if (fd < 3)
+        err = posix_spawn_file_actions_addopen(&actions,
+                                               fd,
+                                               "/dev/null",
+                                               fd == 0 ? O_RDONLY : O_RDWR,
+                                               0);
+      continue;
+    }
+
+    /* Unlike in the forked child, this changes the blocking mode before the
+     * spawn rather than after, but it's the same open file description.
+     */
+    if (fd <= 2)
+      uv__nonblock(use_fd, 0);
+
+    err = posix_spawn_file_actions_adddup2(&actions, use_fd, fd);
+  }
+
+  for (fd = 0; fd < stdio_count && err == 0; fd++) {
+    use_fd = pipes[fd][1];
+
+    if (use_fd >= 0 && fd != use_fd)
+      err = posix_spawn_file_actions_addclose(&actions, use_fd);
+  }
+
+  if (options->cwd != NULL && err == 0)
+    err = posix_spawn_file_actions_addchdir_np(&actions, options->cwd);
+
+  if (err == 0) {
+    env = options->env != NULL ? options->env : environ;
+    err = posix_spawnp(pid, options->file, &actions, &attr, options->args, env);
+  }
+
+  posix_spawnattr_destroy(&attr);
+  posix_spawn_file_actions_destroy(&actions);
+
+  return -err;
+}
+#endif
+
+
 int uv_spawn(uv_loop_t* loop,
              uv_process_t* process,
              const uv_process_options_t* options) {
@@ -393,6 +528,25 @@ int uv_spawn(uv_loop_t* loop,
       goto error;
   }
 
+#if defined(UV__HAVE_POSIX_SPAWN)
+  if (uv__spawn_usable(options) == 0) {
+    uv_signal_start(&loop->child_watcher, uv__chld, SIGCHLD);
+
+    /* Same as with fork(), don't let worker threads leak fds to the child.
+     * No signal pipe either, posix_spawn() only returns after the exec().
+     */
+    uv_rwlock_wrlock(&loop->cloexec_lock);
+    exec_errorno = uv__spawn_posix(options, stdio_count, pipes, &pid);
+    uv_rwlock_wrunlock(&loop->cloexec_lock);
+
+    if (exec_errorno != 0)
+      pid = 0;
+
+    process->status = 0;
+    goto spawned;
+  }
+#endif
+
   /* This pipe is used by the parent to wait until
    * the child has called `execve()`. We need this
    * to avoid the following race condition:
@@ -457,6 +611,9 @@ int uv_spawn(uv_loop_t* loop,
 
   uv__close(signal_pipe[0]);
 
+#if defined(UV__HAVE_POSIX_SPAWN)
+spawned:
+#endif
   for (i = 0; i < options->stdio_count; i++) {
     err = uv__process_open_stream(options->stdio + i, pipes[i], i == 0);
     if (err == 0)
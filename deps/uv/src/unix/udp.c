@@ -36,6 +36,19 @@
 # define IPV6_DROP_MEMBERSHIP IPV6_LEAVE_GROUP
 #endif
 
+#if defined(__linux__)
+# define UV__MMSG_MAXWIDTH 20
+# define UV__UDP_DGRAM_MAXSIZE (64 * 1024)
+/* Set when the kernel turns out not to have sendmmsg(2). */
+static int uv__sendmmsg_unavail;
+# define UV__SOL_UDP 17
+# define UV__UDP_SEGMENT 103
+#endif
+
+/* States of uv_udp_send_t.segmented for uv_udp_send_segments() requests. */
+#define UV__SEGMENTS_GSO 1    /* Send with UDP_SEGMENT. */
+#define UV__SEGMENTS_SPLIT 2  /* Send one datagram per buffer. */
+
 
 static void uv__udp_run_completed(uv_udp_t* handle);
 static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents);
@@ -140,6 +153,75 @@ static void uv__udp_io(uv_loop_t* loop, uv__io_t* w, unsigned int revents) {
 }
 
 
+#if defined(__linux__)
+/* Returns the number of datagrams read, or -1 with errno set to ENOSYS when
+ * the kernel doesn't support recvmmsg(2).  Calls the recv_cb for all other
+ * outcomes.
+ */
+static ssize_t uv__udp_recvmmsg(uv_udp_t* handle, uv_buf_t* buf) {
+  struct sockaddr_storage peers[UV__MMSG_MAXWIDTH];
+  struct iovec iov[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr msgs[UV__MMSG_MAXWIDTH];
+  const struct sockaddr* addr;
+  uv_buf_t chunk_buf;
+  ssize_t nread;
+  size_t chunks;
+  size_t k;
+  int flags;
+
+  chunks = buf->len / UV__UDP_DGRAM_MAXSIZE;
+  if (chunks > ARRAY_SIZE(iov))
+    chunks = ARRAY_SIZE(iov);
+
+  for (k = 0; k < chunks; k++) {
+    iov[k].iov_base = buf->base + k * UV__UDP_DGRAM_MAXSIZE;
+    iov[k].iov_len = UV__UDP_DGRAM_MAXSIZE;
+    memset(&msgs[k].msg_hdr, 0, sizeof(msgs[k].msg_hdr));
+    msgs[k].msg_hdr.msg_iov = iov + k;
+    msgs[k].msg_hdr.msg_iovlen = 1;
+    msgs[k].msg_hdr.msg_name = peers + k;
+    msgs[k].msg_hdr.msg_namelen = sizeof(peers[0]);
+  }
+
+  do
+    nread = uv__recvmmsg(handle->io_watcher.fd, msgs, chunks, 0, NULL);
+  while (nread == -1 && errno == EINTR);
+
+  if (nread == -1 && errno == ENOSYS)
+    return -1;
+
+  if (nread < 1) {
+    if (nread == 0 || errno == EAGAIN || errno == EWOULDBLOCK)
+      handle->recv_cb(handle, 0, buf, NULL, 0);
+    else
+      handle->recv_cb(handle, -errno, buf, NULL, 0);
+    return nread;
+  }
+
+  for (k = 0; k < (size_t) nread && handle->recv_cb != NULL; k++) {
+    flags = UV_UDP_MMSG_CHUNK;
+    if (msgs[k].msg_hdr.msg_flags & MSG_TRUNC)
+      flags |= UV_UDP_PARTIAL;
+
+    addr = NULL;
+    if (msgs[k].msg_hdr.msg_namelen != 0)
+      addr = (const struct sockaddr*) &peers[k];
+
+    chunk_buf = uv_buf_init(iov[k].iov_base, msgs[k].msg_len);
+    handle->recv_cb(handle, msgs[k].msg_len, &chunk_buf, addr, flags);
+  }
+
+  /* Hand the buffer back.  Skipped when the recv_cb stopped the handle, in
+   * which case the buffer stays with the user.
+   */
+  if (handle->recv_cb != NULL)
+    handle->recv_cb(handle, 0, buf, NULL, 0);
+
+  return nread;
+}
+#endif
+
+
 static void uv__udp_recvmsg(uv_udp_t* handle) {
   struct sockaddr_storage peer;
   struct msghdr h;
@@ -167,6 +249,16 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
     }
     assert(buf.base != NULL);
 
+#if defined(__linux__)
+    if ((handle->flags & UV_UDP_RECVMMSG) &&
+        buf.len >= 2 * UV__UDP_DGRAM_MAXSIZE) {
+      nread = uv__udp_recvmmsg(handle, &buf);
+      if (nread != -1 || errno != ENOSYS)
+        continue;
+      handle->flags &= ~UV_UDP_RECVMMSG;
+    }
+#endif
+
     h.msg_namelen = sizeof(peer);
     h.msg_iov = (void*) &buf;
     h.msg_iovlen = 1;
@@ -204,12 +296,202 @@ static void uv__udp_recvmsg(uv_udp_t* handle) {
 }
 
 
+#if defined(__linux__)
+/* Adds a UDP_SEGMENT control message with the segment size of `req` to `h`.
+ * `control` must have room for CMSG_SPACE(sizeof(uint16_t)) bytes.
+ */
+static void uv__udp_set_segment(struct msghdr* h,
+                                void* control,
+                                uv_udp_send_t* req) {
+  struct cmsghdr* cmsg;
+  uint16_t segment;
+
+  memset(control, 0, CMSG_SPACE(sizeof(segment)));
+  h->msg_control = control;
+  h->msg_controllen = CMSG_SPACE(sizeof(segment));
+  cmsg = CMSG_FIRSTHDR(h);
+  cmsg->cmsg_level = UV__SOL_UDP;
+  cmsg->cmsg_type = UV__UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(segment));
+  segment = req->bufs[0].len;
+  memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+}
+#endif
+
+
+/* Sends the datagrams of a uv_udp_send_segments() request.  Returns the
+ * number of bytes sent, or -1 with errno set.  On EAGAIN, the datagrams
+ * that did go out are remembered and the next call carries on from there.
+ */
+static ssize_t uv__udp_sendmsg_segments(uv_udp_t* handle,
+                                        uv_udp_send_t* req) {
+  struct msghdr h;
+  ssize_t size;
+
+  memset(&h, 0, sizeof h);
+  h.msg_name = &req->addr;
+  h.msg_namelen = (req->addr.ss_family == AF_INET6 ?
+    sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+
+#if defined(__linux__)
+  if (req->segmented == UV__SEGMENTS_GSO) {
+    union {
+      char buf[CMSG_SPACE(sizeof(uint16_t))];
+      struct cmsghdr align;
+    } control;
+
+    h.msg_iov = (struct iovec*) req->bufs;
+    h.msg_iovlen = req->nbufs;
+    uv__udp_set_segment(&h, &control, req);
+
+    do
+      size = sendmsg(handle->io_watcher.fd, &h, 0);
+    while (size == -1 && errno == EINTR);
+
+    if (size != -1 || (errno != EINVAL && errno != EIO))
+      return size;
+
+    /* EINVAL: the segments don't fit the path MTU.  EIO: the device can't
+     * checksum them, which won't change for this socket.
+     */
+    if (errno == EIO)
+      handle->flags &= ~UV_UDP_GSO;
+    req->segmented = UV__SEGMENTS_SPLIT;
+    h.msg_control = NULL;
+    h.msg_controllen = 0;
+  }
+#endif
+
+  while (req->nsent < req->nbufs) {
+    h.msg_iov = (struct iovec*) &req->bufs[req->nsent];
+    h.msg_iovlen = 1;
+
+    do
+      size = sendmsg(handle->io_watcher.fd, &h, 0);
+    while (size == -1 && errno == EINTR);
+
+    if (size == -1)
+      return -1;
+
+    req->nsent++;
+  }
+
+  return uv__count_bufs(req->bufs, req->nbufs);
+}
+
+
+#if defined(__linux__)
+/* Sends as much of the write queue as the socket takes, up to 20 datagrams
+ * per system call.  Returns -1 with errno set to ENOSYS when the kernel
+ * doesn't support sendmmsg(2), 0 otherwise.
+ */
+static int uv__udp_sendmmsg(uv_udp_t* handle) {
+  struct uv__mmsghdr h[UV__MMSG_MAXWIDTH];
+  union {
+    char buf[CMSG_SPACE(sizeof(uint16_t))];
+    struct cmsghdr align;
+  } control[UV__MMSG_MAXWIDTH];
+  struct uv__mmsghdr* p;
+  uv_udp_send_t* req;
+  ssize_t npkts;
+  ssize_t size;
+  size_t pkts;
+  size_t i;
+  QUEUE* q;
+
+  while (!QUEUE_EMPTY(&handle->write_queue)) {
+    for (pkts = 0, q = QUEUE_HEAD(&handle->write_queue);
+         pkts < UV__MMSG_MAXWIDTH && q != &handle->write_queue;
+         pkts++, q = QUEUE_NEXT(q)) {
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      /* Segmented requests that need one system call per datagram end the
+       * batch.
+       */
+      if (req->segmented == UV__SEGMENTS_SPLIT)
+        break;
+      p = &h[pkts];
+      memset(p, 0, sizeof(*p));
+      p->msg_hdr.msg_name = &req->addr;
+      p->msg_hdr.msg_namelen = (req->addr.ss_family == AF_INET6 ?
+        sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+      p->msg_hdr.msg_iov = (struct iovec*) req->bufs;
+      p->msg_hdr.msg_iovlen = req->nbufs;
+      if (req->segmented == UV__SEGMENTS_GSO)
+        uv__udp_set_segment(&p->msg_hdr, &control[pkts], req);
+    }
+
+    if (pkts == 0) {
+      req = QUEUE_DATA(QUEUE_HEAD(&handle->write_queue), uv_udp_send_t, queue);
+      size = uv__udp_sendmsg_segments(handle, req);
+      if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        break;
+      req->status = (size == -1 ? -errno : size);
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+      uv__io_feed(handle->loop, &handle->io_watcher);
+      continue;
+    }
+
+    do
+      npkts = uv__sendmmsg(handle->io_watcher.fd, h, pkts, 0);
+    while (npkts == -1 && errno == EINTR);
+
+    if (npkts == -1) {
+      if (errno == ENOSYS)
+        return -1;
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+      /* Only the first datagram failed, the others weren't tried yet. */
+      req = QUEUE_DATA(QUEUE_HEAD(&handle->write_queue), uv_udp_send_t, queue);
+      if (req->segmented == UV__SEGMENTS_GSO &&
+          (errno == EINVAL || errno == EIO)) {
+        /* Same as in uv__udp_sendmsg_segments(). */
+        if (errno == EIO)
+          handle->flags &= ~UV_UDP_GSO;
+        req->segmented = UV__SEGMENTS_SPLIT;
+        continue;
+      }
+      req->status = -errno;
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+      uv__io_feed(handle->loop, &handle->io_watcher);
+      continue;
+    }
+
+    for (i = 0; i < (size_t) npkts; i++) {
+      q = QUEUE_HEAD(&handle->write_queue);
+      req = QUEUE_DATA(q, uv_udp_send_t, queue);
+      req->status = h[i].msg_len;
+      QUEUE_REMOVE(&req->queue);
+      QUEUE_INSERT_TAIL(&handle->write_completed_queue, &req->queue);
+    }
+    uv__io_feed(handle->loop, &handle->io_watcher);
+  }
+
+  return 0;
+}
+#endif
+
+
 static void uv__udp_sendmsg(uv_udp_t* handle) {
   uv_udp_send_t* req;
   QUEUE* q;
   struct msghdr h;
   ssize_t size;
 
+#if defined(__linux__)
+  /* Not worth it for a single datagram, which is the common case when the
+   * socket keeps up.
+   */
+  if (!uv__sendmmsg_unavail &&
+      !QUEUE_EMPTY(&handle->write_queue) &&
+      QUEUE_NEXT(QUEUE_HEAD(&handle->write_queue)) != &handle->write_queue) {
+    if (uv__udp_sendmmsg(handle) == 0)
+      return;
+    uv__sendmmsg_unavail = 1;
+  }
+#endif
+
   while (!QUEUE_EMPTY(&handle->write_queue)) {
     q = QUEUE_HEAD(&handle->write_queue);
     assert(q != NULL);
@@ -217,16 +499,20 @@ static void uv__udp_sendmsg(uv_udp_t* handle) {
     req = QUEUE_DATA(q, uv_udp_send_t, queue);
     assert(req != NULL);
 
-    memset(&h, 0, sizeof h);
-    h.msg_name = &req->addr;
-    h.msg_namelen = (req->addr.ss_family == AF_INET6 ?
-      sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
-    h.msg_iov = (struct iovec*) req->bufs;
-    h.msg_iovlen = req->nbufs;
-
-    do {
-      size = sendmsg(handle->io_watcher.fd, &h, 0);
-    } while (size == -1 && errno == EINTR);
+    if (req->segmented) {
+      size = uv__udp_sendmsg_segments(handle, req);
+    } else {
+      memset(&h, 0, sizeof h);
+      h.msg_name = &req->addr;
+      h.msg_namelen = (req->addr.ss_family == AF_INET6 ?
+        sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+      h.msg_iov = (struct iovec*) req->bufs;
+      h.msg_iovlen = req->nbufs;
+
+      do {
+        size = sendmsg(handle->io_watcher.fd, &h, 0);
+      } while (size == -1 && errno == EINTR);
+    }
 
     if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
       break;
@@ -371,13 +657,14 @@ static int uv__udp_maybe_deferred_bind(uv_udp_t* handle,
 }
 
 
-int uv__udp_send(uv_udp_send_t* req,
-                 uv_udp_t* handle,
-                 const uv_buf_t bufs[],
-                 unsigned int nbufs,
-                 const struct sockaddr* addr,
-                 unsigned int addrlen,
-                 uv_udp_send_cb send_cb) {
+static int uv__udp_queue_send(uv_udp_send_t* req,
+                              uv_udp_t* handle,
+                              const uv_buf_t bufs[],
+                              unsigned int nbufs,
+                              const struct sockaddr* addr,
+                              unsigned int addrlen,
+                              unsigned int segmented,
+                              uv_udp_send_cb send_cb) {
   int err;
   int empty_queue;
 
@@ -399,6 +686,8 @@ int uv__udp_send(uv_udp_send_t* req,
   req->send_cb = send_cb;
   req->handle = handle;
   req->nbufs = nbufs;
+  req->segmented = segmented;
+  req->nsent = 0;
 
   req->bufs = req->bufsml;
   if (nbufs > ARRAY_SIZE(req->bufsml))
@@ -415,13 +704,95 @@ int uv__udp_send(uv_udp_send_t* req,
 
   if (empty_queue)
     uv__udp_sendmsg(handle);
-  else
+
+  /* Whatever the socket didn't take right away goes out once it's writable
+   * again.
+   */
+  if (!QUEUE_EMPTY(&handle->write_queue))
     uv__io_start(handle->loop, &handle->io_watcher, UV__POLLOUT);
 
   return 0;
 }
 
 
+int uv__udp_send(uv_udp_send_t* req,
+                 uv_udp_t* handle,
+                 const uv_buf_t bufs[],
+                 unsigned int nbufs,
+                 const struct sockaddr* addr,
+                 unsigned int addrlen,
+                 uv_udp_send_cb send_cb) {
+  return uv__udp_queue_send(req, handle, bufs, nbufs, addr, addrlen, 0,
+                            send_cb);
+}
+
+
+int uv_udp_send_segments(uv_udp_send_t* req,
+                         uv_udp_t* handle,
+                         const uv_buf_t bufs[],
+                         unsigned int nbufs,
+                         const struct sockaddr* addr,
+                         uv_udp_send_cb send_cb) {
+  unsigned int addrlen;
+  unsigned int segmented;
+  size_t total;
+  unsigned int i;
+  int err;
+
+  if (handle->type != UV_UDP)
+    return -EINVAL;
+
+  if (addr->sa_family == AF_INET)
+    addrlen = sizeof(struct sockaddr_in);
+  else if (addr->sa_family == AF_INET6)
+    addrlen = sizeof(struct sockaddr_in6);
+  else
+    return -EINVAL;
+
+  if (nbufs == 0 || nbufs > UV_UDP_SEGMENTS_MAX || bufs[0].len == 0)
+    return -EINVAL;
+
+  total = 0;
+  for (i = 0; i < nbufs; i++) {
+    if (i < nbufs - 1 ? bufs[i].len != bufs[0].len : bufs[i].len > bufs[0].len)
+      return -EINVAL;
+    total += bufs[i].len;
+  }
+
+  if (total > UV_UDP_SEGMENTS_MAXSIZE)
+    return -EINVAL;
+
+  err = uv__udp_maybe_deferred_bind(handle, addr->sa_family, 0);
+  if (err)
+    return err;
+
+  segmented = UV__SEGMENTS_SPLIT;
+#if defined(__linux__)
+  if (!(handle->flags & UV_UDP_GSO_CHECKED)) {
+    int val;
+    socklen_t len;
+
+    /* Kernels without UDP_SEGMENT don't know the option. */
+    len = sizeof(val);
+    if (getsockopt(handle->io_watcher.fd,
+                   UV__SOL_UDP,
+                   UV__UDP_SEGMENT,
+                   &val,
+                   &len) == 0) {
+      handle->flags |= UV_UDP_GSO;
+    }
+    handle->flags |= UV_UDP_GSO_CHECKED;
+  }
+
+  if ((handle->flags & UV_UDP_GSO) && nbufs > 1)
+    segmented = UV__SEGMENTS_GSO;
+#endif
+
+  return uv__udp_queue_send(req, handle, bufs, nbufs, addr, addrlen, segmented,
+                            send_cb);
+}
+
+
 int uv__udp_try_send(uv_udp_t* handle,
                      const uv_buf_t bufs[],
                      unsigned int nbufs,
@@ -631,6 +1002,19 @@ int uv_udp_set_broadcast(uv_udp_t* handle, int on) {
 }
 
 
+int uv_udp_set_recvmmsg(uv_udp_t* handle, int on) {
+#if defined(__linux__)
+  if (on)
+    handle->flags |= UV_UDP_RECVMMSG;
+  else
+    handle->flags &= ~UV_UDP_RECVMMSG;
+  return 0;
+#else
+  return -ENOSYS;
+#endif
+}
+
+
 int uv_udp_set_ttl(uv_udp_t* handle, int ttl) {
   if (ttl < 1 || ttl > 255)
     return -EINVAL;
@@ -888,3 +888,18 @@ int uv__udp_try_send(uv_udp_t* handle,
                      unsigned int addrlen) {
   return UV_ENOSYS;
 }
+
+
+int uv_udp_set_recvmmsg(uv_udp_t* handle, int on) {
+  return UV_ENOSYS;
+}
+
+
+int uv_udp_send_segments(uv_udp_send_t* req,
+                         uv_udp_t* handle,
+                         const uv_buf_t bufs[],
+                         unsigned int nbufs,
+                         const struct sockaddr* addr,
+                         uv_udp_send_cb send_cb) {
+  return UV_ENOSYS;
+}
@@ -0,0 +1,126 @@
+/* Copyright Joyent, Inc. and other Node contributors. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "uv.h"
+#include "task.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+# include <sys/socket.h>
+# include <unistd.h>
+#endif
+
+#define BIG_SIZE (96 * 1024)
+
+static int recv_cb_called;
+static int partial_cb_called;
+static int close_cb_called;
+
+
+static void alloc_cb(uv_handle_t* handle,
+                     size_t suggested_size,
+                     uv_buf_t* buf) {
+  /* Room for two 64 kB datagrams, enough for the recvmmsg path. */
+  static char slab[2 * 65536];
+  buf->base = slab;
+  buf->len = sizeof(slab);
+}
+
+
+static void close_cb(uv_handle_t* handle) {
+  close_cb_called++;
+}
+
+
+static void recv_cb(uv_udp_t* handle,
+                    ssize_t nread,
+                    const uv_buf_t* buf,
+                    const struct sockaddr* addr,
+                    unsigned flags) {
+  ASSERT(nread >= 0);
+
+  if (nread == 0)
+    return;
+
+  ASSERT(flags & UV_UDP_MMSG_CHUNK);
+  recv_cb_called++;
+
+  if (recv_cb_called == 1) {
+    /* Cut short at the 64 kB slot, and reported as such. */
+    ASSERT(nread == 65536);
+    ASSERT(flags & UV_UDP_PARTIAL);
+    partial_cb_called++;
+    return;
+  }
+
+  ASSERT(nread == 4);
+  ASSERT(memcmp("PING", buf->base, nread) == 0);
+  ASSERT((flags & UV_UDP_PARTIAL) == 0);
+
+  uv_close((uv_handle_t*) handle, close_cb);
+}
+
+
+TEST_IMPL(udp_recvmmsg_partial) {
+#if !defined(__linux__)
+  RETURN_SKIP("recvmmsg(2) is Linux only.");
+#else
+  static char big[BIG_SIZE];
+  uv_udp_t handle;
+  int fds[2];
+  int r;
+
+  /* UDP can't carry a datagram that overflows a 64 kB slot but a datagram
+   * socket in the AF_UNIX domain can.
+   */
+  r = socketpair(AF_UNIX, SOCK_DGRAM, 0, fds);
+  ASSERT(r == 0);
+
+  memset(big, 'x', sizeof(big));
+  ASSERT(send(fds[1], big, sizeof(big), 0) == sizeof(big));
+  ASSERT(send(fds[1], "PING", 4, 0) == 4);
+
+  r = uv_udp_init(uv_default_loop(), &handle);
+  ASSERT(r == 0);
+
+  r = uv_udp_open(&handle, fds[0]);
+  ASSERT(r == 0);
+
+  r = uv_udp_set_recvmmsg(&handle, 1);
+  ASSERT(r == 0);
+
+  r = uv_udp_recv_start(&handle, alloc_cb, recv_cb);
+  ASSERT(r == 0);
+
+  uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+  ASSERT(recv_cb_called == 2);
+  ASSERT(partial_cb_called == 1);
+  ASSERT(close_cb_called == 1);
+
+  close(fds[1]);
+
+  MAKE_VALGRIND_HAPPY();
+  return 0;
+#endif
+}
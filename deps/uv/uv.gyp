@@ -435,6 +435,7 @@
         'test/test-udp-multicast-interface.c',
         'test/test-udp-multicast-interface6.c',
         'test/test-udp-try-send.c',
+        'test/test-udp-recvmmsg-partial.c',
       ],
       'conditions': [
         [ 'OS=="win"', {
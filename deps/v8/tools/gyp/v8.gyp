@@ -184,10 +184,18 @@
               ['v8_random_seed!=0', {
                 'mksnapshot_flags': ['--random-seed', '<(v8_random_seed)'],
               }],
+              ['v8_extra_code!=""', {
+                'mksnapshot_flags': ['--extra-code', '<(v8_extra_code)'],
+              }],
             ],
           },
+          'conditions': [
+            ['v8_extra_code!=""', {
+              'inputs': ['<(v8_extra_code)'],
+            }],
+          ],
           'action': [
-            '<@(_inputs)',
+            '<(PRODUCT_DIR)/<(EXECUTABLE_PREFIX)mksnapshot<(EXECUTABLE_SUFFIX)',
             '<@(mksnapshot_flags)',
             '<@(INTERMEDIATE_DIR)/snapshot.cc'
           ],
@@ -275,6 +283,9 @@
                 '<(PRODUCT_DIR)/<(EXECUTABLE_PREFIX)mksnapshot<(EXECUTABLE_SUFFIX)',
               ],
               'conditions': [
+                ['v8_extra_code!=""', {
+                  'inputs': ['<(v8_extra_code)'],
+                }],
                 ['want_separate_host_toolset==1', {
                   'target_conditions': [
                     ['_toolset=="host"', {
@@ -305,10 +316,13 @@
                   ['v8_random_seed!=0', {
                     'mksnapshot_flags': ['--random-seed', '<(v8_random_seed)'],
                   }],
+                  ['v8_extra_code!=""', {
+                    'mksnapshot_flags': ['--extra-code', '<(v8_extra_code)'],
+                  }],
                 ],
               },
               'action': [
-                '<@(_inputs)',
+                '<(PRODUCT_DIR)/<(EXECUTABLE_PREFIX)mksnapshot<(EXECUTABLE_SUFFIX)',
                 '<@(mksnapshot_flags)',
                 '<@(INTERMEDIATE_DIR)/snapshot.cc',
                 '--startup_blob', '<(PRODUCT_DIR)/snapshot_blob.bin',
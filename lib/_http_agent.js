@@ -60,6 +60,9 @@ function Agent(options) {
   self.keepAlive = self.options.keepAlive || false;
   self.maxSockets = self.options.maxSockets || Agent.defaultMaxSockets;
   self.maxFreeSockets = self.options.maxFreeSockets || 256;
+  self.freeSocketTimeout = self.options.freeSocketTimeout || 0;
+  self.minSockets = self.options.minSockets || 0;
+  self.poolStats = {};
 
   self.on('free', function(socket, options) {
     var name = self.getName(options);
@@ -67,7 +70,11 @@ function Agent(options) {
 
     if (!socket.destroyed &&
         self.requests[name] && self.requests[name].length) {
-      self.requests[name].shift().onSocket(socket);
+      var waiting = self.requests[name].shift();
+      var stats = self.getPoolStats(name);
+      stats.waited++;
+      stats.waitTime += Date.now() - waiting._agentQueuedAt;
+      waiting.onSocket(socket);
       if (self.requests[name].length === 0) {
         // don't leak
         delete self.requests[name];
@@ -80,24 +87,8 @@ function Agent(options) {
           req.shouldKeepAlive &&
           !socket.destroyed &&
           self.options.keepAlive) {
-        var freeSockets = self.freeSockets[name];
-        var freeLen = freeSockets ? freeSockets.length : 0;
-        var count = freeLen;
-        if (self.sockets[name])
-          count += self.sockets[name].length;
-
-        if (count >= self.maxSockets || freeLen >= self.maxFreeSockets) {
-          self.removeSocket(socket, options);
-          socket.destroy();
-        } else {
-          freeSockets = freeSockets || [];
-          self.freeSockets[name] = freeSockets;
-          socket.setKeepAlive(true, self.keepAliveMsecs);
-          socket.unref();
-          socket._httpMessage = null;
-          self.removeSocket(socket, options);
-          freeSockets.push(socket);
-        }
+        socket._httpMessage = null;
+        self.addFreeSocket(socket, options);
       } else {
         self.removeSocket(socket, options);
         socket.destroy();
@@ -147,18 +138,19 @@ Agent.prototype.addRequest = function(req, options) {
     this.sockets[name] = [];
   }
 
+  var stats = this.getPoolStats(name);
+  stats.requests++;
+
+  // Most recently used first: it is the least likely to have been closed by
+  // the other end, and the older ones are left to time out.
+  var socket = this.takeFreeSocket(name);
   var freeLen = this.freeSockets[name] ? this.freeSockets[name].length : 0;
   var sockLen = freeLen + this.sockets[name].length;
 
-  if (freeLen) {
+  if (socket) {
     // we have a free socket, so use that.
-    var socket = this.freeSockets[name].shift();
     debug('have free socket');
-
-    // don't leak
-    if (!this.freeSockets[name].length)
-      delete this.freeSockets[name];
-
+    stats.reused++;
     socket.ref();
     req.onSocket(socket);
     this.sockets[name].push(socket);
@@ -172,8 +164,146 @@ Agent.prototype.addRequest = function(req, options) {
     if (!this.requests[name]) {
       this.requests[name] = [];
     }
+    req._agentQueuedAt = Date.now();
     this.requests[name].push(req);
   }
+
+  if (this.keepAlive && this.minSockets > 0)
+    this.warmSockets(options);
+};
+
+// Put a socket that is done with its request in the freeSockets pool,
+// or close it when the pool for |options| is full.
+Agent.prototype.addFreeSocket = function(socket, options) {
+  var self = this;
+  var name = self.getName(options);
+  var freeSockets = self.freeSockets[name];
+  var freeLen = freeSockets ? freeSockets.length : 0;
+  var count = freeLen;
+  if (self.sockets[name])
+    count += self.sockets[name].length;
+
+  if (count > self.maxSockets || freeLen >= self.maxFreeSockets) {
+    self.removeSocket(socket, options);
+    socket.destroy();
+    return;
+  }
+
+  freeSockets = freeSockets || [];
+  self.freeSockets[name] = freeSockets;
+  socket.setKeepAlive(true, self.keepAliveMsecs);
+  socket.unref();
+  self.removeSocket(socket, options);
+  freeSockets.push(socket);
+
+  // Nobody else listens while the socket is idle; a reset must not throw.
+  socket.on('error', freeSocketErrorListener);
+  if (self.freeSocketTimeout > 0) {
+    socket.setTimeout(self.freeSocketTimeout, freeSocketTimeoutListener);
+    socket._agentTimeoutListener = freeSocketTimeoutListener;
+  }
+
+  function freeSocketTimeoutListener() {
+    debug('free socket idle timeout', name);
+    self.getPoolStats(name).evicted++;
+    socket.destroy();
+  }
+};
+
+function freeSocketErrorListener(err) {
+  debug('free socket error', err.message);
+  this.destroy();
+}
+
+// Take the most recently freed socket for |name| out of the freeSockets
+// pool, skipping any that have been closed since.
+Agent.prototype.takeFreeSocket = function(name) {
+  var freeSockets = this.freeSockets[name];
+  var socket = null;
+
+  while (freeSockets && freeSockets.length) {
+    var s = freeSockets.pop();
+    s.removeListener('error', freeSocketErrorListener);
+    if (s._agentTimeoutListener) {
+      s.setTimeout(0, s._agentTimeoutListener);
+      s._agentTimeoutListener = null;
+    }
+    if (!s.destroyed) {
+      socket = s;
+      break;
+    }
+  }
+
+  // don't leak
+  if (freeSockets && !freeSockets.length)
+    delete this.freeSockets[name];
+
+  return socket;
+};
+
+// Open connections until there are minSockets for the host of |options|,
+// so that a burst of requests doesn't have to wait for them.
+Agent.prototype.warmSockets = function(options) {
+  var self = this;
+  var name = self.getName(options);
+  var count = 0;
+  if (self.sockets[name])
+    count += self.sockets[name].length;
+  if (self.freeSockets[name])
+    count += self.freeSockets[name].length;
+
+  var max = Math.min(self.minSockets, self.maxSockets);
+  for (; count < max; count++) {
+    debug('warm socket', name);
+    warm(self.createSocket(null, options));
+  }
+
+  function warm(socket) {
+    socket.on('error', onError);
+    socket.once('connect', function() {
+      socket.removeListener('error', onError);
+      if (self.requests[name] && self.requests[name].length)
+        socket.emit('free');
+      else
+        self.addFreeSocket(socket, options);
+    });
+  }
+
+  function onError(err) {
+    debug('warm socket error', err.message);
+  }
+};
+
+// Counters for the host:port that |name| stands for.  The active, idle and
+// queued counts are only filled in by getPoolStats().
+function PoolStats() {
+  this.active = 0;
+  this.idle = 0;
+  this.queued = 0;
+  this.requests = 0;
+  this.created = 0;
+  this.reused = 0;
+  this.evicted = 0;
+  this.waited = 0;
+  this.waitTime = 0;
+}
+
+Agent.prototype.getPoolStats = function(name) {
+  if (util.isUndefined(name)) {
+    var all = {};
+    var names = Object.keys(this.poolStats);
+    for (var i = 0; i < names.length; i++)
+      all[names[i]] = this.getPoolStats(names[i]);
+    return all;
+  }
+
+  var stats = this.poolStats[name];
+  if (!stats)
+    stats = this.poolStats[name] = new PoolStats();
+  stats.active = this.sockets[name] ? this.sockets[name].length : 0;
+  stats.idle = this.freeSockets[name] ? this.freeSockets[name].length : 0;
+  stats.queued = this.requests[name] ? this.requests[name].length : 0;
+  return stats;
 };
 
 Agent.prototype.createSocket = function(req, options) {
@@ -194,6 +324,7 @@ Agent.prototype.createSocket = function(req, options) {
   debug('createConnection', name, options);
   options.encoding = null;
   var s = self.createConnection(options);
+  self.getPoolStats(name).created++;
   if (!self.sockets[name]) {
     self.sockets[name] = [];
   }
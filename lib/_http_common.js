@@ -196,6 +196,7 @@ exports.parsers = parsers;
 // should be all that is needed.
 function freeParser(parser, req, socket) {
   if (parser) {
+    parser.unconsume();
     parser._headers = [];
     parser.onIncoming = null;
     if (parser.socket)
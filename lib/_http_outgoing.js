@@ -22,8 +22,9 @@
 'use strict';
 
 var assert = require('assert').ok;
+var binding = process.binding('http_parser');
 var Stream = require('stream');
-var timers = require('timers');
+var Timer = process.binding('timer_wrap').Timer;
 var util = require('util');
 
 var common = require('_http_common');
@@ -31,6 +32,7 @@ var common = require('_http_common');
 var CRLF = common.CRLF;
 var chunkExpression = common.chunkExpression;
 var debug = common.debug;
+var serializeHeaders = binding.serializeHeaders;
 
 
 var connectionExpression = /Connection/i;
@@ -49,18 +51,25 @@ var automaticHeaders = {
 
 
 var dateCache;
+var dateTimer;
 function utcDate() {
   if (!dateCache) {
     var d = new Date();
     dateCache = d.toUTCString();
-    timers.enroll(utcDate, 1000 - d.getMilliseconds());
-    timers._unrefActive(utcDate);
+    // Not timers._unrefActive(), which rounds timeouts up to the idle
+    // timeout resolution and would keep the date past its second.
+    if (!dateTimer) {
+      dateTimer = new Timer();
+      dateTimer.unref();
+      dateTimer[Timer.kOnTimeout] = resetDateCache;
+    }
+    dateTimer.start(1000 - d.getMilliseconds(), 0);
   }
   return dateCache;
 }
-utcDate._onTimeout = function() {
+function resetDateCache() {
   dateCache = undefined;
-};
+}
 
 
 function OutgoingMessage() {
@@ -197,46 +206,19 @@ OutgoingMessage.prototype._buffer = function(data, encoding, callback) {
 OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
   // firstLine in the case of request is: 'GET /index.html HTTP/1.1\r\n'
   // in the case of response it is: 'HTTP/1.1 200 OK\r\n'
-  var state = {
-    sentConnectionHeader: false,
-    sentContentLengthHeader: false,
-    sentTransferEncodingHeader: false,
-    sentDateHeader: false,
-    sentExpect: false,
-    messageHeader: firstLine
-  };
-
-  var field, value;
-
-  if (headers) {
-    var keys = Object.keys(headers);
-    var isArray = util.isArray(headers);
-    var field, value;
-
-    for (var i = 0, l = keys.length; i < l; i++) {
-      var key = keys[i];
-      if (isArray) {
-        field = headers[key][0];
-        value = headers[key][1];
-      } else {
-        field = key;
-        value = headers[key];
-      }
+  var state = { messageHeader: firstLine };
+  var sendDate = this.sendDate === true;
 
-      if (util.isArray(value)) {
-        for (var j = 0; j < value.length; j++) {
-          storeHeader(this, state, field, value[j]);
-        }
-      } else {
-        storeHeader(this, state, field, value);
-      }
-    }
-  }
+  var flags = serializeHeaders(state, firstLine, headers, sendDate);
+  if (util.isUndefined(flags))
+    flags = storeHeaders(state, firstLine, headers, sendDate);
 
-  // Date header
-  if (this.sendDate === true && state.sentDateHeader === false) {
-    state.messageHeader += 'Date: ' + utcDate() + CRLF;
-  }
+  if (flags & binding.kConnectionClose)
+    this._last = true;
+  if (flags & binding.kConnectionKeepAlive)
+    this.shouldKeepAlive = true;
+  if (flags & binding.kChunkedEncoding)
+    this.chunkedEncoding = true;
 
   // Force the connection to close when the response is a 204 No Content or
   // a 304 Not Modified and the user has set a "Transfer-Encoding: chunked"
@@ -262,9 +244,9 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
   if (this._removedHeader.connection) {
     this._last = true;
     this.shouldKeepAlive = false;
-  } else if (state.sentConnectionHeader === false) {
+  } else if (!(flags & binding.kSentConnectionHeader)) {
     var shouldSendKeepAlive = this.shouldKeepAlive &&
-        (state.sentContentLengthHeader ||
+        ((flags & binding.kSentContentLengthHeader) ||
          this.useChunkedEncodingByDefault ||
          this.agent);
     if (shouldSendKeepAlive) {
@@ -275,8 +257,8 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
     }
   }
 
-  if (state.sentContentLengthHeader === false &&
-      state.sentTransferEncodingHeader === false) {
+  if (!(flags & binding.kSentContentLengthHeader) &&
+      !(flags & binding.kSentTransferEncodingHeader)) {
     if (this._hasBody && !this._removedHeader['transfer-encoding']) {
       if (this.useChunkedEncodingByDefault) {
         state.messageHeader += 'Transfer-Encoding: chunked\r\n';
@@ -295,10 +277,48 @@ OutgoingMessage.prototype._storeHeader = function(firstLine, headers) {
 
   // wait until the first body chunk, or close(), is sent to flush,
   // UNLESS we're sending Expect: 100-continue.
-  if (state.sentExpect) this._send('');
+  if (flags & binding.kSentExpect) this._send('');
 };
 
-function storeHeader(self, state, field, value) {
+// The slow path for serializeHeaders(): builds the header block when it
+// contains characters that don't fit in a one-byte string.
+function storeHeaders(state, firstLine, headers, sendDate) {
+  var flags = 0;
+  var field, value;
+
+  state.messageHeader = firstLine;
+
+  if (headers) {
+    var keys = Object.keys(headers);
+    var isArray = util.isArray(headers);
+
+    for (var i = 0, l = keys.length; i < l; i++) {
+      var key = keys[i];
+      if (isArray) {
+        field = headers[key][0];
+        value = headers[key][1];
+      } else {
+        field = key;
+        value = headers[key];
+      }
+
+      if (util.isArray(value)) {
+        for (var j = 0; j < value.length; j++) {
+          flags |= storeHeader(state, field, value[j]);
+        }
+      } else {
+        flags |= storeHeader(state, field, value);
+      }
+    }
+  }
+
+  if (sendDate && !(flags & binding.kSentDateHeader))
+    state.messageHeader += 'Date: ' + utcDate() + CRLF;
+
+  return flags;
+}
+
+function storeHeader(state, field, value) {
   // Protect against response splitting. The if statement is there to
   // minimize the performance impact in the common case.
   if (/[\r\n]/.test(value))
@@ -307,24 +327,21 @@ function storeHeader(self, state, field, value) {
   state.messageHeader += field + ': ' + value + CRLF;
 
   if (connectionExpression.test(field)) {
-    state.sentConnectionHeader = true;
-    if (closeExpression.test(value)) {
-      self._last = true;
-    } else {
-      self.shouldKeepAlive = true;
-    }
-
+    if (closeExpression.test(value))
+      return binding.kSentConnectionHeader | binding.kConnectionClose;
+    return binding.kSentConnectionHeader | binding.kConnectionKeepAlive;
   } else if (transferEncodingExpression.test(field)) {
-    state.sentTransferEncodingHeader = true;
-    if (chunkExpression.test(value)) self.chunkedEncoding = true;
-
+    if (chunkExpression.test(value))
+      return binding.kSentTransferEncodingHeader | binding.kChunkedEncoding;
+    return binding.kSentTransferEncodingHeader;
   } else if (contentLengthExpression.test(field)) {
-    state.sentContentLengthHeader = true;
+    return binding.kSentContentLengthHeader;
   } else if (dateExpression.test(field)) {
-    state.sentDateHeader = true;
+    return binding.kSentDateHeader;
   } else if (expectExpression.test(field)) {
-    state.sentExpect = true;
+    return binding.kSentExpect;
   }
+  return 0;
 }
 
 
@@ -451,11 +468,6 @@ OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
       ret = this._send(chunk, encoding, callback);
     } else {
       // buffer, or a non-toString-friendly encoding
-      if (util.isString(chunk))
-        len = Buffer.byteLength(chunk, encoding);
-      else
-        len = chunk.length;
-
       if (this.connection && !this.connection.corked) {
         this.connection.cork();
         var conn = this.connection;
@@ -464,10 +476,21 @@ OutgoingMessage.prototype.write = function(chunk, encoding, callback) {
             conn.uncork();
         });
       }
-      this._send(len.toString(16), 'binary', null);
-      this._send(crlf_buf, null, null);
-      this._send(chunk, encoding, null);
-      ret = this._send(crlf_buf, null, callback);
+
+      if (util.isBuffer(chunk) && chunk.length <= MAX_FRAMED_CHUNK) {
+        // write(chunk, callback) leaves the callback in encoding; _writeRaw()
+        // sorts that out.
+        ret = this._send(binding.frameChunk(chunk), encoding, callback);
+      } else {
+        if (util.isString(chunk))
+          len = Buffer.byteLength(chunk, encoding);
+        else
+          len = chunk.length;
+
+        this._send(len.toString(16) + CRLF, 'binary', null);
+        this._send(chunk, encoding, null);
+        ret = this._send(crlf_buf, null, callback);
+      }
     }
   } else {
     ret = this._send(chunk, encoding, callback);
@@ -500,6 +523,10 @@ OutgoingMessage.prototype.addTrailers = function(headers) {
 
 var crlf_buf = new Buffer('\r\n');
 
+// Buffers up to this size are copied into one framed chunk by write(),
+// bigger ones are written as they are, between the size line and CRLF.
+var MAX_FRAMED_CHUNK = 16 * 1024;
+
 
 OutgoingMessage.prototype.end = function(data, encoding, callback) {
   if (util.isFunction(data)) {
@@ -25,6 +25,7 @@ var util = require('util');
 var net = require('net');
 var EventEmitter = require('events').EventEmitter;
 var HTTPParser = process.binding('http_parser').HTTPParser;
+var kOnExecute = HTTPParser.kOnExecute | 0;
 var assert = require('assert').ok;
 
 var common = require('_http_common');
@@ -256,6 +257,10 @@ function Server(requestListener) {
   });
 
   this.timeout = 2 * 60 * 1000;
+
+  // Parse requests in C++ as they are read from the socket, instead of
+  // handing every chunk to JS land first.
+  this.nativeParsing = false;
 }
 util.inherits(Server, net.Server);
 
@@ -332,17 +337,50 @@ function connectionListener(socket) {
   socket.addListener('close', serverSocketCloseListener);
   parser.onIncoming = parserOnIncoming;
   socket.on('end', socketOnEnd);
-  socket.on('data', socketOnData);
+
+  if (self.nativeParsing && parser.consume(socket._handle)) {
+    // The parser reads straight from the handle now. The socket only sees
+    // EOF and errors, so it has to start and stop the handle by itself.
+    parser[kOnExecute] = onParserExecute;
+    socket.on('pause', onSocketPause);
+    socket.on('resume', onSocketResume);
+    socket.resume();
+  } else {
+    socket.on('data', socketOnData);
+  }
 
   // TODO(isaacs): Move all these functions out of here
   function socketOnError(e) {
     self.emit('clientError', e, this);
   }
 
+  // When a read contains pipelined requests, the responses that are written
+  // while it is being parsed are held back until the parser is done with it
+  // and then go out in a single writev() instead of a write() each. A lone
+  // request is written out right away, as before.
+  var requestsInRead = 0;
+
+  function uncorkResponses() {
+    if (requestsInRead > 1)
+      socket.uncork();
+    requestsInRead = 0;
+  }
+
   function socketOnData(d) {
     assert(!socket._paused);
     debug('SERVER socketOnData %d', d.length);
-    var ret = parser.execute(d);
+    onParserExecuteCommon(parser.execute(d), d);
+  }
+
+  function onParserExecute(ret, nread, d) {
+    debug('SERVER onParserExecute %d', nread);
+    socket.bytesRead += nread;
+    onParserExecuteCommon(ret, d);
+  }
+
+  function onParserExecuteCommon(ret, d) {
+    uncorkResponses();
+
     if (ret instanceof Error) {
       debug('parse error');
       socket.destroy(ret);
@@ -355,6 +393,8 @@ function connectionListener(socket) {
       socket.removeListener('data', socketOnData);
       socket.removeListener('end', socketOnEnd);
       socket.removeListener('close', serverSocketCloseListener);
+      socket.removeListener('pause', onSocketPause);
+      socket.removeListener('resume', onSocketResume);
       parser.finish();
       freeParser(parser, req, null);
       parser = null;
@@ -381,9 +421,27 @@ function connectionListener(socket) {
     }
   }
 
+  function onSocketPause() {
+    if (socket._handle && socket._handle.reading) {
+      socket._handle.reading = false;
+      socket._handle.readStop();
+    }
+  }
+
+  function onSocketResume() {
+    // 'resume' is emitted on the next tick, the socket may be paused again.
+    if (!socket._readableState.flowing)
+      return;
+    if (socket._handle && !socket._handle.reading) {
+      socket._handle.reading = true;
+      socket._handle.readStart();
+    }
+  }
+
   function socketOnEnd() {
     var socket = this;
     var ret = parser.finish();
+    uncorkResponses();
 
     if (ret instanceof Error) {
       debug('parse error');
@@ -422,6 +480,9 @@ function connectionListener(socket) {
   function parserOnIncoming(req, shouldKeepAlive) {
     incoming.push(req);
 
+    if (++requestsInRead === 2)
+      socket.cork();
+
     // If the writable end isn't consuming, then stop reading
     // so that we don't become overwhelmed by a flood of
     // pipelined requests that may never be resolved.
@@ -471,10 +532,13 @@ function connectionListener(socket) {
       if (res._last) {
         socket.destroySoon();
       } else {
-        // start sending the next message
+        // start sending the next message. Responses that were queued
+        // behind this one and have already finished are flushed in one go.
         var m = outgoing.shift();
         if (m) {
+          socket.cork();
           m.assignSocket(socket);
+          socket.uncork();
         }
       }
     }
@@ -0,0 +1,219 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+'use strict';
+
+var L = require('_linklist');
+var assert = require('assert').ok;
+
+// A hierarchical timing wheel, as described by Varghese and Lauck and used
+// by the Linux kernel for its timer lists. Time is measured in integral
+// ticks; what a tick means is up to the user of the wheel.
+//
+// Level 0 has one slot per tick for the next 256 ticks. Every level above
+// it has 64 slots, each 64 times as wide as a slot of the level below. An
+// item is filed in the lowest level that can hold its expiry, which makes
+// insertion and removal O(1). When the wheel turns past a slot boundary of
+// a higher level, that slot's items are cascaded down to where they now
+// belong. Five levels cover 2^32 ticks, which is more than any timeout can
+// ask for.
+
+var kRootSize = 256;
+var kLevelSize = 64;
+var kLevels = 5;
+
+// Width of a slot, in ticks, at each level.
+var spans = [1, 256, 16384, 1048576, 67108864];
+// Largest distance from the current tick that each level can hold.
+var limits = [256, 16384, 1048576, 67108864, Infinity];
+
+
+function TimerWheel() {
+  this.tick = 0;
+  this.size = 0;
+  this.counts = [0, 0, 0, 0, 0];
+  this.slots = new Array(kLevels);
+  for (var level = 0; level < kLevels; level++) {
+    var n = level === 0 ? kRootSize : kLevelSize;
+    var slots = this.slots[level] = new Array(n);
+    for (var i = 0; i < n; i++) {
+      slots[i] = {};
+      L.init(slots[i]);
+    }
+  }
+  // Items that are due but whose callbacks have not run yet. They stay
+  // here when a callback throws so the next advance() picks them up.
+  this.expired = {};
+  L.init(this.expired);
+  this.cascading = {};
+  L.init(this.cascading);
+}
+module.exports = TimerWheel;
+
+
+// Move all items of list `from` to the newer end of list `to`.
+function splice(from, to) {
+  if (L.isEmpty(from)) return;
+  var newest = from._idleNext;
+  var oldest = from._idlePrev;
+  var head = to._idleNext;
+  to._idleNext = newest;
+  newest._idlePrev = to;
+  oldest._idleNext = head;
+  head._idlePrev = oldest;
+  L.init(from);
+}
+
+
+// File `item` to expire at tick `expiry`. Expiries in the past are due on
+// the next call to advance().
+TimerWheel.prototype.insert = function(item, expiry) {
+  if (expiry < this.tick) expiry = this.tick;
+
+  var delta = expiry - this.tick;
+  var level = 0;
+  while (delta >= limits[level]) level++;
+
+  var index;
+  if (level === 0)
+    index = expiry % kRootSize;
+  else
+    index = Math.floor(expiry / spans[level]) % kLevelSize;
+
+  item._wheel = this;
+  item._wheelLevel = level;
+  item._wheelExpiry = expiry;
+  L.append(this.slots[level][index], item);
+  this.counts[level]++;
+  this.size++;
+};
+
+
+TimerWheel.prototype.remove = function(item) {
+  if (item._wheel !== this) return;
+  L.remove(item);
+  this.counts[item._wheelLevel]--;
+  this.size--;
+  item._wheel = null;
+};
+
+
+// Start counting from `tick`. Only valid while the wheel is empty.
+TimerWheel.prototype.reset = function(tick) {
+  assert(this.size === 0);
+  this.tick = tick;
+};
+
+
+// Turn the wheel up to and including `now`, calling `fn` for every item
+// that expires along the way, in order of expiry. `fn` is free to insert
+// or remove items. If it throws, the wheel is left in a consistent state
+// and the remaining due items are reported by the next call.
+TimerWheel.prototype.advance = function(now, fn) {
+  this.drain(fn);
+
+  while (this.tick <= now) {
+    if (this.size === 0) {
+      this.tick = now + 1;
+      break;
+    }
+
+    if (this.counts[0] === 0) {
+      // Nothing on level 0, skip ahead to the next cascade that moves
+      // items instead of visiting every slot on the way.
+      var next = this.nextExpiry();
+      this.tick = next <= now + 1 ? next : now + 1;
+    } else {
+      splice(this.slots[0][this.tick % kRootSize], this.expired);
+      this.tick++;
+    }
+
+    if (this.tick % kRootSize === 0)
+      this.cascade();
+
+    this.drain(fn);
+  }
+};
+
+
+TimerWheel.prototype.drain = function(fn) {
+  var item;
+  while (item = L.peek(this.expired)) {
+    this.remove(item);
+    fn(item);
+  }
+};
+
+
+// Redistribute the higher level slots that the current tick has reached.
+TimerWheel.prototype.cascade = function() {
+  for (var level = 1; level < kLevels; level++) {
+    var index = Math.floor(this.tick / spans[level]) % kLevelSize;
+    var slot = this.slots[level][index];
+    var item;
+
+    splice(slot, this.cascading);
+    while (item = L.peek(this.cascading)) {
+      this.remove(item);
+      this.insert(item, item._wheelExpiry);
+    }
+
+    // Only go up a level when this one has wrapped around.
+    if (index !== 0) break;
+  }
+};
+
+
+// The tick at which advance() next has work to do, or -1 if the wheel is
+// empty. That is either the expiry of the earliest item on level 0 or the
+// next cascade that moves items, whichever comes first.
+TimerWheel.prototype.nextExpiry = function() {
+  if (this.size === 0) return -1;
+  if (!L.isEmpty(this.expired)) return this.tick;
+
+  var best = -1;
+  var i;
+
+  if (this.counts[0] > 0) {
+    for (i = 0; i < kRootSize; i++) {
+      if (!L.isEmpty(this.slots[0][(this.tick + i) % kRootSize])) {
+        best = this.tick + i;
+        break;
+      }
+    }
+  }
+
+  for (var level = 1; level < kLevels; level++) {
+    if (this.counts[level] === 0) continue;
+    var span = spans[level];
+    var base = this.tick - this.tick % span;
+    for (i = 1; i <= kLevelSize; i++) {
+      var at = base + i * span;
+      if (best !== -1 && at >= best) break;
+      if (!L.isEmpty(this.slots[level][(at / span) % kLevelSize])) {
+        best = at;
+        break;
+      }
+    }
+  }
+
+  return best;
+};
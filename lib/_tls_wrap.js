@@ -107,6 +107,13 @@ function loadSNI(self, servername, cb) {
   if (!servername || !self._SNICallback)
     return cb(null);
 
+  // The SNICallback is only consulted for servernames that aren't in the map
+  var ctx = self._sniContexts && self._sniContexts.lookup(servername);
+  if (ctx) {
+    self.ssl.sni_context = ctx;
+    return cb(null, ctx);
+  }
+
   var once = false;
   self._SNICallback(servername, function(err, context) {
     if (once)
@@ -225,6 +232,41 @@ function onocspresponse(resp) {
 }
 
 
+// Delay, in seconds, before retrying a failed OCSP cache refresh.
+var kOCSPRetryDelay = 60;
+
+// Called from C++ during the handshake when the OCSP response cached on
+// `ctx` is missing or about to expire.  The handshake doesn't wait for the
+// refresh; it staples whatever is cached at that moment.
+function onocsprefresh(ctx) {
+  var server = this.server;
+
+  if (!server || listenerCount(server, 'OCSPRequest') === 0)
+    return ctx.deferOCSPRefresh(kOCSPRetryDelay);
+
+  server.emit('OCSPRequest',
+              ctx.getCertificate(),
+              ctx.getIssuer(),
+              onOCSP);
+
+  var once = false;
+  function onOCSP(err, response) {
+    if (once)
+      return;
+    once = true;
+
+    if (err || !response)
+      return ctx.deferOCSPRefresh(kOCSPRetryDelay);
+
+    try {
+      ctx.setOCSPResponse(response);
+    } catch (e) {
+      ctx.deferOCSPRefresh(kOCSPRetryDelay);
+    }
+  }
+}
+
+
 /**
  * Provides a wrap of socket stream to do encrypted communication.
  */
@@ -250,6 +292,7 @@ function TLSSocket(socket, options) {
   this._newSessionPending = false;
   this._controlReleased = false;
   this._SNICallback = null;
+  this._sniContexts = null;
   this.ssl = null;
   this.servername = null;
   this.npnProtocol = null;
@@ -316,10 +359,18 @@ TLSSocket.prototype._init = function(socket) {
     this.ssl.lastHandshakeTime = 0;
     this.ssl.handshakes = 0;
 
+    // With the OCSP cache enabled, responses are stapled from C++ and the
+    // ClientHello doesn't need to go through JS just for 'OCSPRequest'.
+    var ocspCache = this.server && this.server.ocspCache;
+    if (ocspCache) {
+      this.ssl.onocsprefresh = onocsprefresh.bind(this);
+      this.ssl.enableOCSPCache(this.server.ocspRefreshTimeout);
+    }
+
     if (this.server &&
         (listenerCount(this.server, 'resumeSession') > 0 ||
          listenerCount(this.server, 'newSession') > 0 ||
-         listenerCount(this.server, 'OCSPRequest') > 0)) {
+         (!ocspCache && listenerCount(this.server, 'OCSPRequest') > 0))) {
       this.ssl.enableSessionCallbacks();
     }
   } else {
@@ -351,17 +402,20 @@ TLSSocket.prototype._init = function(socket) {
     }
   };
 
-  // If custom SNICallback was given, or if
-  // there're SNI contexts to perform match against -
-  // set `.onsniselect` callback.
   if (process.features.tls_sni &&
       options.isServer &&
-      options.server &&
-      (options.SNICallback !== SNICallback ||
-       options.server._contexts.length)) {
+      options.server) {
     assert(typeof options.SNICallback === 'function');
     this._SNICallback = options.SNICallback;
-    this.ssl.enableHelloParser();
+
+    // Contexts added with `server.addContext()` are picked in C++ during the
+    // handshake, only a custom SNICallback needs to pause it for JS.
+    if (options.server._sniContextCount > 0) {
+      this._sniContexts = options.server._sniContexts;
+      this.ssl.setSNIContextMap(this._sniContexts);
+    }
+    if (options.SNICallback !== SNICallback)
+      this.ssl.enableHelloParser();
   }
 
   if (process.features.tls_npn && options.NPNProtocols)
@@ -590,7 +644,8 @@ function Server(/* [options], listener */) {
 
   if (!(this instanceof Server)) return new Server(options, listener);
 
-  this._contexts = [];
+  this._sniContexts = new tls_wrap.SNIContextMap();
+  this._sniContextCount = 0;
 
   var self = this;
 
@@ -727,6 +782,9 @@ Server.prototype.setOptions = function(options) {
   if (options.dhparam) this.dhparam = options.dhparam;
   if (options.sessionTimeout) this.sessionTimeout = options.sessionTimeout;
   if (options.ticketKeys) this.ticketKeys = options.ticketKeys;
+  this.ocspCache = !!options.ocspCache;
+  if (options.ocspRefreshTimeout)
+    this.ocspRefreshTimeout = options.ocspRefreshTimeout;
   var secureOptions = options.secureOptions || 0;
   if (options.honorCipherOrder)
     this.honorCipherOrder = true;
@@ -749,24 +807,13 @@ Server.prototype.addContext = function(servername, context) {
     throw new Error('Servername is required parameter for Server.addContext');
   }
 
-  var re = new RegExp('^' +
-                      servername.replace(/([\.^$+?\-\\[\]{}])/g, '\\$1')
-                                .replace(/\*/g, '[^\.]*') +
-                      '$');
-  this._contexts.push([re, tls.createSecureContext(context).context]);
+  var ctx = tls.createSecureContext(context).context;
+  this._sniContexts.add(servername, ctx);
+  this._sniContextCount++;
 };
 
 function SNICallback(servername, callback) {
-  var ctx;
-
-  this.server._contexts.some(function(elem) {
-    if (!util.isNull(servername.match(elem[0]))) {
-      ctx = elem[1];
-      return true;
-    }
-  });
-
-  callback(null, ctx);
+  callback(null, this.server._sniContexts.lookup(servername));
 }
 
 
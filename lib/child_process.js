@@ -325,38 +325,241 @@ function handleMessage(target, message, handle) {
   target.emit(eventName, message, handle);
 }
 
-function setupChannel(target, channel) {
-  target._channel = channel;
-  target._handleQueue = null;
+// There will be at most one NODE_HANDLE message in every chunk we read
+// because SCM_RIGHTS messages don't get coalesced. Make sure that we deliver
+// the handle with the right message however.
+function dispatchMessage(target, message, recvHandle) {
+  if (message && message.cmd === 'NODE_HANDLE')
+    handleMessage(target, message, recvHandle);
+  else
+    handleMessage(target, message, undefined);
+}
+
 
+// The default serialization: one JSON document per line.
+function writeJSONMessage(channel, req, message, handle) {
+  var string = JSON.stringify(message) + '\n';
+  return channel.writeUtf8String(req, string, handle);
+}
+
+function createJSONReader() {
   var decoder = new StringDecoder('utf8');
   var jsonBuffer = '';
-  channel.buffering = false;
-  channel.onread = function(nread, pool, recvHandle) {
-    // TODO(bnoordhuis) Check that nread > 0.
-    if (pool) {
-      jsonBuffer += decoder.write(pool);
 
-      var i, start = 0;
+  // Returns true if part of a message is left over.
+  return function(pool, target, recvHandle) {
+    jsonBuffer += decoder.write(pool);
 
-      //Linebreak is used as a message end sign
-      while ((i = jsonBuffer.indexOf('\n', start)) >= 0) {
-        var json = jsonBuffer.slice(start, i);
-        var message = JSON.parse(json);
+    var i, start = 0;
 
-        // There will be at most one NODE_HANDLE message in every chunk we
-        // read because SCM_RIGHTS messages don't get coalesced. Make sure
-        // that we deliver the handle with the right message however.
-        if (message && message.cmd === 'NODE_HANDLE')
-          handleMessage(target, message, recvHandle);
-        else
-          handleMessage(target, message, undefined);
+    //Linebreak is used as a message end sign
+    while ((i = jsonBuffer.indexOf('\n', start)) >= 0) {
+      var json = jsonBuffer.slice(start, i);
+      dispatchMessage(target, JSON.parse(json), recvHandle);
+      start = i + 1;
+    }
+    jsonBuffer = jsonBuffer.slice(start);
+    return jsonBuffer.length !== 0;
+  };
+}
+
+
+// The 'binary' serialization. Every message is a frame:
+//
+//   uint32le  size of the rest of the frame
+//   uint32le  size of the JSON text
+//   uint32le  number of buffers, n
+//   uint32le  size of each buffer, n times
+//   the JSON text, utf8
+//   the buffers, back to back
+//
+// Buffers in arrays and plain objects are taken out of the message before it
+// is stringified and are written as-is. The JSON text has a placeholder in
+// their place. On the receiving end they become slices of the read buffer.
+var BUFFER_KEY = '\u0000NODE_BUFFER';
+
+// Cheap check that lets the common case skip the copying walk below.
+function containsBuffers(value) {
+  if (typeof value !== 'object' || value === null)
+    return false;
+
+  if (value instanceof Buffer)
+    return true;
+
+  if (Array.isArray(value)) {
+    for (var i = 0; i < value.length; i++) {
+      if (containsBuffers(value[i]))
+        return true;
+    }
+    return false;
+  }
+
+  var proto = Object.getPrototypeOf(value);
+  if (proto !== Object.prototype && proto !== null)
+    return false;
+
+  for (var key in value) {
+    if (containsBuffers(value[key]))
+      return true;
+  }
+  return false;
+}
+
+function extractBuffers(value, buffers) {
+  if (typeof value !== 'object' || value === null)
+    return value;
+
+  if (value instanceof Buffer) {
+    var placeholder = {};
+    placeholder[BUFFER_KEY] = buffers.push(value) - 1;
+    return placeholder;
+  }
+
+  var copy = null;
+  var i, v;
+
+  if (Array.isArray(value)) {
+    for (i = 0; i < value.length; i++) {
+      v = extractBuffers(value[i], buffers);
+      if (v !== value[i]) {
+        if (copy === null) copy = value.slice(0);
+        copy[i] = v;
+      }
+    }
+    return copy || value;
+  }
+
+  // Leave class instances, dates and the like to JSON.stringify().
+  var proto = Object.getPrototypeOf(value);
+  if (proto !== Object.prototype && proto !== null)
+    return value;
+
+  var keys = Object.keys(value);
+  for (i = 0; i < keys.length; i++) {
+    v = extractBuffers(value[keys[i]], buffers);
+    if (v !== value[keys[i]]) {
+      if (copy === null) copy = util._extend({}, value);
+      copy[keys[i]] = v;
+    }
+  }
+  return copy || value;
+}
+
+function writeFrameHeader(buf, jsonLength, buffers) {
+  var size = 8 + 4 * buffers.length + jsonLength;
+
+  buf.writeUInt32LE(jsonLength, 4, true);
+  buf.writeUInt32LE(buffers.length, 8, true);
+  for (var i = 0; i < buffers.length; i++) {
+    buf.writeUInt32LE(buffers[i].length, 12 + 4 * i, true);
+    size += buffers[i].length;
+  }
+  buf.writeUInt32LE(size, 0, true);
+}
+
+function writeBinaryMessage(channel, req, message, handle) {
+  // The common case, a message without buffers, is framed in C++ so that it
+  // can go out in a single write without any intermediate buffer.
+  if (!containsBuffers(message))
+    return channel.writeUtf8Frame(req, JSON.stringify(message), handle);
+
+  var buffers = [];
+  var json = JSON.stringify(extractBuffers(message, buffers));
+  var jsonLength = Buffer.byteLength(json);
+  var header = new Buffer(12 + 4 * buffers.length);
+  var chunks = [header, 'buffer', json, 'utf8'];
+
+  writeFrameHeader(header, jsonLength, buffers);
+  for (var i = 0; i < buffers.length; i++)
+    chunks.push(buffers[i], 'buffer');
+
+  // Keep the buffers alive until the write completes.
+  req.chunks = chunks;
+  return channel.writev(req, chunks, handle);
+}
+
+function decodeBinaryFrame(buf, start) {
+  var jsonLength = buf.readUInt32LE(start, true);
+  var count = buf.readUInt32LE(start + 4, true);
+  var offset = start + 8 + 4 * count;
+  var json = buf.utf8Slice(offset, offset + jsonLength);
+
+  if (count === 0)
+    return JSON.parse(json);
+
+  var buffers = new Array(count);
+  offset += jsonLength;
+  for (var i = 0; i < count; i++) {
+    var length = buf.readUInt32LE(start + 8 + 4 * i, true);
+    buffers[i] = buf.slice(offset, offset + length);
+    offset += length;
+  }
 
-        start = i + 1;
+  return JSON.parse(json, function(key, value) {
+    if (util.isObject(value) && util.isNumber(value[BUFFER_KEY]))
+      return buffers[value[BUFFER_KEY]];
+    return value;
+  });
+}
+
+function createBinaryReader() {
+  var chunks = [];
+  var length = 0;
+  var needed = 4;
+
+  // Returns true if part of a message is left over.
+  return function(pool, target, recvHandle) {
+    chunks.push(pool);
+    length += pool.length;
+
+    // Only join the chunks once the whole frame is in.
+    if (length < needed)
+      return true;
+
+    var buf = chunks.length === 1 ? chunks[0] : Buffer.concat(chunks, length);
+    var offset = 0;
+
+    needed = 4;
+    while (buf.length - offset >= 4) {
+      var size = buf.readUInt32LE(offset, true);
+      if (buf.length - offset - 4 < size) {
+        needed = 4 + size;
+        break;
       }
-      jsonBuffer = jsonBuffer.slice(start);
-      this.buffering = jsonBuffer.length !== 0;
+      dispatchMessage(target, decodeBinaryFrame(buf, offset + 4), recvHandle);
+      offset += 4 + size;
+    }
 
+    if (offset === buf.length) {
+      chunks = [];
+      length = 0;
+    } else {
+      chunks = [buf.slice(offset)];
+      length = buf.length - offset;
+    }
+    return length !== 0;
+  };
+}
+
+
+function setupChannel(target, channel, serialization) {
+  target._channel = channel;
+  target._handleQueue = null;
+
+  var readMessages, writeMessage;
+  if (serialization === 'binary') {
+    readMessages = createBinaryReader();
+    writeMessage = writeBinaryMessage;
+  } else {
+    readMessages = createJSONReader();
+    writeMessage = writeJSONMessage;
+  }
+
+  channel.buffering = false;
+  channel.onread = function(nread, pool, recvHandle) {
+    // TODO(bnoordhuis) Check that nread > 0.
+    if (pool) {
+      this.buffering = readMessages(pool, target, recvHandle);
     } else {
       this.buffering = false;
       target.disconnect();
@@ -476,8 +679,7 @@ function setupChannel(target, channel) {
     }
 
     var req = { oncomplete: nop };
-    var string = JSON.stringify(message) + '\n';
-    var err = channel.writeUtf8String(req, string, handle);
+    var err = writeMessage(channel, req, message, handle);
 
     if (err) {
       if (!swallowErrors)
@@ -580,12 +782,12 @@ exports.fork = function(modulePath /*, args, options*/) {
 };
 
 
-exports._forkChild = function(fd) {
+exports._forkChild = function(fd, serialization) {
   // set process.send()
   var p = createPipe(true);
   p.open(fd);
   p.unref();
-  setupChannel(process, p);
+  setupChannel(process, p, serialization);
 
   var refs = 0;
   process.on('newListener', function(name) {
@@ -983,6 +1185,7 @@ var spawn = exports.spawn = function(/*file, args, options*/) {
     detached: !!options.detached,
     envPairs: opts.envPairs,
     stdio: options.stdio,
+    serialization: options.serialization,
     uid: options.uid,
     gid: options.gid
   });
@@ -1102,6 +1305,12 @@ ChildProcess.prototype.spawn = function(options) {
       // If no `stdio` option was given - use default
       stdio = options.stdio || 'pipe';
 
+  if (!util.isUndefined(options.serialization) &&
+      options.serialization !== 'json' &&
+      options.serialization !== 'binary') {
+    throw new TypeError('serialization must be "json" or "binary"');
+  }
+
   stdio = _validateStdio(stdio, false);
 
   ipc = stdio.ipc;
@@ -1112,6 +1321,8 @@ ChildProcess.prototype.spawn = function(options) {
     // Let child process know about opened IPC channel
     options.envPairs = options.envPairs || [];
     options.envPairs.push('NODE_CHANNEL_FD=' + ipcFd);
+    if (options.serialization === 'binary')
+      options.envPairs.push('NODE_CHANNEL_SERIALIZATION=binary');
   }
 
   this.spawnfile = options.file;
@@ -1181,7 +1392,7 @@ ChildProcess.prototype.spawn = function(options) {
   });
 
   // Add .send() method and start listening for IPC data
-  if (!util.isUndefined(ipc)) setupChannel(this, ipc);
+  if (!util.isUndefined(ipc)) setupChannel(this, ipc, options.serialization);
 
   return err;
 };
@@ -1262,6 +1473,7 @@ function spawnSync(/*file, args, options*/) {
 
   options.file = opts.file;
   options.args = opts.args;
+  options.envPairs = opts.envPairs;
 
   if (options.killSignal)
     options.killSignal = lookupSignal(options.killSignal);
@@ -323,6 +323,7 @@ function masterInit() {
       env: workerEnv,
       silent: cluster.settings.silent,
       execArgv: execArgv,
+      serialization: cluster.settings.serialization,
       gid: cluster.settings.gid,
       uid: cluster.settings.uid
     });
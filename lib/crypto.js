@@ -113,7 +113,14 @@ Hash.prototype._flush = function(callback) {
   callback();
 };
 
-Hash.prototype.update = function(data, encoding) {
+Hash.prototype.update = function(data, encoding, length) {
+  if (util.isNumber(encoding)) {
+    // update(buffer, offset[, length])
+    if (!util.isBuffer(data))
+      throw new TypeError('data must be a buffer when an offset is given');
+    this._handle.update(data, encoding, length);
+    return this;
+  }
   encoding = encoding || exports.DEFAULT_ENCODING;
   if (encoding === 'buffer' && util.isString(data))
     encoding = 'binary';
@@ -128,6 +135,11 @@ Hash.prototype.digest = function(outputEncoding) {
 };
 
 
+Hash.prototype.digestInto = function(buffer, offset) {
+  return this._handle.digestInto(buffer, offset);
+};
+
+
 exports.createHmac = exports.Hmac = Hmac;
 
 function Hmac(hmac, key, options) {
@@ -142,6 +154,7 @@ util.inherits(Hmac, LazyTransform);
 
 Hmac.prototype.update = Hash.prototype.update;
 Hmac.prototype.digest = Hash.prototype.digest;
+Hmac.prototype.digestInto = Hash.prototype.digestInto;
 Hmac.prototype._flush = Hash.prototype._flush;
 Hmac.prototype._transform = Hash.prototype._transform;
 
@@ -168,8 +181,35 @@ function Cipher(cipher, password, options) {
 
 util.inherits(Cipher, LazyTransform);
 
+// Output of the cipher streams is carved out of a shared pool, like
+// fs.ReadStream does, instead of allocating a new buffer for every chunk.
+// The largest block size OpenSSL supports is EVP_MAX_BLOCK_LENGTH (32).
+var kMaxBlockSize = 32;
+var kPoolSize = 64 * 1024;
+var pool;
+
+function allocNewPool(poolSize) {
+  pool = new Buffer(poolSize);
+  pool.used = 0;
+}
+
 Cipher.prototype._transform = function(chunk, encoding, callback) {
-  this.push(this._handle.update(chunk, encoding));
+  var needed = chunk.length + kMaxBlockSize;
+  if (!util.isBuffer(chunk) || needed > kPoolSize) {
+    this.push(this._handle.update(chunk, encoding));
+    callback();
+    return;
+  }
+
+  if (!pool || pool.length - pool.used < needed)
+    allocNewPool(kPoolSize);
+
+  var start = pool.used;
+  var n = this._handle.updateInto(chunk, 0, chunk.length, pool, start);
+  if (n > 0) {
+    pool.used += n;
+    this.push(pool.slice(start, start + n));
+  }
   callback();
 };
 
@@ -198,6 +238,17 @@ Cipher.prototype.update = function(data, inputEncoding, outputEncoding) {
 };
 
 
+Cipher.prototype.updateInto = function(data, offset, length, output,
+                                       outputOffset) {
+  return this._handle.updateInto(data, offset, length, output, outputOffset);
+};
+
+
+Cipher.prototype.finalInto = function(output, outputOffset) {
+  return this._handle.finalInto(output, outputOffset);
+};
+
+
 Cipher.prototype.final = function(outputEncoding) {
   outputEncoding = outputEncoding || exports.DEFAULT_ENCODING;
   var ret = this._handle.final();
@@ -245,7 +296,9 @@ util.inherits(Cipheriv, LazyTransform);
 Cipheriv.prototype._transform = Cipher.prototype._transform;
 Cipheriv.prototype._flush = Cipher.prototype._flush;
 Cipheriv.prototype.update = Cipher.prototype.update;
+Cipheriv.prototype.updateInto = Cipher.prototype.updateInto;
 Cipheriv.prototype.final = Cipher.prototype.final;
+Cipheriv.prototype.finalInto = Cipher.prototype.finalInto;
 Cipheriv.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
 Cipheriv.prototype.getAuthTag = Cipher.prototype.getAuthTag;
 Cipheriv.prototype.setAuthTag = Cipher.prototype.setAuthTag;
@@ -268,7 +321,9 @@ util.inherits(Decipher, LazyTransform);
 Decipher.prototype._transform = Cipher.prototype._transform;
 Decipher.prototype._flush = Cipher.prototype._flush;
 Decipher.prototype.update = Cipher.prototype.update;
+Decipher.prototype.updateInto = Cipher.prototype.updateInto;
 Decipher.prototype.final = Cipher.prototype.final;
+Decipher.prototype.finalInto = Cipher.prototype.finalInto;
 Decipher.prototype.finaltol = Cipher.prototype.final;
 Decipher.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
 Decipher.prototype.getAuthTag = Cipher.prototype.getAuthTag;
@@ -293,7 +348,9 @@ util.inherits(Decipheriv, LazyTransform);
 Decipheriv.prototype._transform = Cipher.prototype._transform;
 Decipheriv.prototype._flush = Cipher.prototype._flush;
 Decipheriv.prototype.update = Cipher.prototype.update;
+Decipheriv.prototype.updateInto = Cipher.prototype.updateInto;
 Decipheriv.prototype.final = Cipher.prototype.final;
+Decipheriv.prototype.finalInto = Cipher.prototype.finalInto;
 Decipheriv.prototype.finaltol = Cipher.prototype.final;
 Decipheriv.prototype.setAutoPadding = Cipher.prototype.setAutoPadding;
 Decipheriv.prototype.getAuthTag = Cipher.prototype.getAuthTag;
@@ -617,6 +674,67 @@ function pbkdf2(password, salt, iterations, keylen, digest, callback) {
 }
 
 
+exports.hashBatch = function(algorithm, data, callback) {
+  return hashBatch(algorithm, undefined, data, callback);
+};
+
+
+exports.hmacBatch = function(algorithm, key, data, callback) {
+  if (util.isArray(key)) {
+    key = toBufArray(key);
+  } else {
+    key = toBuf(key);
+    if (!util.isBuffer(key))
+      throw new TypeError('key must be a string, a buffer or an array');
+  }
+  return hashBatch(algorithm, key, data, callback);
+};
+
+
+// Like toBuf() but for arrays; only copies the array if it contains strings.
+function toBufArray(list) {
+  var ret = list;
+  for (var i = 0; i < list.length; i++) {
+    if (util.isString(list[i])) {
+      if (ret === list)
+        ret = list.slice();
+      ret[i] = toBuf(list[i]);
+    }
+  }
+  return ret;
+}
+
+
+function hashBatch(algorithm, keys, data, callback) {
+  if (!util.isArray(data))
+    throw new TypeError('data must be an array');
+
+  if (!util.isUndefined(callback) && !util.isFunction(callback))
+    throw new TypeError('callback must be a function');
+
+  data = toBufArray(data);
+
+  if (exports.DEFAULT_ENCODING === 'buffer')
+    return binding.hashBatch(algorithm, data, keys, callback);
+
+  // at this point, we need to handle encodings.
+  var encoding = exports.DEFAULT_ENCODING;
+  var encode = function(digest) {
+    return digest.toString(encoding);
+  };
+  if (callback) {
+    var next = function(er, ret) {
+      if (ret)
+        ret = ret.map(encode);
+      callback(er, ret);
+    };
+    binding.hashBatch(algorithm, data, keys, next);
+  } else {
+    return binding.hashBatch(algorithm, data, keys).map(encode);
+  }
+}
+
+
 exports.Certificate = Certificate;
 
 function Certificate() {
@@ -657,10 +775,51 @@ exports.setEngine = function setEngine(id, flags) {
   return binding.setEngine(id, flags);
 };
 
-exports.randomBytes = randomBytes;
+var randomPool = null;
+var randomPoolMaxRequest = 0;
+
+exports.setRandomBytesPool = function(options) {
+  if (util.isNullOrUndefined(options) || options.size === 0) {
+    randomPool = null;
+    randomPoolMaxRequest = 0;
+    return;
+  }
+
+  if (!util.isObject(options))
+    throw new TypeError('options must be an object');
+
+  var size = util.isUndefined(options.size) ? 64 * 1024 : options.size;
+  var threshold = util.isUndefined(options.threshold) ?
+      size >>> 1 : options.threshold;
+  var maxRequest = util.isUndefined(options.maxRequestSize) ?
+      Math.min(1024, size) : options.maxRequestSize;
+
+  if (!util.isNumber(maxRequest) || maxRequest < 0 || maxRequest > size)
+    throw new RangeError('maxRequestSize must be between 0 and size');
+
+  randomPool = new binding.RandomBytesPool(size, threshold);
+  randomPoolMaxRequest = maxRequest;
+};
+
+exports.randomBytes = exports.rng = function(size, callback) {
+  if (randomPool !== null && util.isNumber(size) &&
+      size <= randomPoolMaxRequest) {
+    // Falls through to the thread pool when the pool is exhausted.
+    var buf = randomPool.read(size);
+    if (buf) {
+      if (!util.isFunction(callback))
+        return buf;
+      process.nextTick(function() {
+        callback(null, buf);
+      });
+      return;
+    }
+  }
+  return randomBytes(size, callback);
+};
+
 exports.pseudoRandomBytes = pseudoRandomBytes;
 
-exports.rng = randomBytes;
 exports.prng = pseudoRandomBytes;
 
 
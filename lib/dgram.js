@@ -68,6 +68,7 @@ function newHandle(type) {
     handle.lookup = lookup6;
     handle.bind = handle.bind6;
     handle.send = handle.send6;
+    handle.sendBatch = handle.sendBatch6;
     return handle;
   }
 
@@ -116,6 +117,9 @@ function Socket(type, listener) {
   // If true - UV_UDP_REUSEADDR flag will be set
   this._reuseAddr = options && options.reuseAddr;
 
+  // If true - read several datagrams per system call where supported
+  this._recvBatch = !!(options && options.recvBatch);
+
   if (util.isFunction(listener))
     this.on('message', listener);
 }
@@ -130,6 +134,11 @@ exports.createSocket = function(type, listener) {
 
 function startListening(socket) {
   socket._handle.onmessage = onMessage;
+  if (socket._recvBatch) {
+    socket._handle.onmessages = onMessages;
+    // Not an error when unsupported, datagrams just come in one by one.
+    socket._handle.setRecvBatch(true);
+  }
   // Todo: handle errors
   socket._handle.recvStart();
   socket._receiving = true;
@@ -145,6 +154,7 @@ function replaceHandle(self, newHandle) {
   newHandle.lookup = self._handle.lookup;
   newHandle.bind = self._handle.bind;
   newHandle.send = self._handle.send;
+  newHandle.sendBatch = self._handle.sendBatch;
   newHandle.owner = self;
 
   // Replace the existing handle by the handle we got from master.
@@ -298,18 +308,8 @@ Socket.prototype.send = function(buffer,
   // If the socket hasn't been bound yet, push the outbound packet onto the
   // send queue and send after binding is complete.
   if (self._bindState != BIND_STATE_BOUND) {
-    // If the send queue hasn't been initialized yet, do it, and install an
-    // event handler that flushes the send queue after binding is done.
-    if (!self._sendQueue) {
-      self._sendQueue = [];
-      self.once('listening', function() {
-        // Flush the send queue.
-        for (var i = 0; i < self._sendQueue.length; i++)
-          self.send.apply(self, self._sendQueue[i]);
-        self._sendQueue = undefined;
-      });
-    }
-    self._sendQueue.push([buffer, offset, length, port, address, callback]);
+    enqueue(self, self.send,
+            [buffer, offset, length, port, address, callback]);
     return;
   }
 
@@ -342,11 +342,149 @@ Socket.prototype.send = function(buffer,
 };
 
 
+// Queue a call to send() or sendBatch() for when binding is complete.
+function enqueue(self, method, args) {
+  // If the send queue hasn't been initialized yet, do it, and install an
+  // event handler that flushes the send queue after binding is done.
+  if (!self._sendQueue) {
+    self._sendQueue = [];
+    self.once('listening', function() {
+      // Flush the send queue.
+      for (var i = 0; i < self._sendQueue.length; i++)
+        self._sendQueue[i][0].apply(self, self._sendQueue[i][1]);
+      self._sendQueue = undefined;
+    });
+  }
+  self._sendQueue.push([method, args]);
+}
+
+
 function afterSend(err) {
   this.callback(err ? errnoException(err, 'send') : null, this.length);
 }
 
 
+// Send many datagrams with one call into the binding.  Runs of datagrams
+// of the same size to the same destination are handed to the kernel in one
+// go where it supports UDP segmentation offload.
+Socket.prototype.sendBatch = function(messages, callback) {
+  var self = this;
+
+  if (!util.isArray(messages))
+    throw new TypeError('First argument must be an array.');
+
+  // Flattened to [buffer, port, address, ...] for the binding.
+  var list = new Array(messages.length * 3);
+
+  for (var i = 0; i < messages.length; i++) {
+    var message = messages[i];
+    if (!util.isObject(message))
+      throw new TypeError('Messages must be objects.');
+
+    var buffer = message.buffer;
+    if (util.isString(buffer))
+      buffer = new Buffer(buffer);
+
+    if (!util.isBuffer(buffer))
+      throw new TypeError('Message buffer must be a buffer or string.');
+
+    var port = message.port | 0;
+    if (port <= 0 || port > 65535)
+      throw new RangeError('Port should be > 0 and < 65536');
+
+    list[i * 3] = buffer;
+    list[i * 3 + 1] = port;
+    list[i * 3 + 2] = message.address;
+  }
+
+  if (!util.isFunction(callback))
+    callback = undefined;
+
+  self._healthCheck();
+
+  if (self._bindState == BIND_STATE_UNBOUND)
+    self.bind(0, null);
+
+  if (self._bindState != BIND_STATE_BOUND) {
+    enqueue(self, sendBatch, [list, callback]);
+    return;
+  }
+
+  sendBatch.call(self, list, callback);
+};
+
+
+function sendBatch(list, callback) {
+  var self = this;
+  var ips = Object.create(null);
+  var waiting = 1;
+  var failed = false;
+
+  // Look every destination up once.
+  for (var i = 2; i < list.length; i += 3) {
+    if (!(list[i] in ips)) {
+      ips[list[i]] = null;
+      waiting++;
+      resolve(list[i]);
+    }
+  }
+
+  if (--waiting === 0)
+    send();
+
+  function resolve(address) {
+    self._handle.lookup(address, function(ex, ip) {
+      if (failed)
+        return;
+      if (ex) {
+        failed = true;
+        if (callback) callback(ex);
+        self.emit('error', ex);
+        return;
+      }
+      ips[address] = ip;
+      if (--waiting === 0)
+        send();
+    });
+  }
+
+  function send() {
+    if (!self._handle)
+      return;
+
+    for (var i = 2; i < list.length; i += 3)
+      list[i] = ips[list[i]];
+
+    var req = { list: list };  // Keep the buffers alive.
+    if (callback) {
+      req.callback = callback;
+      req.error = null;
+      req.oncomplete = afterSendBatch;
+    }
+
+    var err = self._handle.sendBatch(req, list, !!callback);
+    if (callback) {
+      // Requests that were started before the error still complete.
+      if (err)
+        req.error = errnoException(err, 'send');
+      if (req.pending === 0) {
+        process.nextTick(function() {
+          callback(req.error);
+        });
+      }
+    }
+  }
+}
+
+
+function afterSendBatch(err) {
+  if (err && !this.error)
+    this.error = errnoException(err, 'send');
+  if (--this.pending === 0)
+    this.callback(this.error);
+}
+
+
 Socket.prototype.close = function() {
   this._healthCheck();
   this._stopReceiving();
@@ -471,6 +609,24 @@ function onMessage(nread, handle, buf, rinfo) {
 }
 
 
+// Datagrams from a single recvmmsg() call, back to back in `buf`. `info`
+// holds the length and the rinfo object of each.
+function onMessages(count, handle, buf, info) {
+  var self = handle.owner;
+  var offset = 0;
+  for (var i = 0; i < count; i++) {
+    // A 'message' listener may have closed the socket.
+    if (self._handle !== handle)
+      return;
+    var length = info[i * 2];
+    var rinfo = info[i * 2 + 1];
+    rinfo.size = length; // compatibility
+    self.emit('message', buf.slice(offset, offset + length), rinfo);
+    offset += length;
+  }
+}
+
+
 Socket.prototype.ref = function() {
   if (this._handle)
     this._handle.ref();
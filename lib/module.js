@@ -25,8 +25,15 @@ var NativeModule = require('native_module');
 var util = NativeModule.require('util');
 var runInThisContext = require('vm').runInThisContext;
 var runInNewContext = require('vm').runInNewContext;
+var Script = require('vm').Script;
 var assert = require('assert').ok;
 var fs = NativeModule.require('fs');
+var internalModuleFindFile = process.binding('fs').internalModuleFindFile;
+var internalModuleReadJSON = process.binding('fs').internalModuleReadJSON;
+var internalModuleStat = process.binding('fs').internalModuleStat;
+var internalModuleMtimes = process.binding('fs').internalModuleMtimes;
+var internalModuleCheckMtimes =
+    process.binding('fs').internalModuleCheckMtimes;
 
 
 // If obj.hasOwnProperty has been overridden, then calling
@@ -54,6 +61,13 @@ module.exports = Module;
 // Set the environ variable NODE_MODULE_CONTEXTS=1 to make node load all
 // modules in their own context.
 Module._contextLoad = (+process.env['NODE_MODULE_CONTEXTS'] > 0);
+// Set the environ variable NODE_COMPILE_CACHE to a directory to keep V8's
+// code cache for every module there, which saves most of the parsing and
+// compiling on the next start.
+Module._compileCache = process.env['NODE_COMPILE_CACHE'] || null;
+// Set the environ variable NODE_RESOLVE_CACHE to a file to keep the results of
+// module resolution there across runs.
+Module._resolveCache = process.env['NODE_RESOLVE_CACHE'] || null;
 Module._cache = {};
 Module._pathCache = {};
 Module._extensions = {};
@@ -83,11 +97,22 @@ var debug = Module._debug;
 //   -> a.<ext>
 //   -> a/index.<ext>
 
-function statPath(path) {
-  try {
-    return fs.statSync(path);
-  } catch (ex) {}
-  return false;
+// Stats all the candidates with a single call into the binding and returns
+// the real path of the first one that is a file, or false.
+function tryFiles(candidates) {
+  var i = internalModuleFindFile(candidates);
+  if (i < 0) {
+    return false;
+  }
+  return fs.realpathSync(candidates[i], Module._realpathCache);
+}
+
+// p, p.<ext>...
+function withExtensions(candidates, p, exts) {
+  for (var i = 0, EL = exts.length; i < EL; i++) {
+    candidates.push(p + exts[i]);
+  }
+  return candidates;
 }
 
 // check if the directory is a package.json dir
@@ -98,13 +123,18 @@ function readPackage(requestPath) {
     return packageMainCache[requestPath];
   }
 
-  try {
-    var jsonPath = path.resolve(requestPath, 'package.json');
-    var json = fs.readFileSync(jsonPath, 'utf8');
-  } catch (e) {
+  var jsonPath = path.resolve(requestPath, 'package.json');
+  var json = internalModuleReadJSON(jsonPath);
+
+  if (util.isUndefined(json)) {
     return false;
   }
 
+  // No "main" in there, don't bother parsing it
+  if (json === '') {
+    return packageMainCache[requestPath] = undefined;
+  }
+
   try {
     var pkg = packageMainCache[requestPath] = JSON.parse(json).main;
   } catch (e) {
@@ -121,8 +151,10 @@ function tryPackage(requestPath, exts) {
   if (!pkg) return false;
 
   var filename = path.resolve(requestPath, pkg);
-  return tryFile(filename) || tryExtensions(filename, exts) ||
-         tryExtensions(path.resolve(filename, 'index'), exts);
+  var candidates = withExtensions([filename], filename, exts);
+  return tryFiles(withExtensions(candidates,
+                                 path.resolve(filename, 'index'),
+                                 exts));
 }
 
 // In order to minimize unnecessary lstat() calls,
@@ -130,25 +162,47 @@ function tryPackage(requestPath, exts) {
 // Set to an empty object to reset.
 Module._realpathCache = {};
 
-// check if the file exists and is not a directory
-function tryFile(requestPath) {
-  var stats = statPath(requestPath);
-  if (stats && !stats.isDirectory()) {
-    return fs.realpathSync(requestPath, Module._realpathCache);
+// Results of Module._findPath() saved by a previous run, see
+// Module._resolveCache.  Loaded on first use and written back on exit.
+//
+// Every entry records the file the request resolved to and the paths the
+// search depended on, with their modification times: the directories that
+// were looked in, and the package directories and package.json files that
+// were consulted.  Creating or removing a file in one of those directories,
+// or editing a package.json, changes a time and sends the request through
+// the regular search again.
+var kResolveCacheVersion = 2;
+var resolveCache = null;
+var resolveCacheFile;
+var resolveCacheDirty = false;
+
+function loadResolveCache() {
+  resolveCacheFile = path.resolve(Module._resolveCache);
+  try {
+    var data = JSON.parse(fs.readFileSync(resolveCacheFile, 'utf8'));
+    if (data.version === kResolveCacheVersion && util.isObject(data.entries))
+      resolveCache = data.entries;
+  } catch (e) {}
+  if (!util.isObject(resolveCache)) {
+    resolveCache = {};
   }
-  return false;
+  process.on('exit', saveResolveCache);
 }
 
-// given a path check a the file exists with any of the set extensions
-function tryExtensions(p, exts) {
-  for (var i = 0, EL = exts.length; i < EL; i++) {
-    var filename = tryFile(p + exts[i]);
-
-    if (filename) {
-      return filename;
-    }
+function saveResolveCache() {
+  if (!resolveCacheDirty) {
+    return;
+  }
+  var tmpFile = resolveCacheFile + '.' + process.pid;
+  var data = { version: kResolveCacheVersion, entries: resolveCache };
+  try {
+    fs.writeFileSync(tmpFile, JSON.stringify(data));
+    fs.renameSync(tmpFile, resolveCacheFile);
+  } catch (e) {
+    try {
+      fs.unlinkSync(tmpFile);
+    } catch (e) {}
   }
-  return false;
 }
 
 
@@ -166,19 +220,39 @@ Module._findPath = function(request, paths) {
     return Module._pathCache[cacheKey];
   }
 
+  var deps = null;
+  if (Module._resolveCache) {
+    if (!resolveCache) {
+      loadResolveCache();
+    }
+    if (hasOwnProperty(resolveCache, cacheKey)) {
+      var cached = resolveCache[cacheKey];
+      if (util.isObject(cached) &&
+          util.isString(cached.filename) &&
+          util.isArray(cached.paths) &&
+          util.isArray(cached.mtimes) &&
+          internalModuleCheckMtimes(cached.paths, cached.mtimes)) {
+        return Module._pathCache[cacheKey] = cached.filename;
+      }
+      delete resolveCache[cacheKey];
+      resolveCacheDirty = true;
+    }
+    deps = [];
+  }
+
   // For each path
   for (var i = 0, PL = paths.length; i < PL; i++) {
     var basePath = path.resolve(paths[i], request);
     var filename;
 
-    if (!trailingSlash) {
-      // try to join the request to the path
-      filename = tryFile(basePath);
+    if (deps) {
+      addResolveDeps(deps, basePath);
+    }
 
-      if (!filename && !trailingSlash) {
-        // try it with each of the extensions
-        filename = tryExtensions(basePath, exts);
-      }
+    if (!trailingSlash) {
+      // try to join the request to the path, as is and with each of the
+      // extensions
+      filename = tryFiles(withExtensions([basePath], basePath, exts));
     }
 
     if (!filename) {
@@ -187,17 +261,49 @@ Module._findPath = function(request, paths) {
 
     if (!filename) {
       // try it with each of the extensions at "index"
-      filename = tryExtensions(path.resolve(basePath, 'index'), exts);
+      filename = tryFiles(withExtensions([],
+                                         path.resolve(basePath, 'index'),
+                                         exts));
     }
 
     if (filename) {
       Module._pathCache[cacheKey] = filename;
+      if (deps) {
+        resolveCache[cacheKey] = {
+          filename: filename,
+          paths: deps,
+          mtimes: internalModuleMtimes(deps)
+        };
+        resolveCacheDirty = true;
+      }
       return filename;
     }
   }
   return false;
 };
 
+// Adds the paths whose contents decide what basePath resolves to: the
+// directory holding basePath and basePath.<ext>, and if basePath is a
+// directory, its listing (index.<ext>), its package.json and the directory
+// that "main" points into.
+function addResolveDeps(deps, basePath) {
+  deps.push(path.dirname(basePath));
+  if (internalModuleStat(basePath) !== 1) {
+    return;
+  }
+  deps.push(basePath, path.resolve(basePath, 'package.json'));
+  var main;
+  try {
+    main = readPackage(basePath);
+  } catch (e) {
+    // Reported by the search itself.
+  }
+  if (main) {
+    main = path.resolve(basePath, main);
+    deps.push(path.dirname(main), main);
+  }
+}
+
 // 'from' is the __dirname of the module.
 Module._nodeModulePaths = function(from) {
   // guarantee that 'from' is absolute.
@@ -442,7 +548,11 @@ Module.prototype._compile = function(content, filename) {
   // create wrapper function
   var wrapper = Module.wrap(content);
 
-  var compiledWrapper = runInThisContext(wrapper, { filename: filename });
+  var compiledWrapper;
+  if (Module._compileCache)
+    compiledWrapper = compileCached(wrapper, filename);
+  else
+    compiledWrapper = runInThisContext(wrapper, { filename: filename });
   if (global.v8debug) {
     if (!resolvedArgv) {
       // we enter the repl if we're not given a filename argument.
@@ -463,6 +573,63 @@ Module.prototype._compile = function(content, filename) {
 };
 
 
+var compileCacheDir;
+var compileCacheTag;
+
+// Cache files are named after the module's path and the command line flags.
+// The data in them is tied to the V8 version, the V8 flags and the exact
+// source by the binding.  Data it rejects is recompiled and, unless a
+// debugger is attached, replaced, so a stale or foreign file only costs one
+// recompile.
+function compileCached(wrapper, filename) {
+  if (util.isUndefined(compileCacheDir)) {
+    compileCacheDir = path.resolve(Module._compileCache);
+    compileCacheTag = process.execArgv.join(' ') + '\0';
+    try {
+      fs.mkdirSync(compileCacheDir);
+    } catch (e) {}
+  }
+
+  var cacheFile = path.join(compileCacheDir,
+                            path.basename(filename) + '.' +
+                            hashString(compileCacheTag + filename) + '.cache');
+  var cachedData;
+  try {
+    cachedData = fs.readFileSync(cacheFile);
+  } catch (e) {}
+
+  var script = new Script(wrapper, {
+    filename: filename,
+    cachedData: cachedData,
+    produceCachedData: true
+  });
+
+  // Only set when the script had to be compiled from source
+  if (script.cachedData) {
+    var tmpFile = cacheFile + '.' + process.pid;
+    try {
+      fs.writeFileSync(tmpFile, script.cachedData);
+      fs.renameSync(tmpFile, cacheFile);
+    } catch (e) {
+      try {
+        fs.unlinkSync(tmpFile);
+      } catch (e) {}
+    }
+  }
+
+  return script.runInThisContext();
+}
+
+
+// 32 bits FNV-1a, as a hex string
+function hashString(str) {
+  var hash = 0x811c9dc5;
+  for (var i = 0; i < str.length; i++)
+    hash = Math.imul(hash ^ str.charCodeAt(i), 0x01000193);
+  return (hash >>> 0).toString(16);
+}
+
+
 function stripBOM(content) {
   // Remove byte order marker. This catches EF BB BF (the UTF-8 BOM)
   // because the buffer-to-string conversion in `fs.readFileSync()`
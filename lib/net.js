@@ -127,9 +127,55 @@ function initSocketHandle(self) {
     // If handle doesn't support writev - neither do we
     if (!self._handle.writev)
       self._writev = null;
+
+    // setTimeout() may have been called before there was a handle.
+    if (self._idleTimeout > 0 && self._handle.setIdleTimeout) {
+      timers.enroll(self, self._idleTimeout);
+      startIdleTimeout(self);
+    }
+  }
+}
+
+
+// Idle timeouts are tracked by the handle when it knows how to; it records
+// the time of each read and write and calls ontimeout when the socket has
+// been idle for too long.  Other handles go through the timers module.
+function startIdleTimeout(self) {
+  var handle = self._handle;
+  if (handle && handle.setIdleTimeout) {
+    self._idleNative = true;
+    handle.ontimeout = onIdleTimeout;
+    handle.setIdleTimeout(self._idleTimeout);
+  } else {
+    self._idleNative = false;
+    timers._unrefActive(self);
   }
 }
 
+
+function stopIdleTimeout(self) {
+  if (self._idleNative && self._handle)
+    self._handle.setIdleTimeout(0);
+  self._idleNative = false;
+  timers.unenroll(self);
+}
+
+
+// Restart the idle timeout, for activity the handle doesn't see.
+function refreshIdleTimeout(self) {
+  if (self._idleNative)
+    self._handle.setIdleTimeout(self._idleTimeout);
+  else
+    timers._unrefActive(self);
+}
+
+
+function onIdleTimeout() {
+  var self = this.owner;
+  debug('onIdleTimeout');
+  self._onTimeout();
+}
+
 function Socket(options) {
   if (!(this instanceof Socket)) return new Socket(options);
 
@@ -137,6 +183,7 @@ function Socket(options) {
   this._hadError = false;
   this._handle = null;
   this._host = null;
+  this._idleNative = false;
 
   if (util.isNumber(options))
     options = { fd: options }; // Legacy interface.
@@ -317,12 +364,12 @@ Socket.prototype.listen = function() {
 Socket.prototype.setTimeout = function(msecs, callback) {
   if (msecs > 0 && isFinite(msecs)) {
     timers.enroll(this, msecs);
-    timers._unrefActive(this);
+    startIdleTimeout(this);
     if (callback) {
       this.once('timeout', callback);
     }
   } else if (msecs === 0) {
-    timers.unenroll(this);
+    stopIdleTimeout(this);
     if (callback) {
       this.removeListener('timeout', callback);
     }
@@ -459,7 +506,7 @@ Socket.prototype._destroy = function(exception, cb) {
 
   this.readable = this.writable = false;
 
-  timers.unenroll(this);
+  stopIdleTimeout(this);
 
   debug('close');
   if (this._handle) {
@@ -504,7 +551,8 @@ function onread(nread, buffer) {
   var self = handle.owner;
   assert(handle === self._handle, 'handle != self._handle');
 
-  timers._unrefActive(self);
+  if (!self._idleNative)
+    timers._unrefActive(self);
 
   debug('onread', nread);
 
@@ -635,7 +683,8 @@ Socket.prototype._writeGeneric = function(writev, data, encoding, cb) {
   this._pendingData = null;
   this._pendingEncoding = '';
 
-  timers._unrefActive(this);
+  if (!this._idleNative)
+    timers._unrefActive(this);
 
   if (!this._handle) {
     this._destroy(new Error('This socket is closed.'), cb);
@@ -761,7 +810,8 @@ function afterWrite(status, handle, req, err) {
     return;
   }
 
-  timers._unrefActive(self);
+  if (!self._idleNative)
+    timers._unrefActive(self);
 
   if (self !== process.stderr && self !== process.stdout)
     debug('afterWrite call cb');
@@ -880,7 +930,7 @@ Socket.prototype.connect = function(options, cb) {
     self.once('connect', cb);
   }
 
-  timers._unrefActive(this);
+  refreshIdleTimeout(this);
 
   self._connecting = true;
   self.writable = true;
@@ -925,7 +975,7 @@ Socket.prototype.connect = function(options, cb) {
           self._destroy();
         });
       } else {
-        timers._unrefActive(self);
+        refreshIdleTimeout(self);
 
         addressType = addressType || 4;
 
@@ -977,7 +1027,7 @@ function afterConnect(status, handle, req, readable, writable) {
   if (status == 0) {
     self.readable = readable;
     self.writable = writable;
-    timers._unrefActive(self);
+    refreshIdleTimeout(self);
 
     self.emit('connect');
 
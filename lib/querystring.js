@@ -24,6 +24,7 @@
 'use strict';
 
 var QueryString = exports;
+var binding = process.binding('querystring');
 var util = require('util');
 
 
@@ -107,7 +108,7 @@ QueryString.unescapeBuffer = function(s, decodeSpaces) {
 };
 
 
-QueryString.unescape = function(s, decodeSpaces) {
+var defaultUnescape = QueryString.unescape = function(s, decodeSpaces) {
   try {
     return decodeURIComponent(s);
   } catch (e) {
@@ -116,7 +117,7 @@ QueryString.unescape = function(s, decodeSpaces) {
 };
 
 
-QueryString.escape = function(str) {
+var defaultEscape = QueryString.escape = function(str) {
   return encodeURIComponent(str);
 };
 
@@ -141,6 +142,12 @@ QueryString.stringify = QueryString.encode = function(obj, sep, eq, options) {
   }
 
   if (util.isObject(obj)) {
+    if (encode === defaultEscape && util.isString(sep) && util.isString(eq)) {
+      var result = binding.stringify(obj, sep, eq);
+      if (!util.isUndefined(result))
+        return result;
+    }
+
     var keys = Object.keys(obj);
     var fields = [];
 
@@ -171,25 +178,38 @@ QueryString.parse = QueryString.decode = function(qs, sep, eq, options) {
     return obj;
   }
 
-  var regexp = /\+/g;
-  qs = qs.split(sep);
-
   var maxKeys = 1000;
   if (options && util.isNumber(options.maxKeys)) {
     maxKeys = options.maxKeys;
   }
 
+  var decode = QueryString.unescape;
+  if (options && typeof options.decodeURIComponent === 'function') {
+    decode = options.decodeURIComponent;
+  }
+
+  // The binding decodes in a single pass over the string when the default
+  // decoder is used with single character separators. It returns undefined
+  // for input it does not handle exactly like the loop below (malformed
+  // escapes, invalid UTF-8), in which case we fall through.
+  if (decode === defaultUnescape &&
+      util.isString(sep) && sep.length === 1 &&
+      util.isString(eq) && eq.length === 1) {
+    var result = binding.parse(qs, sep.charCodeAt(0), eq.charCodeAt(0),
+                               maxKeys);
+    if (!util.isUndefined(result))
+      return result;
+  }
+
+  var regexp = /\+/g;
+  qs = qs.split(sep);
+
   var len = qs.length;
   // maxKeys <= 0 means that we should not limit keys count
   if (maxKeys > 0 && len > maxKeys) {
     len = maxKeys;
   }
 
-  var decode = QueryString.unescape;
-  if (options && typeof options.decodeURIComponent === 'function') {
-    decode = options.decodeURIComponent;
-  }
-
   for (var i = 0; i < len; ++i) {
     var x = qs[i].replace(regexp, '%20'),
         idx = x.indexOf(eq),
@@ -23,6 +23,7 @@
 
 var Timer = process.binding('timer_wrap').Timer;
 var L = require('_linklist');
+var TimerWheel = require('_timer_wheel');
 var assert = require('assert').ok;
 
 var kOnTimeout = Timer.kOnTimeout | 0;
@@ -161,8 +162,165 @@ function listOnTimeout() {
 }
 
 
+// COARSE IDLE TIMEOUTS
+//
+// With many distinct timeout values the per-duration lists above turn into
+// one TimerWrap per list and a busy timer heap in libuv.  Once an idle
+// timeout resolution is set, enrolled items go into a timing wheel instead
+// and all of them share a single TimerWrap.  Their timeouts are rounded up
+// to the resolution, so they may fire up to that many milliseconds late but
+// never early.  setTimeout() and setInterval() are not affected.
+
+var idleResolution = 0;
+var refWheel = null;
+var unrefWheel = null;
+
+
+exports.setIdleTimeoutResolution = function(msecs) {
+  msecs *= 1; // coalesce to number or NaN
+
+  if (!(msecs >= 0 && msecs <= TIMEOUT_MAX))
+    throw new RangeError('resolution must be between 0 and ' + TIMEOUT_MAX);
+
+  msecs = Math.ceil(msecs);
+  if (msecs === idleResolution) return;
+
+  // Items on the current wheels stay there until they expire or become
+  // active again.  The wheels are closed once they run empty.
+  var ref = refWheel;
+  var unref = unrefWheel;
+  refWheel = unrefWheel = null;
+  if (ref && ref.size === 0) wheelStop(ref);
+  if (unref && unref.size === 0) wheelStop(unref);
+
+  idleResolution = msecs;
+};
+
+
+function createWheel(unref) {
+  var wheel = new TimerWheel();
+  wheel.resolution = idleResolution;
+
+  var timer = wheel.timer = new Timer();
+  timer._wheel = wheel;
+  timer.when = -1;
+  timer[kOnTimeout] = wheelOnTimeout;
+  if (unref) timer.unref();
+
+  return wheel;
+}
+
+
+function wheelStop(wheel) {
+  var timer = wheel.timer;
+  timer.when = -1;
+  if (wheel === refWheel || wheel === unrefWheel)
+    timer.stop();
+  else
+    timer.close();
+}
+
+
+function wheelInsert(wheel, item, msecs) {
+  var now = Timer.now();
+  var resolution = wheel.resolution;
+
+  var old = item._wheel;
+  if (old) {
+    old.remove(item);
+    if (old !== wheel && old.size === 0) wheelStop(old);
+  } else {
+    L.remove(item);
+  }
+
+  item._idleStart = now;
+
+  if (wheel.size === 0)
+    wheel.reset(Math.floor(now / resolution));
+
+  var expiry = Math.ceil((now + msecs) / resolution);
+  wheel.insert(item, expiry);
+
+  var when = expiry * resolution;
+  var timer = wheel.timer;
+  if (timer.when === -1 || when < timer.when) {
+    timer.start(when - now, 0);
+    timer.when = when;
+  }
+}
+
+
+function wheelRemove(item) {
+  var wheel = item._wheel;
+  wheel.remove(item);
+  if (wheel.size === 0) wheelStop(wheel);
+}
+
+
+function wheelOnTimeout() {
+  var timer = this;
+  var wheel = timer._wheel;
+  var resolution = wheel.resolution;
+
+  debug('wheel timeout callback %d', resolution);
+
+  timer.when = -1;
+
+  var threw = true;
+  try {
+    wheel.advance(Math.floor(Timer.now() / resolution), wheelFire);
+    threw = false;
+  } finally {
+    if (threw) {
+      // Same as in listOnTimeout(), the wheel keeps the items that are
+      // still due and hands them out on the next call.
+      var oldDomain = process.domain;
+      process.domain = null;
+      process.nextTick(function() {
+        timer[kOnTimeout]();
+      });
+      process.domain = oldDomain;
+    }
+  }
+
+  var next = wheel.nextExpiry();
+  if (next === -1) {
+    debug('wheel empty');
+    wheelStop(wheel);
+    return;
+  }
+
+  var now = Timer.now();
+  var when = next * resolution;
+  timer.start(when > now ? when - now : 0, 0);
+  timer.when = when;
+}
+
+
+function wheelFire(item) {
+  if (!item._onTimeout) return;
+
+  var domain = item.domain;
+  if (domain && domain._disposed) return;
+
+  var hasQueue = !!item._asyncQueue;
+  if (hasQueue)
+    loadAsyncQueue(item);
+  if (domain)
+    domain.enter();
+  item._onTimeout();
+  if (domain)
+    domain.exit();
+  if (hasQueue)
+    unloadAsyncQueue(item);
+}
+
+
 var unenroll = exports.unenroll = function(item) {
-  L.remove(item);
+  if (item._wheel)
+    wheelRemove(item);
+  else
+    L.remove(item);
 
   var list = lists[item._idleTimeout];
   // if empty then stop the watcher
@@ -197,7 +355,11 @@ exports.enroll = function(item, msecs) {
 // it will reset its timeout.
 exports.active = function(item) {
   var msecs = item._idleTimeout;
-  if (msecs >= 0) {
+  if (msecs >= 0 && idleResolution > 0 && !(item instanceof Timeout)) {
+    if (!refWheel) refWheel = createWheel(false);
+    wheelInsert(refWheel, item, msecs);
+  } else if (msecs >= 0) {
+    if (item._wheel) wheelRemove(item);
     var list = lists[msecs];
     if (!list || L.isEmpty(list)) {
       insert(item, msecs);
@@ -521,7 +683,16 @@ exports._unrefActive = function(item) {
   if (!msecs || msecs < 0) return;
   assert(msecs >= 0);
 
-  L.remove(item);
+  if (idleResolution > 0) {
+    if (!unrefWheel) unrefWheel = createWheel(true);
+    wheelInsert(unrefWheel, item, msecs);
+    return;
+  }
+
+  if (item._wheel)
+    wheelRemove(item);
+  else
+    L.remove(item);
 
   if (!unrefList) {
     debug('unrefList initialized');
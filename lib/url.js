@@ -21,6 +21,7 @@
 
 'use strict';
 
+var binding = process.binding('http_parser');
 var punycode = require('punycode');
 var util = require('util');
 
@@ -97,7 +98,9 @@ var protocolPattern = /^([a-z0-9.+-]+:)/i,
       'gopher:': true,
       'file:': true
     },
-    querystring = require('querystring');
+    querystring = require('querystring'),
+    parseUrl = binding.parseUrl,
+    urlOffsets = binding.urlOffsets;
 
 function urlParse(url, parseQueryString, slashesDenoteHost) {
   if (url && util.isObject(url) && url instanceof Url) return url;
@@ -112,6 +115,12 @@ Url.prototype.parse = function(url, parseQueryString, slashesDenoteHost) {
     throw new TypeError("Parameter 'url' must be a string, not " + typeof url);
   }
 
+  // Fast path for URLs that don't need any of the fixing up below.
+  if (parseUrl(url)) {
+    parsePlainUrl(this, url, parseQueryString);
+    return this;
+  }
+
   // Copy chrome, IE, opera backslash-handling behavior.
   // Back slashes before the query string get converted to forward slashes
   // See: https://code.google.com/p/chromium/issues/detail?id=25916
@@ -366,6 +375,51 @@ Url.prototype.parse = function(url, parseQueryString, slashesDenoteHost) {
   return this;
 };
 
+// Fills in |self| from the offsets that parseUrl() found. The result is
+// the same as what the JS parser makes of the URL.
+function parsePlainUrl(self, url, parseQueryString) {
+  var hostStart = urlOffsets[binding.kUrlHostStart];
+  var portEnd = urlOffsets[binding.kUrlPortEnd];
+  var pathEnd = urlOffsets[binding.kUrlPathEnd];
+  var queryEnd = urlOffsets[binding.kUrlQueryEnd];
+  var pathStart = 0;
+
+  if (hostStart !== -1) {
+    var hostEnd = urlOffsets[binding.kUrlHostEnd];
+    self.protocol = url.slice(0, hostStart - 2).toLowerCase();
+    self.slashes = true;
+    self.host = url.slice(hostStart, portEnd).toLowerCase();
+    if (portEnd !== hostEnd)
+      self.port = url.slice(hostEnd + 1, portEnd);
+    self.hostname = url.slice(hostStart, hostEnd).toLowerCase();
+    pathStart = portEnd;
+  }
+
+  if (queryEnd !== url.length)
+    self.hash = url.slice(queryEnd);
+
+  if (queryEnd !== pathEnd) {
+    self.search = url.slice(pathEnd, queryEnd);
+    self.query = url.slice(pathEnd + 1, queryEnd);
+    if (parseQueryString)
+      self.query = querystring.parse(self.query);
+  } else if (parseQueryString) {
+    self.search = '';
+    self.query = {};
+  }
+
+  // http://host?query has a path of /, like the JS parser makes of it.
+  self.pathname = pathEnd !== pathStart ? url.slice(pathStart, pathEnd) : '/';
+  self.path = self.pathname + (self.search || '');
+
+  if (hostStart !== -1) {
+    self.href = self.protocol + '//' + self.host + self.path +
+                (self.hash || '');
+  } else {
+    self.href = url;
+  }
+}
+
 // format a parsed object into a url string
 function urlFormat(obj) {
   // ensure it's an object, and not a string url.
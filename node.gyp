@@ -19,6 +19,7 @@
       'lib/_debug_agent.js',
       'lib/_debugger.js',
       'lib/_linklist.js',
+      'lib/_timer_wheel.js',
       'lib/assert.js',
       'lib/buffer.js',
       'lib/child_process.js',
@@ -101,6 +102,7 @@
         'src/node_javascript.cc',
         'src/node_main.cc',
         'src/node_os.cc',
+        'src/node_querystring.cc',
         'src/node_v8.cc',
         'src/node_v8_platform.cc',
         'src/node_stat_watcher.cc',
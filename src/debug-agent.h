@@ -57,6 +57,8 @@ class Agent {
     dispatch_handler_ = handler;
   }
 
+  inline bool IsRunning() const { return state_ == kRunning; }
+
   inline node::Environment* parent_env() const { return parent_env_; }
   inline node::Environment* child_env() const { return child_env_; }
 
@@ -240,6 +240,8 @@ inline Environment::Environment(v8::Local<v8::Context> context,
   QUEUE_INIT(&req_wrap_queue_);
   QUEUE_INIT(&handle_wrap_queue_);
   QUEUE_INIT(&handle_cleanup_queue_);
+  QUEUE_INIT(&stream_idle_queue_);
+  stream_idle_sweep_time_ = 0;
   handle_cleanup_waiting_ = 0;
 }
 
@@ -323,6 +325,27 @@ inline uv_check_t* Environment::idle_check_handle() {
   return &idle_check_handle_;
 }
 
+inline Environment* Environment::from_stream_idle_timer_handle(
+    uv_timer_t* handle) {
+  return ContainerOf(&Environment::stream_idle_timer_handle_, handle);
+}
+
+inline uv_timer_t* Environment::stream_idle_timer_handle() {
+  return &stream_idle_timer_handle_;
+}
+
+inline QUEUE* Environment::stream_idle_queue() {
+  return &stream_idle_queue_;
+}
+
+inline uint64_t Environment::stream_idle_sweep_time() const {
+  return stream_idle_sweep_time_;
+}
+
+inline void Environment::set_stream_idle_sweep_time(uint64_t value) {
+  stream_idle_sweep_time_ = value;
+}
+
 inline void Environment::RegisterHandleCleanup(uv_handle_t* handle,
                                                HandleCleanupCb cb,
                                                void *arg) {
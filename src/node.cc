@@ -146,6 +146,7 @@ bool no_deprecation = false;
 // process-relative uptime base, initialized at start-up
 static double prog_start_time;
 static bool debugger_running;
+static uint32_t v8_flags_hash = 2166136261u;
 static uv_async_t dispatch_debug_messages_async;
 
 static Isolate* node_isolate = nullptr;
@@ -2969,6 +2970,10 @@ static void PrintHelp() {
          "                       prefixed to the module search path.\n"
          "NODE_MODULE_CONTEXTS   Set to 1 to load modules in their own\n"
          "                       global contexts.\n"
+         "NODE_COMPILE_CACHE     Directory in which to keep the V8 code\n"
+         "                       cache of loaded modules.\n"
+         "NODE_RESOLVE_CACHE     File in which to keep the results of\n"
+         "                       module resolution across runs.\n"
          "NODE_DISABLE_COLORS    Set to 1 to disable colors in the REPL\n"
 #if defined(NODE_HAVE_I18N_SUPPORT)
          "NODE_ICU_DATA          Data path for ICU (Intl object) data\n"
@@ -3101,6 +3106,24 @@ static void ParseArgs(int* argc,
 }
 
 
+void UpdateV8FlagsHash(const char* flags, size_t length) {
+  // FNV-1a, with a separator so that "--a" "--b" and "--a--b" differ
+  uint32_t hash = v8_flags_hash;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= static_cast<unsigned char>(flags[i]);
+    hash *= 16777619u;
+  }
+  hash ^= ' ';
+  hash *= 16777619u;
+  v8_flags_hash = hash;
+}
+
+
+uint32_t V8FlagsHash() {
+  return v8_flags_hash;
+}
+
+
 // Called from V8 Debug Agent TCP thread.
 static void DispatchMessagesDebugAgentCallback(Environment* env) {
   // TODO(indutny): move async handle to environment
@@ -3408,6 +3431,7 @@ void Init(int* argc,
   // so the user can disable a flag --foo at run-time by passing
   // --no_foo from the command line.
   V8::SetFlagsFromString(NODE_V8_OPTIONS, sizeof(NODE_V8_OPTIONS) - 1);
+  UpdateV8FlagsHash(NODE_V8_OPTIONS, sizeof(NODE_V8_OPTIONS) - 1);
 #endif
 
   // Parse a few arguments which are specific to Node.
@@ -3438,6 +3462,9 @@ void Init(int* argc,
                      "(check NODE_ICU_DATA or --icu-data-dir parameters)");
   }
 #endif
+  for (int i = 1; i < v8_argc; i++)
+    UpdateV8FlagsHash(v8_argv[i], strlen(v8_argv[i]));
+
   // The const_cast doesn't violate conceptual const-ness.  V8 doesn't modify
   // the argv array or the elements it points to.
   V8::SetFlagsFromCommandLine(&v8_argc, const_cast<char**>(v8_argv), true);
@@ -3456,6 +3483,7 @@ void Init(int* argc,
   if (debug_wait_connect) {
     const char expose_debug_as[] = "--expose_debug_as=v8debug";
     V8::SetFlagsFromString(expose_debug_as, sizeof(expose_debug_as) - 1);
+    UpdateV8FlagsHash(expose_debug_as, sizeof(expose_debug_as) - 1);
   }
 
   V8::SetArrayBufferAllocator(&ArrayBufferAllocator::the_singleton);
@@ -3634,6 +3662,12 @@ Environment* CreateEnvironment(Isolate* isolate,
   uv_unref(reinterpret_cast<uv_handle_t*>(env->idle_prepare_handle()));
   uv_unref(reinterpret_cast<uv_handle_t*>(env->idle_check_handle()));
 
+  // Sweeps the stream handles that have an idle timeout, see stream_wrap.cc.
+  // Like the timers that net.Socket used before, it doesn't keep the loop
+  // alive.
+  uv_timer_init(env->event_loop(), env->stream_idle_timer_handle());
+  uv_unref(reinterpret_cast<uv_handle_t*>(env->stream_idle_timer_handle()));
+
   // Register handle cleanups
   env->RegisterHandleCleanup(
       reinterpret_cast<uv_handle_t*>(env->immediate_check_handle()),
@@ -3651,6 +3685,10 @@ Environment* CreateEnvironment(Isolate* isolate,
       reinterpret_cast<uv_handle_t*>(env->idle_check_handle()),
       HandleCleanup,
       nullptr);
+  env->RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(env->stream_idle_timer_handle()),
+      HandleCleanup,
+      nullptr);
 
   if (v8_is_profiling) {
     StartProfilerIdleNotifier(env);
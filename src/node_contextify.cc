@@ -20,6 +20,7 @@
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "node.h"
+#include "node_buffer.h"
 #include "node_internals.h"
 #include "node_watchdog.h"
 #include "base-object.h"
@@ -30,6 +31,9 @@
 #include "util-inl.h"
 #include "v8-debug.h"
 
+#include <limits.h>
+#include <string.h>
+
 namespace node {
 
 using v8::AccessType;
@@ -484,10 +488,35 @@ class ContextifyScript : public BaseObject {
       return;
     }
 
+    Local<Object> cached_data_buf = GetCachedDataArg(args, 1);
+    bool produce_cached_data = GetProduceCachedDataArg(args, 1);
+    if (try_catch.HasCaught()) {
+      try_catch.ReThrow();
+      return;
+    }
+
+    // V8 quietly ignores code caches while the debugger is loaded and
+    // compiles the script from source, with debug break slots.  Say so
+    // rather than claim the data was used, and don't produce any.
+    bool debugging = env->debugger_agent()->IsRunning();
+
+    ScriptCompiler::CachedData* cached_data = nullptr;
+    if (!cached_data_buf.IsEmpty() && !debugging)
+      cached_data = ParseCachedData(code, cached_data_buf);
+
+    ScriptCompiler::CompileOptions compile_options =
+        ScriptCompiler::kNoCompileOptions;
+    if (cached_data != nullptr)
+      compile_options = ScriptCompiler::kConsumeCodeCache;
+    else if (produce_cached_data && !debugging)
+      compile_options = ScriptCompiler::kProduceCodeCache;
+
     ScriptOrigin origin(filename);
-    ScriptCompiler::Source source(code, origin);
+    ScriptCompiler::Source source(code, origin, cached_data);
     Local<UnboundScript> v8_script =
-        ScriptCompiler::CompileUnbound(env->isolate(), &source);
+        ScriptCompiler::CompileUnbound(env->isolate(),
+                                       &source,
+                                       compile_options);
 
     if (v8_script.IsEmpty()) {
       if (display_errors) {
@@ -497,6 +526,18 @@ class ContextifyScript : public BaseObject {
       return;
     }
     contextify_script->script_.Reset(env->isolate(), v8_script);
+
+    if (!cached_data_buf.IsEmpty()) {
+      args.This()->Set(
+          FIXED_ONE_BYTE_STRING(env->isolate(), "cachedDataRejected"),
+          Boolean::New(env->isolate(), cached_data == nullptr));
+    }
+
+    if (compile_options == ScriptCompiler::kProduceCodeCache &&
+        source.GetCachedData() != nullptr) {
+      args.This()->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "cachedData"),
+                       SerializeCachedData(env, code, source.GetCachedData()));
+    }
   }
 
 
@@ -623,6 +664,141 @@ class ContextifyScript : public BaseObject {
   }
 
 
+  static Local<Object> GetCachedDataArg(const FunctionCallbackInfo<Value>& args,
+                                        const int i) {
+    if (!args[i]->IsObject()) {
+      return Local<Object>();
+    }
+
+    Local<String> key = FIXED_ONE_BYTE_STRING(args.GetIsolate(), "cachedData");
+    Local<Value> value = args[i].As<Object>()->Get(key);
+    if (value->IsUndefined()) {
+      return Local<Object>();
+    }
+
+    if (!Buffer::HasInstance(value)) {
+      Environment::ThrowTypeError(args.GetIsolate(),
+                                  "options.cachedData must be a Buffer");
+      return Local<Object>();
+    }
+    return value.As<Object>();
+  }
+
+
+  static bool GetProduceCachedDataArg(const FunctionCallbackInfo<Value>& args,
+                                      const int i) {
+    if (!args[i]->IsObject()) {
+      return false;
+    }
+
+    Local<String> key = FIXED_ONE_BYTE_STRING(args.GetIsolate(),
+                                              "produceCachedData");
+    Local<Value> value = args[i].As<Object>()->Get(key);
+
+    return value->BooleanValue();
+  }
+
+
+  // The buffers exchanged through `cachedData` start with this header, which
+  // ties V8's serialized code to the V8 version, the V8 flags and the exact
+  // source it was produced from.  V8 aborts on data from another version and
+  // checks neither the flags nor, in release builds, the source, so anything
+  // that doesn't match is rejected here and the script is compiled from
+  // source instead.
+  enum CachedDataField {
+    kCachedDataMagic,
+    kCachedDataVersionHash,
+    kCachedDataFlagsHash,
+    kCachedDataSourceLength,
+    kCachedDataSourceHashLow,
+    kCachedDataSourceHashHigh,
+    kCachedDataLength,
+    kCachedDataHash,
+    kCachedDataHeaderFields
+  };
+
+  static const uint32_t kCachedDataMagicValue = 0x6e636302;  // "ncc" v2
+
+
+  // 64 bits FNV-1a
+  static uint64_t HashBytes(const void* data, size_t length) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+      hash ^= p[i];
+      hash *= 0x100000001b3ULL;
+    }
+    return hash;
+  }
+
+
+  static void CachedDataHeader(Local<String> code,
+                               const uint8_t* data,
+                               size_t length,
+                               uint32_t* header) {
+    const char* version = V8::GetVersion();
+    String::Value source(code);
+    uint64_t source_hash =
+        HashBytes(*source, source.length() * sizeof(**source));
+
+    header[kCachedDataMagic] = kCachedDataMagicValue;
+    header[kCachedDataVersionHash] =
+        static_cast<uint32_t>(HashBytes(version, strlen(version)));
+    header[kCachedDataFlagsHash] = V8FlagsHash();
+    header[kCachedDataSourceLength] = source.length();
+    header[kCachedDataSourceHashLow] = static_cast<uint32_t>(source_hash);
+    header[kCachedDataSourceHashHigh] =
+        static_cast<uint32_t>(source_hash >> 32);
+    header[kCachedDataLength] = length;
+    header[kCachedDataHash] = static_cast<uint32_t>(HashBytes(data, length));
+  }
+
+
+  // Returns nullptr if |buf| wasn't produced for |code| by this V8 version.
+  static ScriptCompiler::CachedData* ParseCachedData(Local<String> code,
+                                                     Local<Object> buf) {
+    const size_t header_size = kCachedDataHeaderFields * sizeof(uint32_t);
+    const uint8_t* data = reinterpret_cast<uint8_t*>(Buffer::Data(buf));
+    size_t length = Buffer::Length(buf);
+
+    if (length <= header_size || length - header_size > INT_MAX)
+      return nullptr;
+
+    uint32_t expected[kCachedDataHeaderFields];
+    uint32_t actual[kCachedDataHeaderFields];
+    memcpy(actual, data, header_size);
+    data += header_size;
+    length -= header_size;
+
+    if (actual[kCachedDataMagic] != kCachedDataMagicValue ||
+        actual[kCachedDataLength] != length) {
+      return nullptr;
+    }
+
+    CachedDataHeader(code, data, length, expected);
+    if (memcmp(actual, expected, header_size) != 0)
+      return nullptr;
+
+    return new ScriptCompiler::CachedData(data, static_cast<int>(length));
+  }
+
+
+  static Local<Object> SerializeCachedData(
+      Environment* env,
+      Local<String> code,
+      const ScriptCompiler::CachedData* cached_data) {
+    const size_t header_size = kCachedDataHeaderFields * sizeof(uint32_t);
+    uint32_t header[kCachedDataHeaderFields];
+    CachedDataHeader(code, cached_data->data, cached_data->length, header);
+
+    Local<Object> buf = Buffer::New(env, header_size + cached_data->length);
+    char* out = Buffer::Data(buf);
+    memcpy(out, header, header_size);
+    memcpy(out + header_size, cached_data->data, cached_data->length);
+    return buf;
+  }
+
+
   static Local<String> GetFilenameArg(const FunctionCallbackInfo<Value>& args,
                                       const int i) {
     Local<String> defaultFilename =
@@ -36,6 +36,7 @@
 #include "v8.h"
 
 #include <errno.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -211,6 +212,32 @@ void ThrowCryptoError(Environment* env,
 }
 
 
+// Resolves the [offset, offset + length) slice of buffer `buf`.  `offset`
+// defaults to zero and `length` to the rest of the buffer.  Returns false
+// if the slice is out of bounds.
+static bool ParseBufferSlice(Handle<Value> buf,
+                             Handle<Value> offset_arg,
+                             Handle<Value> length_arg,
+                             char** data,
+                             size_t* length) {
+  const size_t buf_length = Buffer::Length(buf);
+  size_t offset;
+  size_t len;
+
+  if (!ParseArrayIndex(offset_arg, 0, &offset) || offset > buf_length)
+    return false;
+
+  if (!ParseArrayIndex(length_arg, buf_length - offset, &len) ||
+      len > buf_length - offset) {
+    return false;
+  }
+
+  *data = Buffer::Data(buf) + offset;
+  *length = len;
+  return true;
+}
+
+
 // Ensure that OpenSSL has enough entropy (at least 256 bits) for its PRNG.
 // The entropy pool starts out empty and needs to fill up before the PRNG
 // can be used securely.  Once the pool is filled, it never dries up again;
@@ -278,6 +305,10 @@ void SecureContext::Initialize(Environment* env, Handle<Object> target) {
   env->SetProtoMethod(t, "loadPKCS12", SecureContext::LoadPKCS12);
   env->SetProtoMethod(t, "getTicketKeys", SecureContext::GetTicketKeys);
   env->SetProtoMethod(t, "setTicketKeys", SecureContext::SetTicketKeys);
+  env->SetProtoMethod(t, "setOCSPResponse", SecureContext::SetOCSPResponse);
+  env->SetProtoMethod(t, "clearOCSPResponse",
+                      SecureContext::ClearOCSPResponse);
+  env->SetProtoMethod(t, "deferOCSPRefresh", SecureContext::DeferOCSPRefresh);
   env->SetProtoMethod(t, "getCertificate", SecureContext::GetCertificate<true>);
   env->SetProtoMethod(t, "getIssuer", SecureContext::GetCertificate<false>);
 
@@ -370,6 +401,10 @@ void SecureContext::Init(const FunctionCallbackInfo<Value>& args) {
   SSL_CTX_sess_set_get_cb(sc->ctx_, SSLWrap<Connection>::GetSessionCallback);
   SSL_CTX_sess_set_new_cb(sc->ctx_, SSLWrap<Connection>::NewSessionCallback);
 
+  // Used to find the cached OCSP response for the context that is in use
+  // after an SNI switch, see TLSExtStatusCallback().
+  SSL_CTX_set_app_data(sc->ctx_, sc);
+
   sc->ca_store_ = nullptr;
 }
 
@@ -944,6 +979,178 @@ void SecureContext::CtxGetter(Local<String> property,
 }
 
 
+// Converts an ASN.1 GeneralizedTime (YYYYMMDDHHMMSS[.fff]Z) to seconds since
+// the epoch.  Returns false if the time can't be parsed.
+static bool GeneralizedTimeToEpoch(const ASN1_GENERALIZEDTIME* t, time_t* ret) {
+  if (t == nullptr || t->length < 15)
+    return false;
+
+  int fields[6];
+  static const int widths[6] = { 4, 2, 2, 2, 2, 2 };
+  const unsigned char* p = t->data;
+  for (int i = 0; i < 6; i++) {
+    fields[i] = 0;
+    for (int k = 0; k < widths[i]; k++, p++) {
+      if (*p < '0' || *p > '9')
+        return false;
+      fields[i] = fields[i] * 10 + (*p - '0');
+    }
+  }
+
+  // Days since 1970-01-01 in the proleptic Gregorian calendar.
+  int year = fields[0];
+  const int month = fields[1];
+  const int day = fields[2];
+  if (month < 1 || month > 12 || day < 1 || day > 31)
+    return false;
+  year -= month <= 2;
+  const int era = year / 400;
+  const int yoe = year - era * 400;
+  const int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  const double days = era * 146097.0 + doe - 719468;
+
+  *ret = static_cast<time_t>(days * 86400 +
+                             fields[3] * 3600 +
+                             fields[4] * 60 +
+                             fields[5]);
+  return true;
+}
+
+
+// setOCSPResponse(response)
+//
+// Caches a DER-encoded OCSP response for the context's certificate.  The
+// response is stapled from TLSExtStatusCallback() without a trip to JS
+// until it expires.  Returns the time, in milliseconds since the epoch, at
+// which the response should be refreshed.
+void SecureContext::SetOCSPResponse(const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
+  Environment* env = sc->env();
+
+  if (args.Length() < 1 || !Buffer::HasInstance(args[0]))
+    return env->ThrowTypeError("Must give a Buffer as first argument");
+
+  if (sc->cert_ == nullptr || sc->issuer_ == nullptr)
+    return env->ThrowError("Certificate or issuer not set");
+
+  const unsigned char* data =
+      reinterpret_cast<const unsigned char*>(Buffer::Data(args[0]));
+  const size_t len = Buffer::Length(args[0]);
+
+  const char* error = nullptr;
+  const unsigned char* p = data;
+  OCSP_RESPONSE* resp = d2i_OCSP_RESPONSE(nullptr, &p, len);
+  OCSP_BASICRESP* basic = nullptr;
+  OCSP_CERTID* id = nullptr;
+  ASN1_GENERALIZEDTIME* this_update = nullptr;
+  ASN1_GENERALIZEDTIME* next_update = nullptr;
+  int status;
+  int reason;
+  time_t now = time(nullptr);
+  time_t this_time;
+  time_t expires_at;
+
+  if (resp == nullptr) {
+    error = "Invalid OCSP response";
+    goto done;
+  }
+
+  if (OCSP_response_status(resp) != OCSP_RESPONSE_STATUS_SUCCESSFUL) {
+    error = "Unsuccessful OCSP response";
+    goto done;
+  }
+
+  basic = OCSP_response_get1_basic(resp);
+  id = OCSP_cert_to_id(nullptr, sc->cert_, sc->issuer_);
+  if (basic == nullptr ||
+      id == nullptr ||
+      !OCSP_resp_find_status(basic,
+                             id,
+                             &status,
+                             &reason,
+                             nullptr,
+                             &this_update,
+                             &next_update)) {
+    error = "OCSP response does not cover the certificate";
+    goto done;
+  }
+
+  if (!OCSP_check_validity(this_update, next_update, 300, -1) ||
+      !GeneralizedTimeToEpoch(this_update, &this_time)) {
+    error = "OCSP response is not valid at this time";
+    goto done;
+  }
+
+  if (next_update == nullptr) {
+    expires_at = now + kOCSPDefaultLifetime;
+  } else if (!GeneralizedTimeToEpoch(next_update, &expires_at)) {
+    error = "OCSP response is not valid at this time";
+    goto done;
+  }
+
+  sc->FreeOCSPResponse();
+  sc->ocsp_response_ = new unsigned char[len];
+  memcpy(sc->ocsp_response_, data, len);
+  sc->ocsp_response_len_ = len;
+  sc->ocsp_expires_at_ = expires_at;
+
+  // Refresh halfway through the validity period.
+  sc->ocsp_refresh_at_ = this_time + (expires_at - this_time) / 2;
+  if (sc->ocsp_refresh_at_ < now + kOCSPMinRefreshInterval)
+    sc->ocsp_refresh_at_ = now + kOCSPMinRefreshInterval;
+
+  args.GetReturnValue().Set(
+      static_cast<double>(sc->ocsp_refresh_at_) * 1000);
+
+ done:
+  if (id != nullptr)
+    OCSP_CERTID_free(id);
+  if (basic != nullptr)
+    OCSP_BASICRESP_free(basic);
+  if (resp != nullptr)
+    OCSP_RESPONSE_free(resp);
+  if (error != nullptr)
+    return env->ThrowError(error);
+}
+
+
+void SecureContext::ClearOCSPResponse(const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
+  sc->FreeOCSPResponse();
+}
+
+
+// deferOCSPRefresh(seconds)
+//
+// Called when a refresh failed.  Keeps serving the cached response, if it's
+// still valid, and tries again after `seconds`.
+void SecureContext::DeferOCSPRefresh(const FunctionCallbackInfo<Value>& args) {
+  SecureContext* sc = Unwrap<SecureContext>(args.Holder());
+  uint32_t delay = args[0]->Uint32Value();
+  if (delay < static_cast<uint32_t>(kOCSPMinRefreshInterval))
+    delay = kOCSPMinRefreshInterval;
+  sc->ocsp_refresh_at_ = time(nullptr) + delay;
+  sc->ocsp_refresh_deadline_ = 0;
+}
+
+
+bool SecureContext::StapleOCSPResponse(SSL* ssl) const {
+  // OpenSSL takes control of the pointer after accepting it
+  unsigned char* data =
+      static_cast<unsigned char*>(OPENSSL_malloc(ocsp_response_len_));
+  if (data == nullptr)
+    return false;
+  memcpy(data, ocsp_response_, ocsp_response_len_);
+
+  if (!SSL_set_tlsext_status_ocsp_resp(ssl, data, ocsp_response_len_)) {
+    OPENSSL_free(data);
+    return false;
+  }
+  return true;
+}
+
+
 template <bool primary>
 void SecureContext::GetCertificate(const FunctionCallbackInfo<Value>& args) {
   SecureContext* wrap = Unwrap<SecureContext>(args.Holder());
@@ -986,6 +1193,7 @@ void SSLWrap<Base>::AddMethods(Environment* env, Handle<FunctionTemplate> t) {
   env->SetProtoMethod(t, "newSessionDone", NewSessionDone);
   env->SetProtoMethod(t, "setOCSPResponse", SetOCSPResponse);
   env->SetProtoMethod(t, "requestOCSP", RequestOCSP);
+  env->SetProtoMethod(t, "enableOCSPCache", EnableOCSPCache);
 
 #ifdef SSL_set_max_send_fragment
   env->SetProtoMethod(t, "setMaxSendFragment", SetMaxSendFragment);
@@ -1590,6 +1798,22 @@ void SSLWrap<Base>::RequestOCSP(
 }
 
 
+// Lets TLSExtStatusCallback() staple the response cached on the current
+// SecureContext when no response was set with setOCSPResponse().  JS is only
+// entered, through onocsprefresh, when the cached response needs a refresh.
+//
+// enableOCSPCache([refreshTimeout])
+template <class Base>
+void SSLWrap<Base>::EnableOCSPCache(
+    const v8::FunctionCallbackInfo<v8::Value>& args) {
+  Base* w = Unwrap<Base>(args.Holder());
+  uint32_t timeout = SecureContext::kOCSPRefreshTimeout;
+  if (args[0]->IsUint32() && args[0]->Uint32Value() > 0)
+    timeout = args[0]->Uint32Value();
+  w->enable_ocsp_cache(timeout);
+}
+
+
 #ifdef SSL_set_max_send_fragment
 template <class Base>
 void SSLWrap<Base>::SetMaxSendFragment(
@@ -1839,8 +2063,33 @@ int SSLWrap<Base>::TLSExtStatusCallback(SSL* s, void* arg) {
     return 1;
   } else {
     // Outgoing response
-    if (w->ocsp_response_.IsEmpty())
-      return SSL_TLSEXT_ERR_NOACK;
+    if (w->ocsp_response_.IsEmpty()) {
+      if (!w->ocsp_cache_)
+        return SSL_TLSEXT_ERR_NOACK;
+
+      // SSL_get_SSL_CTX() returns the context selected by SNI, if any.
+      SecureContext* sc = static_cast<SecureContext*>(
+          SSL_CTX_get_app_data(SSL_get_SSL_CTX(s)));
+      if (sc == nullptr)
+        return SSL_TLSEXT_ERR_NOACK;
+
+      const time_t now = time(nullptr);
+      if (sc->NeedsOCSPRefresh(now)) {
+        // JS fetches a new response and hands it to sc.setOCSPResponse() or,
+        // on failure, calls sc.deferOCSPRefresh().  The handshake doesn't
+        // wait for it.  If neither happens, for example because a listener
+        // never calls back, the next handshake after the deadline retries.
+        sc->set_ocsp_refresh_pending(now + w->ocsp_refresh_timeout_);
+        Context::Scope context_scope(env->context());
+        Local<Value> arg = sc->object();
+        w->MakeCallback(env->onocsprefresh_string(), 1, &arg);
+      }
+
+      if (!sc->HasFreshOCSPResponse(now) || !sc->StapleOCSPResponse(s))
+        return SSL_TLSEXT_ERR_NOACK;
+
+      return SSL_TLSEXT_ERR_OK;
+    }
 
     Local<Object> obj = PersistentToLocal(env->isolate(), w->ocsp_response_);
     char* resp = Buffer::Data(obj);
@@ -2506,7 +2755,9 @@ void CipherBase::Initialize(Environment* env, Handle<Object> target) {
   env->SetProtoMethod(t, "init", Init);
   env->SetProtoMethod(t, "initiv", InitIv);
   env->SetProtoMethod(t, "update", Update);
+  env->SetProtoMethod(t, "updateInto", UpdateInto);
   env->SetProtoMethod(t, "final", Final);
+  env->SetProtoMethod(t, "finalInto", FinalInto);
   env->SetProtoMethod(t, "setAutoPadding", SetAutoPadding);
   env->SetProtoMethod(t, "getAuthTag", GetAuthTag);
   env->SetProtoMethod(t, "setAuthTag", SetAuthTag);
@@ -2727,7 +2978,7 @@ void CipherBase::SetAAD(const FunctionCallbackInfo<Value>& args) {
 
 bool CipherBase::Update(const char* data,
                         int len,
-                        unsigned char** out,
+                        unsigned char* out,
                         int* out_len) {
   if (!initialised_)
     return 0;
@@ -2742,16 +2993,24 @@ bool CipherBase::Update(const char* data,
     auth_tag_ = nullptr;
   }
 
-  *out_len = len + EVP_CIPHER_CTX_block_size(&ctx_);
-  *out = new unsigned char[*out_len];
   return EVP_CipherUpdate(&ctx_,
-                          *out,
+                          out,
                           out_len,
                           reinterpret_cast<const unsigned char*>(data),
                           len);
 }
 
 
+bool CipherBase::Update(const char* data,
+                        int len,
+                        unsigned char** out,
+                        int* out_len) {
+  *out_len = len + EVP_CIPHER_CTX_block_size(&ctx_);
+  *out = new unsigned char[*out_len];
+  return Update(data, len, *out, out_len);
+}
+
+
 void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2799,6 +3058,57 @@ void CipherBase::Update(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// updateInto(input, inputOffset, inputLength, output, outputOffset)
+//
+// Like update() but reads from a slice of `input` and writes the result into
+// `output` instead of allocating a new buffer.  Returns the number of bytes
+// written.  The output slice must have room for at least inputLength plus
+// the cipher's block size.
+void CipherBase::UpdateInto(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CipherBase* cipher = Unwrap<CipherBase>(args.Holder());
+
+  ASSERT_IS_BUFFER(args[0]);
+  ASSERT_IS_BUFFER(args[3]);
+
+  char* in;
+  size_t in_len;
+  if (!ParseBufferSlice(args[0], args[1], args[2], &in, &in_len))
+    return env->ThrowRangeError("out of range index");
+
+  char* out;
+  size_t out_len;
+  if (!ParseBufferSlice(args[3], args[4], Undefined(env->isolate()),
+                        &out, &out_len)) {
+    return env->ThrowRangeError("out of range index");
+  }
+
+  if (in_len > INT_MAX)
+    return env->ThrowRangeError("input too large");
+
+  if (!cipher->initialised_)
+    return env->ThrowError("Trying to add data in unsupported state");
+
+  const size_t block_size = EVP_CIPHER_CTX_block_size(&cipher->ctx_);
+  if (out_len < in_len + block_size)
+    return env->ThrowRangeError("output buffer too small");
+
+  int written = 0;
+  bool r = cipher->Update(in,
+                          in_len,
+                          reinterpret_cast<unsigned char*>(out),
+                          &written);
+  if (!r) {
+    return ThrowCryptoError(env,
+                            ERR_get_error(),
+                            "Trying to add data in unsupported state");
+  }
+
+  args.GetReturnValue().Set(written);
+}
+
+
 bool CipherBase::SetAutoPadding(bool auto_padding) {
   if (!initialised_)
     return false;
@@ -2812,12 +3122,11 @@ void CipherBase::SetAutoPadding(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-bool CipherBase::Final(unsigned char** out, int *out_len) {
+bool CipherBase::Final(unsigned char* out, int *out_len) {
   if (!initialised_)
     return false;
 
-  *out = new unsigned char[EVP_CIPHER_CTX_block_size(&ctx_)];
-  int r = EVP_CipherFinal_ex(&ctx_, *out, out_len);
+  int r = EVP_CipherFinal_ex(&ctx_, out, out_len);
 
   if (r && kind_ == kCipher) {
     delete[] auth_tag_;
@@ -2840,6 +3149,15 @@ bool CipherBase::Final(unsigned char** out, int *out_len) {
 }
 
 
+bool CipherBase::Final(unsigned char** out, int *out_len) {
+  if (!initialised_)
+    return false;
+
+  *out = new unsigned char[EVP_CIPHER_CTX_block_size(&ctx_)];
+  return Final(*out, out_len);
+}
+
+
 void CipherBase::Final(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2872,6 +3190,46 @@ void CipherBase::Final(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// finalInto(output, outputOffset)
+//
+// Like final() but writes the remaining bytes into `output`, which must have
+// room for at least one cipher block.  Returns the number of bytes written.
+void CipherBase::FinalInto(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CipherBase* cipher = Unwrap<CipherBase>(args.Holder());
+
+  ASSERT_IS_BUFFER(args[0]);
+
+  char* out;
+  size_t out_len;
+  if (!ParseBufferSlice(args[0], args[1], Undefined(env->isolate()),
+                        &out, &out_len)) {
+    return env->ThrowRangeError("out of range index");
+  }
+
+  if (cipher->initialised_ &&
+      out_len < static_cast<size_t>(EVP_CIPHER_CTX_block_size(&cipher->ctx_))) {
+    return env->ThrowRangeError("output buffer too small");
+  }
+
+  int written = 0;
+  bool r = cipher->Final(reinterpret_cast<unsigned char*>(out), &written);
+
+  if (!r) {
+    const char* msg = cipher->IsAuthenticatedMode() ?
+        "Unsupported state or unable to authenticate data" :
+        "Unsupported state";
+
+    return ThrowCryptoError(env,
+                            ERR_get_error(),
+                            msg);
+  }
+
+  args.GetReturnValue().Set(written);
+}
+
+
 void Hmac::Initialize(Environment* env, v8::Handle<v8::Object> target) {
   Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
 
@@ -2880,6 +3238,7 @@ void Hmac::Initialize(Environment* env, v8::Handle<v8::Object> target) {
   env->SetProtoMethod(t, "init", HmacInit);
   env->SetProtoMethod(t, "update", HmacUpdate);
   env->SetProtoMethod(t, "digest", HmacDigest);
+  env->SetProtoMethod(t, "digestInto", HmacDigestInto);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Hmac"), t->GetFunction());
 }
@@ -2957,6 +3316,13 @@ void Hmac::HmacUpdate(const FunctionCallbackInfo<Value>& args) {
                                         encoding);
     r = hmac->HmacUpdate(buf, written);
     delete[] buf;
+  } else if (args[1]->IsNumber()) {
+    // update(buffer, offset[, length])
+    char* buf;
+    size_t buflen;
+    if (!ParseBufferSlice(args[0], args[1], args[2], &buf, &buflen))
+      return env->ThrowRangeError("out of range index");
+    r = hmac->HmacUpdate(buf, buflen);
   } else {
     char* buf = Buffer::Data(args[0]);
     size_t buflen = Buffer::Length(args[0]);
@@ -2969,17 +3335,24 @@ void Hmac::HmacUpdate(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-bool Hmac::HmacDigest(unsigned char** md_value, unsigned int* md_len) {
+bool Hmac::HmacDigest(unsigned char* md_value, unsigned int* md_len) {
   if (!initialised_)
     return false;
-  *md_value = new unsigned char[EVP_MAX_MD_SIZE];
-  HMAC_Final(&ctx_, *md_value, md_len);
+  HMAC_Final(&ctx_, md_value, md_len);
   HMAC_CTX_cleanup(&ctx_);
   initialised_ = false;
   return true;
 }
 
 
+bool Hmac::HmacDigest(unsigned char** md_value, unsigned int* md_len) {
+  if (!initialised_)
+    return false;
+  *md_value = new unsigned char[EVP_MAX_MD_SIZE];
+  return HmacDigest(*md_value, md_len);
+}
+
+
 void Hmac::HmacDigest(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -3008,6 +3381,36 @@ void Hmac::HmacDigest(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// digestInto(output[, offset])
+//
+// Like digest() but writes the raw digest into `output` instead of
+// allocating a new buffer.  Returns the number of bytes written.
+void Hmac::HmacDigestInto(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  Hmac* hmac = Unwrap<Hmac>(args.Holder());
+
+  ASSERT_IS_BUFFER(args[0]);
+
+  char* out;
+  size_t out_len;
+  if (!ParseBufferSlice(args[0], args[1], Undefined(env->isolate()),
+                        &out, &out_len)) {
+    return env->ThrowRangeError("out of range index");
+  }
+
+  if (!hmac->initialised_)
+    return env->ThrowError("Not initialized");
+
+  if (out_len < static_cast<size_t>(EVP_MD_size(hmac->md_)))
+    return env->ThrowRangeError("output buffer too small");
+
+  unsigned int md_len = 0;
+  hmac->HmacDigest(reinterpret_cast<unsigned char*>(out), &md_len);
+  args.GetReturnValue().Set(md_len);
+}
+
+
 void Hash::Initialize(Environment* env, v8::Handle<v8::Object> target) {
   Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
 
@@ -3015,6 +3418,7 @@ void Hash::Initialize(Environment* env, v8::Handle<v8::Object> target) {
 
   env->SetProtoMethod(t, "update", HashUpdate);
   env->SetProtoMethod(t, "digest", HashDigest);
+  env->SetProtoMethod(t, "digestInto", HashDigestInto);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Hash"), t->GetFunction());
 }
@@ -3079,6 +3483,13 @@ void Hash::HashUpdate(const FunctionCallbackInfo<Value>& args) {
                                         encoding);
     r = hash->HashUpdate(buf, written);
     delete[] buf;
+  } else if (args[1]->IsNumber()) {
+    // update(buffer, offset[, length])
+    char* buf;
+    size_t buflen;
+    if (!ParseBufferSlice(args[0], args[1], args[2], &buf, &buflen))
+      return env->ThrowRangeError("out of range index");
+    r = hash->HashUpdate(buf, buflen);
   } else {
     char* buf = Buffer::Data(args[0]);
     size_t buflen = Buffer::Length(args[0]);
@@ -3120,6 +3531,41 @@ void Hash::HashDigest(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// digestInto(output[, offset])
+//
+// Like digest() but writes the raw digest into `output` instead of
+// allocating a new buffer.  Returns the number of bytes written.
+void Hash::HashDigestInto(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  Hash* hash = Unwrap<Hash>(args.Holder());
+
+  ASSERT_IS_BUFFER(args[0]);
+
+  char* out;
+  size_t out_len;
+  if (!ParseBufferSlice(args[0], args[1], Undefined(env->isolate()),
+                        &out, &out_len)) {
+    return env->ThrowRangeError("out of range index");
+  }
+
+  if (!hash->initialised_)
+    return env->ThrowError("Not initialized");
+
+  if (out_len < static_cast<size_t>(EVP_MD_size(hash->md_)))
+    return env->ThrowRangeError("output buffer too small");
+
+  unsigned int md_len = 0;
+  EVP_DigestFinal_ex(&hash->mdctx_,
+                     reinterpret_cast<unsigned char*>(out),
+                     &md_len);
+  EVP_MD_CTX_cleanup(&hash->mdctx_);
+  hash->initialised_ = false;
+
+  args.GetReturnValue().Set(md_len);
+}
+
+
 void SignBase::CheckThrow(SignBase::Error error) {
   HandleScope scope(env()->isolate());
 
@@ -4698,6 +5144,407 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Only instantiate within a valid HandleScope.
+class HashBatchRequest : public AsyncWrap {
+ public:
+  struct Message {
+    const char* data;
+    size_t length;
+    const char* key;
+    size_t key_length;
+  };
+
+  HashBatchRequest(Environment* env,
+                   Local<Object> object,
+                   const EVP_MD* md,
+                   bool hmac,
+                   size_t count)
+      : AsyncWrap(env, object, AsyncWrap::PROVIDER_CRYPTO),
+        md_(md),
+        hmac_(hmac),
+        error_(false),
+        count_(count),
+        digest_size_(EVP_MD_size(md)),
+        messages_(new Message[count]),
+        digests_(new unsigned char[count * digest_size_]) {
+  }
+
+  ~HashBatchRequest() override {
+    delete[] messages_;
+    delete[] digests_;
+    persistent().Reset();
+  }
+
+  uv_work_t* work_req() {
+    return &work_req_;
+  }
+
+  inline const EVP_MD* md() const {
+    return md_;
+  }
+
+  inline bool hmac() const {
+    return hmac_;
+  }
+
+  inline size_t count() const {
+    return count_;
+  }
+
+  inline size_t digest_size() const {
+    return digest_size_;
+  }
+
+  inline Message* message(size_t index) const {
+    return messages_ + index;
+  }
+
+  inline unsigned char* digest(size_t index) const {
+    return digests_ + index * digest_size_;
+  }
+
+  inline bool error() const {
+    return error_;
+  }
+
+  inline void set_error(bool error) {
+    error_ = error;
+  }
+
+  uv_work_t work_req_;
+
+ private:
+  const EVP_MD* md_;
+  const bool hmac_;
+  bool error_;
+  const size_t count_;
+  const size_t digest_size_;
+  Message* messages_;
+  unsigned char* digests_;
+};
+
+
+void HashBatchWork(HashBatchRequest* req) {
+  unsigned int md_len;
+
+  if (req->hmac()) {
+    HMAC_CTX ctx;
+    HMAC_CTX_init(&ctx);
+    for (size_t i = 0; i < req->count(); i++) {
+      const HashBatchRequest::Message* msg = req->message(i);
+      const HashBatchRequest::Message* prev = i > 0 ? msg - 1 : nullptr;
+      // Consecutive messages signed with the same key reuse the key schedule
+      // that HMAC_Init_ex() computed for the first one.
+      int r;
+      if (prev != nullptr &&
+          prev->key == msg->key &&
+          prev->key_length == msg->key_length) {
+        r = HMAC_Init_ex(&ctx, nullptr, 0, nullptr, nullptr);
+      } else {
+        // A nullptr key means "reuse the previous key" to OpenSSL.
+        const char* key = msg->key_length == 0 ? "" : msg->key;
+        r = HMAC_Init_ex(&ctx, key, msg->key_length, req->md(), nullptr);
+      }
+      if (!r ||
+          !HMAC_Update(&ctx,
+                       reinterpret_cast<const unsigned char*>(msg->data),
+                       msg->length) ||
+          !HMAC_Final(&ctx, req->digest(i), &md_len)) {
+        req->set_error(true);
+        break;
+      }
+    }
+    HMAC_CTX_cleanup(&ctx);
+  } else {
+    EVP_MD_CTX mdctx;
+    EVP_MD_CTX_init(&mdctx);
+    for (size_t i = 0; i < req->count(); i++) {
+      const HashBatchRequest::Message* msg = req->message(i);
+      if (!EVP_DigestInit_ex(&mdctx, req->md(), nullptr) ||
+          !EVP_DigestUpdate(&mdctx, msg->data, msg->length) ||
+          !EVP_DigestFinal_ex(&mdctx, req->digest(i), &md_len)) {
+        req->set_error(true);
+        break;
+      }
+    }
+    EVP_MD_CTX_cleanup(&mdctx);
+  }
+}
+
+
+void HashBatchWork(uv_work_t* work_req) {
+  HashBatchRequest* req = ContainerOf(&HashBatchRequest::work_req_, work_req);
+  HashBatchWork(req);
+}
+
+
+// don't call this function without a valid HandleScope
+Local<Array> HashBatchResult(HashBatchRequest* req) {
+  Environment* env = req->env();
+  Local<Array> result = Array::New(env->isolate(), req->count());
+  for (size_t i = 0; i < req->count(); i++) {
+    result->Set(i, Buffer::New(env,
+                               reinterpret_cast<const char*>(req->digest(i)),
+                               req->digest_size()));
+  }
+  return result;
+}
+
+
+void HashBatchAfter(uv_work_t* work_req, int status) {
+  CHECK_EQ(status, 0);
+  HashBatchRequest* req = ContainerOf(&HashBatchRequest::work_req_, work_req);
+  Environment* env = req->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+  Local<Value> argv[2];
+  if (req->error()) {
+    argv[0] = Exception::Error(
+        FIXED_ONE_BYTE_STRING(env->isolate(), "Digest failed"));
+    argv[1] = Undefined(env->isolate());
+  } else {
+    argv[0] = Null(env->isolate());
+    argv[1] = HashBatchResult(req);
+  }
+  req->MakeCallback(env->ondone_string(), ARRAY_SIZE(argv), argv);
+  delete req;
+}
+
+
+// hashBatch(algorithm, data, keys[, callback])
+//
+// Computes the digest of every buffer in the `data` array in one go, using a
+// single digest context.  When `keys` is a buffer, every message is signed
+// with that HMAC key; when it is an array, data[i] is signed with keys[i].
+// Any other value computes plain hashes.  The input buffers are referenced,
+// not copied, and must not be modified until the callback runs.  The request
+// holds on to the buffers themselves, so the caller is free to reuse the
+// arrays.
+void HashBatch(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsString())
+    return env->ThrowTypeError("Must give hashtype string as argument");
+
+  if (!args[1]->IsArray())
+    return env->ThrowTypeError("data must be an array of buffers");
+
+  const node::Utf8Value hash_type(args[0]);
+  const EVP_MD* md = EVP_get_digestbyname(*hash_type);
+  if (md == nullptr)
+    return env->ThrowError("Digest method not supported");
+
+  Local<Array> data = args[1].As<Array>();
+  const size_t count = data->Length();
+
+  const bool single_key = Buffer::HasInstance(args[2]);
+  const bool multi_key = args[2]->IsArray();
+  Local<Array> keys;
+  if (multi_key) {
+    keys = args[2].As<Array>();
+    if (keys->Length() != count)
+      return env->ThrowTypeError("keys and data must have the same length");
+  }
+
+  // Validate everything before creating the request so that a bad argument
+  // doesn't leave a half-initialized AsyncWrap behind.
+  for (size_t i = 0; i < count; i++) {
+    if (!Buffer::HasInstance(data->Get(i)))
+      return env->ThrowTypeError("Not a buffer");
+    if (multi_key && !Buffer::HasInstance(keys->Get(i)))
+      return env->ThrowTypeError("Not a buffer");
+  }
+
+  Local<Object> obj = Object::New(env->isolate());
+  HashBatchRequest* req =
+      new HashBatchRequest(env, obj, md, single_key || multi_key, count);
+
+  // The work request reads the buffers from the thread pool; keep our own
+  // references to them rather than to the caller's arrays, whose elements
+  // can be replaced at any time.
+  Local<Array> buffers =
+      Array::New(env->isolate(), multi_key ? 2 * count : count + 1);
+
+  for (size_t i = 0; i < count; i++) {
+    HashBatchRequest::Message* msg = req->message(i);
+    Local<Value> buf = data->Get(i);
+    buffers->Set(i, buf);
+    msg->data = Buffer::Data(buf);
+    msg->length = Buffer::Length(buf);
+    if (multi_key) {
+      Local<Value> key = keys->Get(i);
+      buffers->Set(count + i, key);
+      msg->key = Buffer::Data(key);
+      msg->key_length = Buffer::Length(key);
+    } else if (single_key) {
+      buffers->Set(count, args[2]);
+      msg->key = Buffer::Data(args[2]);
+      msg->key_length = Buffer::Length(args[2]);
+    } else {
+      msg->key = nullptr;
+      msg->key_length = 0;
+    }
+  }
+
+  if (args[3]->IsFunction()) {
+    // Keep the input buffers alive until the work request completes.
+    obj->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "buffers"), buffers);
+    obj->Set(env->ondone_string(), args[3]);
+    // XXX(trevnorris): This will need to go with the rest of domains.
+    if (env->in_domain())
+      obj->Set(env->domain_string(), env->domain_array()->Get(0));
+    uv_queue_work(env->event_loop(),
+                  req->work_req(),
+                  HashBatchWork,
+                  HashBatchAfter);
+  } else {
+    HashBatchWork(req);
+    if (req->error())
+      env->ThrowError("Digest failed");
+    else
+      args.GetReturnValue().Set(HashBatchResult(req));
+    delete req;
+  }
+}
+
+
+void RandomBytesPool::Initialize(Environment* env, Handle<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "read", Read);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "RandomBytesPool"),
+              t->GetFunction());
+}
+
+
+// new RandomBytesPool(size, threshold)
+//
+// The spare block is refilled once no more than `threshold` bytes are left in
+// the active block, and whenever a read finds the pool unable to serve it.
+void RandomBytesPool::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (!args[0]->IsUint32() || args[0]->Uint32Value() == 0)
+    return env->ThrowTypeError("size must be a number > 0");
+
+  if (!args[1]->IsUint32())
+    return env->ThrowTypeError("threshold must be a number >= 0");
+
+  const size_t size = args[0]->Uint32Value();
+  const size_t threshold = args[1]->Uint32Value();
+  if (size > Buffer::kMaxLength)
+    return env->ThrowRangeError("size > Buffer::kMaxLength");
+  if (threshold > size)
+    return env->ThrowRangeError("threshold must not be larger than size");
+
+  RandomBytesPool* pool =
+      new RandomBytesPool(env, args.This(), size, threshold);
+  pool->MaybeRefill();
+}
+
+
+// Copies `length` random bytes into `data`.  Returns false if the pool can't
+// satisfy the request right now, in which case the caller should fall back
+// to RAND_bytes().
+bool RandomBytesPool::Read(char* data, size_t length) {
+  if (!CanRead(length)) {
+    Refill(length);
+    return false;
+  }
+
+  if (length > available_) {
+    // Bytes left in the active block are discarded rather than stitched
+    // together with the spare block; they are cheap to regenerate.
+    OPENSSL_cleanse(active_, size_);
+    char* tmp = active_;
+    active_ = spare_;
+    spare_ = tmp;
+    available_ = size_;
+    spare_ready_ = false;
+  }
+
+  // Hand out bytes from the end of the block and wipe them afterwards so
+  // that no copy lingers in the pool.
+  char* p = active_ + available_ - length;
+  memcpy(data, p, length);
+  OPENSSL_cleanse(p, length);
+  available_ -= length;
+
+  MaybeRefill();
+  return true;
+}
+
+
+void RandomBytesPool::MaybeRefill() {
+  if (available_ <= threshold_)
+    Refill(0);
+}
+
+
+// Also called after a read the pool could not serve, so that it recovers
+// from a failed refill and from leftover bytes too few for the request.
+void RandomBytesPool::Refill(size_t length) {
+  if (spare_ready_ || refilling_ || length > size_)
+    return;
+
+  // Keep the pool alive while the thread pool is writing into it.
+  refilling_ = true;
+  ClearWeak();
+  uv_queue_work(env()->event_loop(), &work_req_, RefillWork, RefillAfter);
+}
+
+
+void RandomBytesPool::RefillWork(uv_work_t* work_req) {
+  RandomBytesPool* pool = ContainerOf(&RandomBytesPool::work_req_, work_req);
+
+  // Ensure that OpenSSL's PRNG is properly seeded.
+  CheckEntropy();
+
+  if (RAND_bytes(reinterpret_cast<unsigned char*>(pool->spare_),
+                 pool->size_) == 1) {
+    pool->error_ = 0;
+  } else {
+    pool->error_ = ERR_get_error();
+  }
+}
+
+
+void RandomBytesPool::RefillAfter(uv_work_t* work_req, int status) {
+  CHECK_EQ(status, 0);
+  RandomBytesPool* pool = ContainerOf(&RandomBytesPool::work_req_, work_req);
+  pool->refilling_ = false;
+  // On error the spare block stays empty and reads fall back to the regular
+  // randomBytes() path, which reports the error to the caller.
+  pool->spare_ready_ = (pool->error_ == 0);
+  pool->MakeWeak<RandomBytesPool>(pool);
+}
+
+
+// read(size) returns a buffer with `size` random bytes, or undefined if the
+// pool is (temporarily) exhausted.
+void RandomBytesPool::Read(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  RandomBytesPool* pool = Unwrap<RandomBytesPool>(args.Holder());
+
+  if (!args[0]->IsUint32())
+    return;
+
+  const size_t size = args[0]->Uint32Value();
+  if (!pool->CanRead(size)) {
+    pool->Refill(size);
+    return;
+  }
+
+  Local<Object> buf = Buffer::New(env, size);
+  CHECK(pool->Read(Buffer::Data(buf), size));
+  args.GetReturnValue().Set(buf);
+}
+
+
 void GetSSLCiphers(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -5042,6 +5889,7 @@ void InitCrypto(Handle<Object> target,
   Sign::Initialize(env, target);
   Verify::Initialize(env, target);
   Certificate::Initialize(env, target);
+  RandomBytesPool::Initialize(env, target);
 
 #ifndef OPENSSL_NO_ENGINE
   env->SetMethod(target, "setEngine", SetEngine);
@@ -5049,6 +5897,7 @@ void InitCrypto(Handle<Object> target,
   env->SetMethod(target, "PBKDF2", PBKDF2);
   env->SetMethod(target, "randomBytes", RandomBytes<false>);
   env->SetMethod(target, "pseudoRandomBytes", RandomBytes<true>);
+  env->SetMethod(target, "hashBatch", HashBatch);
   env->SetMethod(target, "getSSLCiphers", GetSSLCiphers);
   env->SetMethod(target, "getCiphers", GetCiphers);
   env->SetMethod(target, "getHashes", GetHashes);
@@ -50,6 +50,7 @@
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
 #include <openssl/hmac.h>
+#include <openssl/ocsp.h>
 #include <openssl/rand.h>
 #include <openssl/pkcs12.h>
 
@@ -84,6 +85,29 @@ class SecureContext : public BaseObject {
 
   static const int kMaxSessionSize = 10 * 1024;
 
+  // Responses without a nextUpdate field are considered valid for this long.
+  static const int kOCSPDefaultLifetime = 3600;  // seconds
+  // Minimum time between two refreshes of the cached OCSP response.
+  static const int kOCSPMinRefreshInterval = 60;  // seconds
+  // How long a refresh may take before it is considered lost and retried.
+  static const int kOCSPRefreshTimeout = 120;  // seconds
+
+  inline bool HasFreshOCSPResponse(time_t now) const {
+    return ocsp_response_ != nullptr && now < ocsp_expires_at_;
+  }
+
+  inline bool NeedsOCSPRefresh(time_t now) const {
+    return now >= ocsp_refresh_at_ && now >= ocsp_refresh_deadline_;
+  }
+
+  // A refresh is in flight until setOCSPResponse() or deferOCSPRefresh() is
+  // called, or until `deadline` passes without either.
+  inline void set_ocsp_refresh_pending(time_t deadline) {
+    ocsp_refresh_deadline_ = deadline;
+  }
+
+  bool StapleOCSPResponse(SSL* ssl) const;
+
  protected:
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -105,6 +129,10 @@ class SecureContext : public BaseObject {
   static void LoadPKCS12(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTicketKeys(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetOCSPResponse(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void ClearOCSPResponse(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void DeferOCSPRefresh(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void CtxGetter(v8::Local<v8::String> property,
                         const v8::PropertyCallbackInfo<v8::Value>& info);
 
@@ -116,11 +144,26 @@ class SecureContext : public BaseObject {
         ca_store_(nullptr),
         ctx_(nullptr),
         cert_(nullptr),
-        issuer_(nullptr) {
+        issuer_(nullptr),
+        ocsp_response_(nullptr),
+        ocsp_response_len_(0),
+        ocsp_expires_at_(0),
+        ocsp_refresh_at_(0),
+        ocsp_refresh_deadline_(0) {
     MakeWeak<SecureContext>(this);
   }
 
+  void FreeOCSPResponse() {
+    delete[] ocsp_response_;
+    ocsp_response_ = nullptr;
+    ocsp_response_len_ = 0;
+    ocsp_expires_at_ = 0;
+    ocsp_refresh_at_ = 0;
+    ocsp_refresh_deadline_ = 0;
+  }
+
   void FreeCTXMem() {
+    FreeOCSPResponse();
     if (ctx_) {
       if (ctx_->cert_store == root_cert_store) {
         // SSL_CTX_free() will attempt to free the cert_store as well.
@@ -142,6 +185,14 @@ class SecureContext : public BaseObject {
       CHECK_EQ(ca_store_, nullptr);
     }
   }
+
+ private:
+  // DER-encoded OCSP response for cert_, see SetOCSPResponse().
+  unsigned char* ocsp_response_;
+  size_t ocsp_response_len_;
+  time_t ocsp_expires_at_;
+  time_t ocsp_refresh_at_;
+  time_t ocsp_refresh_deadline_;
 };
 
 // SSLWrap implicitly depends on the inheriting class' handle having an
@@ -159,7 +210,9 @@ class SSLWrap {
         kind_(kind),
         next_sess_(nullptr),
         session_callbacks_(false),
-        new_session_wait_(false) {
+        new_session_wait_(false),
+        ocsp_cache_(false),
+        ocsp_refresh_timeout_(SecureContext::kOCSPRefreshTimeout) {
     ssl_ = SSL_new(sc->ctx_);
     CHECK_NE(ssl_, nullptr);
   }
@@ -185,6 +238,10 @@ class SSLWrap {
 
   inline SSL* ssl() const { return ssl_; }
   inline void enable_session_callbacks() { session_callbacks_ = true; }
+  inline void enable_ocsp_cache(uint32_t refresh_timeout) {
+    ocsp_cache_ = true;
+    ocsp_refresh_timeout_ = refresh_timeout;
+  }
   inline bool is_server() const { return kind_ == kServer; }
   inline bool is_client() const { return kind_ == kClient; }
   inline bool is_waiting_new_session() const { return new_session_wait_; }
@@ -217,6 +274,7 @@ class SSLWrap {
   static void NewSessionDone(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetOCSPResponse(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RequestOCSP(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void EnableOCSPCache(const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_set_max_send_fragment
   static void SetMaxSendFragment(
@@ -252,6 +310,8 @@ class SSLWrap {
   SSL* ssl_;
   bool session_callbacks_;
   bool new_session_wait_;
+  bool ocsp_cache_;
+  uint32_t ocsp_refresh_timeout_;
   ClientHelloParser hello_parser_;
 
 #ifdef NODE__HAVE_TLSEXT_STATUS_CB
@@ -382,7 +442,9 @@ class CipherBase : public BaseObject {
               int key_len,
               const char* iv,
               int iv_len);
+  bool Update(const char* data, int len, unsigned char* out, int* out_len);
   bool Update(const char* data, int len, unsigned char** out, int* out_len);
+  bool Final(unsigned char* out, int *out_len);
   bool Final(unsigned char** out, int *out_len);
   bool SetAutoPadding(bool auto_padding);
 
@@ -395,7 +457,9 @@ class CipherBase : public BaseObject {
   static void Init(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void InitIv(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Update(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void UpdateInto(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Final(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FinalInto(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetAutoPadding(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void GetAuthTag(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -436,12 +500,14 @@ class Hmac : public BaseObject {
  protected:
   void HmacInit(const char* hash_type, const char* key, int key_len);
   bool HmacUpdate(const char* data, int len);
+  bool HmacDigest(unsigned char* md_value, unsigned int* md_len);
   bool HmacDigest(unsigned char** md_value, unsigned int* md_len);
 
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HmacInit(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HmacUpdate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HmacDigest(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void HmacDigestInto(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   Hmac(Environment* env, v8::Local<v8::Object> wrap)
       : BaseObject(env, wrap),
@@ -473,6 +539,7 @@ class Hash : public BaseObject {
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HashUpdate(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void HashDigest(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void HashDigestInto(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   Hash(Environment* env, v8::Local<v8::Object> wrap)
       : BaseObject(env, wrap),
@@ -699,6 +766,69 @@ class Certificate : public AsyncWrap {
   }
 };
 
+// A double-buffered pool of cryptographically strong random bytes.  Small
+// randomBytes() requests are served synchronously from the active block
+// while the spare block is refilled from RAND_bytes() in the thread pool.
+class RandomBytesPool : public BaseObject {
+ public:
+  ~RandomBytesPool() override {
+    Release(active_, size_);
+    Release(spare_, size_);
+  }
+
+  static void Initialize(Environment* env, v8::Handle<v8::Object> target);
+
+  inline bool CanRead(size_t length) const {
+    return length <= available_ || (spare_ready_ && length <= size_);
+  }
+
+  bool Read(char* data, size_t length);
+
+ protected:
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Read(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static void RefillWork(uv_work_t* work_req);
+  static void RefillAfter(uv_work_t* work_req, int status);
+
+  void MaybeRefill();
+  void Refill(size_t length);
+
+  static void Release(char* data, size_t length) {
+    if (data == nullptr)
+      return;
+    OPENSSL_cleanse(data, length);
+    delete[] data;
+  }
+
+  RandomBytesPool(Environment* env,
+                  v8::Local<v8::Object> wrap,
+                  size_t size,
+                  size_t threshold)
+      : BaseObject(env, wrap),
+        size_(size),
+        threshold_(threshold),
+        active_(new char[size]),
+        available_(0),
+        spare_(new char[size]),
+        spare_ready_(false),
+        refilling_(false),
+        error_(0) {
+    MakeWeak<RandomBytesPool>(this);
+  }
+
+ private:
+  const size_t size_;
+  const size_t threshold_;
+  char* active_;
+  size_t available_;
+  char* spare_;
+  bool spare_ready_;
+  bool refilling_;
+  unsigned long error_;  // NOLINT(runtime/int)
+  uv_work_t work_req_;
+};
+
 bool EntropySource(unsigned char* buffer, size_t length);
 #ifndef OPENSSL_NO_ENGINE
 void SetEngine(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -478,6 +478,197 @@ static void FStat(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
+// Used to speed up module loading.  Returns 0 if the path refers to a file,
+// 1 when it's a directory or < 0 on error (usually UV_ENOENT).  The speedup
+// comes from not creating Stats objects and not throwing exceptions for
+// missing files.
+static int InternalModuleStat(uv_loop_t* loop, const char* path) {
+  uv_fs_t req;
+  int rc = uv_fs_stat(loop, &req, path, nullptr);
+  if (rc == 0) {
+    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
+    rc = !!(s->st_mode & S_IFDIR);
+  }
+  uv_fs_req_cleanup(&req);
+  return rc;
+}
+
+
+static void InternalModuleStat(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (args.Length() < 1 || !args[0]->IsString())
+    return TYPE_ERROR("path must be a string");
+
+  node::Utf8Value path(args[0]);
+  args.GetReturnValue().Set(InternalModuleStat(env->event_loop(), *path));
+}
+
+
+// Stats the candidate paths in order and returns the index of the first one
+// that exists and isn't a directory, or -1 if there is none.
+static void InternalModuleFindFile(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (args.Length() < 1 || !args[0]->IsArray())
+    return TYPE_ERROR("paths must be an array");
+
+  Local<Array> paths = args[0].As<Array>();
+  const uint32_t length = paths->Length();
+  for (uint32_t i = 0; i < length; i++) {
+    node::Utf8Value path(paths->Get(i));
+    if (InternalModuleStat(env->event_loop(), *path) == 0)
+      return args.GetReturnValue().Set(i);
+  }
+  args.GetReturnValue().Set(-1);
+}
+
+
+// Modification time of |path| in milliseconds, or -1 if it can't be stat'ed.
+static double InternalModuleMtime(uv_loop_t* loop, const char* path) {
+  uv_fs_t req;
+  double mtime = -1;
+  if (uv_fs_stat(loop, &req, path, nullptr) == 0) {
+    const uv_stat_t* const s = static_cast<const uv_stat_t*>(req.ptr);
+    mtime = static_cast<double>(s->st_mtim.tv_sec) * 1e3 +
+            static_cast<double>(s->st_mtim.tv_nsec) / 1e6;
+  }
+  uv_fs_req_cleanup(&req);
+  return mtime;
+}
+
+
+// Returns the modification times of the paths, as for InternalModuleMtime().
+static void InternalModuleMtimes(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (args.Length() < 1 || !args[0]->IsArray())
+    return TYPE_ERROR("paths must be an array");
+
+  Local<Array> paths = args[0].As<Array>();
+  const uint32_t length = paths->Length();
+  Local<Array> mtimes = Array::New(env->isolate(), length);
+  for (uint32_t i = 0; i < length; i++) {
+    node::Utf8Value path(paths->Get(i));
+    mtimes->Set(i, Number::New(env->isolate(),
+                               InternalModuleMtime(env->event_loop(), *path)));
+  }
+  args.GetReturnValue().Set(mtimes);
+}
+
+
+// Returns true if the paths still have the modification times in |mtimes|.
+// Stops at the first one that doesn't.
+static void InternalModuleCheckMtimes(
+    const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  if (args.Length() < 2 || !args[0]->IsArray() || !args[1]->IsArray())
+    return TYPE_ERROR("paths and mtimes must be arrays");
+
+  Local<Array> paths = args[0].As<Array>();
+  Local<Array> mtimes = args[1].As<Array>();
+  const uint32_t length = paths->Length();
+  if (mtimes->Length() != length)
+    return args.GetReturnValue().Set(false);
+
+  for (uint32_t i = 0; i < length; i++) {
+    Local<Value> path_v = paths->Get(i);
+    if (!path_v->IsString())
+      return args.GetReturnValue().Set(false);
+    node::Utf8Value path(path_v);
+    double mtime = InternalModuleMtime(env->event_loop(), *path);
+    if (mtime != mtimes->Get(i)->NumberValue())
+      return args.GetReturnValue().Set(false);
+  }
+  args.GetReturnValue().Set(true);
+}
+
+
+// Reads a package.json for the module loader.  Returns undefined if the file
+// can't be read, and an empty string if it has no "main" key, so that the
+// caller can skip parsing it.
+static void InternalModuleReadJSON(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  uv_loop_t* loop = env->event_loop();
+
+  if (args.Length() < 1 || !args[0]->IsString())
+    return TYPE_ERROR("path must be a string");
+
+  node::Utf8Value path(args[0]);
+
+  uv_fs_t open_req;
+  const int fd = uv_fs_open(loop, &open_req, *path, O_RDONLY, 0, nullptr);
+  uv_fs_req_cleanup(&open_req);
+
+  if (fd < 0)
+    return;
+
+  char* data = nullptr;
+  size_t size = 0;
+  size_t capacity = 0;
+  int64_t offset = 0;
+  int numchars;
+  int err = 0;
+  do {
+    if (capacity - size < 4096) {
+      capacity = capacity == 0 ? 8192 : capacity * 2;
+      char* grown = static_cast<char*>(realloc(data, capacity));
+      if (grown == nullptr) {
+        err = UV_ENOMEM;
+        break;
+      }
+      data = grown;
+    }
+
+    uv_fs_t read_req;
+    uv_buf_t buf = uv_buf_init(data + size, capacity - size);
+    numchars = uv_fs_read(loop, &read_req, fd, &buf, 1, offset, nullptr);
+    uv_fs_req_cleanup(&read_req);
+
+    if (numchars < 0) {
+      err = numchars;
+      break;
+    }
+    size += numchars;
+    offset += numchars;
+  } while (numchars != 0);
+
+  uv_fs_t close_req;
+  CHECK_EQ(0, uv_fs_close(loop, &close_req, fd, nullptr));
+  uv_fs_req_cleanup(&close_req);
+
+  if (err != 0) {
+    free(data);
+    if (err == UV_ENOMEM)
+      return env->ThrowUVException(err, "read", nullptr, *path);
+    return;
+  }
+
+  static const char kMainKey[] = "\"main\"";
+  bool has_main = false;
+  for (size_t i = 0; i + sizeof(kMainKey) - 1 <= size; i++) {
+    if (data[i] == '"' &&
+        memcmp(data + i, kMainKey, sizeof(kMainKey) - 1) == 0) {
+      has_main = true;
+      break;
+    }
+  }
+
+  Local<String> chars;
+  if (has_main) {
+    chars = String::NewFromUtf8(env->isolate(),
+                                data,
+                                String::kNormalString,
+                                size);
+  } else {
+    chars = String::Empty(env->isolate());
+  }
+  free(data);
+  args.GetReturnValue().Set(chars);
+}
+
+
 static void Symlink(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -1134,6 +1325,14 @@ void InitFs(Handle<Object> target,
   env->SetMethod(target, "utimes", UTimes);
   env->SetMethod(target, "futimes", FUTimes);
 
+  env->SetMethod(target, "internalModuleStat", InternalModuleStat);
+  env->SetMethod(target, "internalModuleFindFile", InternalModuleFindFile);
+  env->SetMethod(target, "internalModuleReadJSON", InternalModuleReadJSON);
+  env->SetMethod(target, "internalModuleMtimes", InternalModuleMtimes);
+  env->SetMethod(target,
+                 "internalModuleCheckMtimes",
+                 InternalModuleCheckMtimes);
+
   StatWatcher::Initialize(env, target);
 }
 
@@ -22,6 +22,8 @@
 #include "node.h"
 #include "node_buffer.h"
 #include "node_http_parser.h"
+#include "node_wrap.h"  // WITH_GENERIC_STREAM
+#include "stream_wrap.h"
 
 #include "base-object.h"
 #include "base-object-inl.h"
@@ -33,6 +35,7 @@
 
 #include <stdlib.h>  // free()
 #include <string.h>  // strdup()
+#include <time.h>  // time(), gmtime_r()
 
 #if defined(_MSC_VER)
 #define strcasecmp _stricmp
@@ -50,6 +53,10 @@
 //     ...
 // No copying is performed when slicing the buffer, only small reference
 // allocations.
+//
+// Alternatively, parser.consume(handle) attaches the parser to a stream.
+// Reads are then parsed as they come in, without a trip through JS land, and
+// the parser reports back to parser.onExecute once per read.
 
 
 namespace node {
@@ -66,13 +73,16 @@ using v8::Integer;
 using v8::Local;
 using v8::Object;
 using v8::String;
+using v8::TryCatch;
 using v8::Uint32;
+using v8::Undefined;
 using v8::Value;
 
 const uint32_t kOnHeaders = 0;
 const uint32_t kOnHeadersComplete = 1;
 const uint32_t kOnBody = 2;
 const uint32_t kOnMessageComplete = 3;
+const uint32_t kOnExecute = 4;
 
 
 #define HTTP_CB(name)                                                         \
@@ -91,61 +101,187 @@ const uint32_t kOnMessageComplete = 3;
   int name##_(const char* at, size_t length)
 
 
-// helper class for the Parser
-struct StringPtr {
-  StringPtr() {
-    on_heap_ = false;
-    Reset();
+// How the parsers are being used, exposed to JS as parserCounters.  A pool
+// that is too small shows up as many parsers created and closed compared to
+// the number reused.
+#define PARSER_COUNTERS(V)                                                    \
+  V(kParsersCreated)                                                          \
+  V(kParsersReused)                                                           \
+  V(kParsersClosed)                                                           \
+  V(kParsersLive)                                                             \
+  V(kParsersMaxLive)                                                          \
+  V(kParserHeapStrings)
+
+enum ParserCounter {
+#define V(name) name,
+  PARSER_COUNTERS(V)
+#undef V
+  kParserCounterCount
+};
+
+static double parser_counters[kParserCounterCount];
+
+
+// Holds the bytes of the URL, status message and headers that have to
+// outlive the read they came in.  Allocations are bumped through a list of
+// blocks and only released together: the parser resets the arena when a new
+// message starts, keeping a block of up to kRetainedSize for the next one,
+// and releases all of it when it is reinitialized.
+class HeaderArena {
+ public:
+  static const size_t kBlockSize = 1024;
+  static const size_t kRetainedSize = 16 * 1024;
+  // http_parser stops at HTTP_MAX_HEADER_SIZE bytes of headers, and again
+  // for the trailers.  Copies that a string has grown out of do not count.
+  static const size_t kMaxSize = 2 * HTTP_MAX_HEADER_SIZE;
+
+  HeaderArena() : head_(nullptr), held_(0), overflowed_(false) {}
+
+  ~HeaderArena() {
+    Free(head_);
   }
 
+  // |replaced| is the size of an earlier allocation whose bytes the new one
+  // takes over.  Returns nullptr when the arena would hold more than
+  // kMaxSize bytes for the message.
+  char* Allocate(size_t size, size_t replaced = 0) {
+    if (held_ - replaced + size > kMaxSize) {
+      overflowed_ = true;
+      return nullptr;
+    }
+
+    if (head_ == nullptr || head_->size - head_->used < size) {
+      // Twice the size asked for, so a string that keeps growing moves at
+      // most a logarithmic number of times.
+      size_t block_size = kBlockSize;
+      if (head_ != nullptr && head_->size < kRetainedSize)
+        block_size = 2 * head_->size;
+      if (block_size < 2 * size)
+        block_size = 2 * size;
+
+      Block* block = static_cast<Block*>(malloc(sizeof(*block) + block_size));
+      CHECK_NE(block, nullptr);
+      block->next = head_;
+      block->size = block_size;
+      block->used = 0;
+      head_ = block;
+    }
+
+    char* p = head_->data() + head_->used;
+    head_->used += size;
+    held_ = held_ - replaced + size;
+    return p;
+  }
+
+  // Grows the allocation of |old_size| bytes at |p| by |size| bytes if it
+  // is the last one and its block has the room.
+  bool Extend(const char* p, size_t old_size, size_t size) {
+    if (head_ == nullptr || p + old_size != head_->data() + head_->used)
+      return false;
+    if (head_->size - head_->used < size || held_ + size > kMaxSize)
+      return false;
+    head_->used += size;
+    held_ += size;
+    return true;
+  }
+
+  void Reset() {
+    if (head_ == nullptr || head_->size > kRetainedSize) {
+      Release();
+    } else {
+      Free(head_->next);
+      head_->next = nullptr;
+      head_->used = 0;
+    }
+    held_ = 0;
+    overflowed_ = false;
+  }
+
+  void Release() {
+    Free(head_);
+    head_ = nullptr;
+    held_ = 0;
+    overflowed_ = false;
+  }
+
+  bool overflowed() const { return overflowed_; }
+
+ private:
+  struct Block {
+    Block* next;
+    size_t size;
+    size_t used;
+    char* data() { return reinterpret_cast<char*>(this + 1); }
+  };
+
+  static void Free(Block* block) {
+    while (block != nullptr) {
+      Block* next = block->next;
+      free(block);
+      block = next;
+    }
+  }
 
-  ~StringPtr() {
+  Block* head_;
+  size_t held_;  // bytes in the allocations still in use
+  bool overflowed_;
+};
+
+
+// helper class for the Parser
+struct StringPtr {
+  StringPtr() {
     Reset();
   }
 
 
-  // If str_ does not point to a heap string yet, this function makes it do
-  // so. This is called at the end of each http_parser_execute() so as not
-  // to leak references. See issue #2438 and test-http-parser-bad-ref.js.
-  void Save() {
+  // If str_ does not point to a copy in the arena yet, this function makes
+  // it do so. This is called at the end of each http_parser_execute() so as
+  // not to leak references. See issue #2438 and test-http-parser-bad-ref.js.
+  bool Save(HeaderArena* arena) {
     if (!on_heap_ && size_ > 0) {
-      char* s = new char[size_];
+      char* s = arena->Allocate(size_);
+      if (s == nullptr)
+        return false;
       memcpy(s, str_, size_);
       str_ = s;
       on_heap_ = true;
+      parser_counters[kParserHeapStrings]++;
     }
+    return true;
   }
 
 
+  // The arena releases the memory.
   void Reset() {
-    if (on_heap_) {
-      delete[] str_;
-      on_heap_ = false;
-    }
-
     str_ = nullptr;
+    on_heap_ = false;
     size_ = 0;
   }
 
 
-  void Update(const char* str, size_t size) {
-    if (str_ == nullptr)
+  bool Update(const char* str, size_t size, HeaderArena* arena) {
+    if (str_ == nullptr) {
       str_ = str;
-    else if (on_heap_ || str_ + size_ != str) {
-      // Non-consecutive input, make a copy on the heap.
-      // TODO(bnoordhuis) Use slab allocation, O(n) allocs is bad.
-      char* s = new char[size_ + size];
+    } else if (on_heap_ && arena->Extend(str_, size_, size)) {
+      memcpy(const_cast<char*>(str_) + size_, str, size);
+    } else if (on_heap_ || str_ + size_ != str) {
+      // Non-consecutive input, make a copy in the arena.
+      char* s = arena->Allocate(size_ + size, on_heap_ ? size_ : 0);
+      if (s == nullptr)
+        return false;
       memcpy(s, str_, size_);
       memcpy(s + size_, str, size);
 
-      if (on_heap_)
-        delete[] str_;
-      else
+      if (!on_heap_) {
         on_heap_ = true;
+        parser_counters[kParserHeapStrings]++;
+      }
 
       str_ = s;
     }
     size_ += size;
+    return true;
   }
 
 
@@ -163,20 +299,54 @@ struct StringPtr {
 };
 
 
+class Parser;
+
+// Installed on a stream by parser.consume(). Passes reads to the parser until
+// the parser lets go of the stream, and behaves like the default callbacks
+// after that. The stream owns this object.
+class ParserStreamCallbacks : public StreamWrapCallbacks {
+ public:
+  ParserStreamCallbacks(Parser* parser, StreamWrapCallbacks* old)
+      : StreamWrapCallbacks(old),
+        parser_(parser) {
+  }
+
+  ~ParserStreamCallbacks() override;
+
+  void DoRead(uv_stream_t* handle,
+              ssize_t nread,
+              const uv_buf_t* buf,
+              uv_handle_type pending) override;
+
+ private:
+  friend class Parser;
+
+  Parser* parser_;
+};
+
+
 class Parser : public BaseObject {
  public:
   Parser(Environment* env, Local<Object> wrap, enum http_parser_type type)
       : BaseObject(env, wrap),
         current_buffer_len_(0),
-        current_buffer_data_(nullptr) {
+        current_buffer_data_(nullptr),
+        stream_data_(nullptr),
+        stream_callbacks_(nullptr),
+        in_use_(false) {
     Wrap(object(), this);
     Init(type);
+    parser_counters[kParsersCreated]++;
+    if (++parser_counters[kParsersLive] > parser_counters[kParsersMaxLive])
+      parser_counters[kParsersMaxLive] = parser_counters[kParsersLive];
   }
 
 
   ~Parser() override {
+    Unconsume();
     ClearWrap(object());
     persistent().Reset();
+    parser_counters[kParsersLive]--;
   }
 
 
@@ -184,19 +354,19 @@ class Parser : public BaseObject {
     num_fields_ = num_values_ = 0;
     url_.Reset();
     status_message_.Reset();
+    // Nothing refers to the previous message's strings anymore.
+    arena_.Reset();
     return 0;
   }
 
 
   HTTP_DATA_CB(on_url) {
-    url_.Update(at, length);
-    return 0;
+    return url_.Update(at, length, &arena_) ? 0 : -1;
   }
 
 
   HTTP_DATA_CB(on_status) {
-    status_message_.Update(at, length);
-    return 0;
+    return status_message_.Update(at, length, &arena_) ? 0 : -1;
   }
 
 
@@ -216,9 +386,7 @@ class Parser : public BaseObject {
     CHECK_LT(num_fields_, static_cast<int>(ARRAY_SIZE(fields_)));
     CHECK_EQ(num_fields_, num_values_ + 1);
 
-    fields_[num_fields_ - 1].Update(at, length);
-
-    return 0;
+    return fields_[num_fields_ - 1].Update(at, length, &arena_) ? 0 : -1;
   }
 
 
@@ -232,9 +400,7 @@ class Parser : public BaseObject {
     CHECK_LT(num_values_, static_cast<int>(ARRAY_SIZE(values_)));
     CHECK_EQ(num_values_, num_fields_);
 
-    values_[num_values_ - 1].Update(at, length);
-
-    return 0;
+    return values_[num_values_ - 1].Update(at, length, &arena_) ? 0 : -1;
   }
 
 
@@ -301,17 +467,35 @@ class Parser : public BaseObject {
 
 
   HTTP_DATA_CB(on_body) {
-    HandleScope scope(env()->isolate());
+    // A chunked body comes in one piece per chunk.  Hold on to the pieces
+    // and pass everything from this read to JS land in one callback.
+    if (parser_.flags & F_CHUNKED) {
+      if (num_bodies_ == static_cast<int>(ARRAY_SIZE(body_offsets_)) &&
+          FlushBody() != 0) {
+        return -1;
+      }
+      body_offsets_[num_bodies_] = at - current_buffer_data_;
+      body_lengths_[num_bodies_] = length;
+      num_bodies_++;
+      return 0;
+    }
+
+    return OnBody(CurrentBuffer(), at - current_buffer_data_, length);
+  }
+
 
+  int OnBody(Local<Object> buffer, size_t offset, size_t length) {
     Local<Object> obj = object();
     Local<Value> cb = obj->Get(kOnBody);
 
     if (!cb->IsFunction())
       return 0;
 
+    HandleScope scope(env()->isolate());
+
     Local<Value> argv[3] = {
-      current_buffer_,
-      Integer::NewFromUnsigned(env()->isolate(), at - current_buffer_data_),
+      buffer,
+      Integer::NewFromUnsigned(env()->isolate(), offset),
       Integer::NewFromUnsigned(env()->isolate(), length)
     };
 
@@ -326,7 +510,41 @@ class Parser : public BaseObject {
   }
 
 
+  // Passes the chunks that on_body() held on to to JS land, copied into a
+  // single Buffer when there is more than one.
+  int FlushBody() {
+    if (num_bodies_ == 0)
+      return 0;
+
+    int num_bodies = num_bodies_;
+    num_bodies_ = 0;
+
+    // Callers must not have a HandleScope open: CurrentBuffer() keeps the
+    // handle it creates for the rest of the read.
+    if (num_bodies == 1)
+      return OnBody(CurrentBuffer(), body_offsets_[0], body_lengths_[0]);
+
+    size_t length = 0;
+    for (int i = 0; i < num_bodies; i++)
+      length += body_lengths_[i];
+
+    Local<Object> buffer = Buffer::New(env(), length);
+    char* data = Buffer::Data(buffer);
+    for (int i = 0; i < num_bodies; i++) {
+      memcpy(data, current_buffer_data_ + body_offsets_[i], body_lengths_[i]);
+      data += body_lengths_[i];
+    }
+
+    return OnBody(buffer, 0, length);
+  }
+
+
   HTTP_CB(on_message_complete) {
+    // Before the HandleScope: FlushBody() may create current_buffer_, which
+    // has to stay valid for the rest of the read.
+    if (FlushBody() != 0)
+      return -1;
+
     HandleScope scope(env()->isolate());
 
     if (num_fields_)
@@ -360,28 +578,32 @@ class Parser : public BaseObject {
 
   static void Close(const FunctionCallbackInfo<Value>& args) {
     Parser* parser = Unwrap<Parser>(args.Holder());
+    parser_counters[kParsersClosed]++;
     delete parser;
   }
 
 
-  void Save() {
-    url_.Save();
-    status_message_.Save();
+  // Returns false when the arena is full.
+  bool Save() {
+    if (!url_.Save(&arena_) || !status_message_.Save(&arena_))
+      return false;
 
     for (int i = 0; i < num_fields_; i++) {
-      fields_[i].Save();
+      if (!fields_[i].Save(&arena_))
+        return false;
     }
 
     for (int i = 0; i < num_values_; i++) {
-      values_[i].Save();
+      if (!values_[i].Save(&arena_))
+        return false;
     }
+
+    return true;
   }
 
 
   // var bytesParsed = parser->execute(buffer);
   static void Execute(const FunctionCallbackInfo<Value>& args) {
-    Environment* env = Environment::GetCurrent(args);
-
     Parser* parser = Unwrap<Parser>(args.Holder());
     CHECK(parser->current_buffer_.IsEmpty());
     CHECK_EQ(parser->current_buffer_len_, 0);
@@ -389,47 +611,90 @@ class Parser : public BaseObject {
     CHECK_EQ(Buffer::HasInstance(args[0]), true);
 
     Local<Object> buffer_obj = args[0].As<Object>();
-    char* buffer_data = Buffer::Data(buffer_obj);
-    size_t buffer_len = Buffer::Length(buffer_obj);
 
     // This is a hack to get the current_buffer to the callbacks with the least
     // amount of overhead. Nothing else will run while http_parser_execute()
     // runs, therefore this pointer can be set and used for the execution.
     parser->current_buffer_ = buffer_obj;
-    parser->current_buffer_len_ = buffer_len;
-    parser->current_buffer_data_ = buffer_data;
-    parser->got_exception_ = false;
-
-    size_t nparsed =
-      http_parser_execute(&parser->parser_, &settings, buffer_data, buffer_len);
 
-    parser->Save();
+    Local<Value> ret = parser->Execute(Buffer::Data(buffer_obj),
+                                       Buffer::Length(buffer_obj));
 
     // Unassign the 'buffer_' variable
     parser->current_buffer_.Clear();
-    parser->current_buffer_len_ = 0;
-    parser->current_buffer_data_ = nullptr;
 
     // If there was an exception in one of the callbacks
-    if (parser->got_exception_)
+    if (ret.IsEmpty())
       return;
 
-    Local<Integer> nparsed_obj = Integer::New(env->isolate(), nparsed);
-    // If there was a parse error in one of the callbacks
-    // TODO(bnoordhuis) What if there is an error on EOF?
-    if (!parser->parser_.upgrade && nparsed != buffer_len) {
-      enum http_errno err = HTTP_PARSER_ERRNO(&parser->parser_);
+    args.GetReturnValue().Set(ret);
+  }
 
-      Local<Value> e = Exception::Error(env->parse_error_string());
-      Local<Object> obj = e->ToObject();
-      obj->Set(env->bytes_parsed_string(), nparsed_obj);
-      obj->Set(env->code_string(),
-               OneByteString(env->isolate(), http_errno_name(err)));
 
-      args.GetReturnValue().Set(e);
-    } else {
-      args.GetReturnValue().Set(nparsed_obj);
+  // Attaches the parser to a TCP, pipe or TTY handle that still has its
+  // default callbacks. Returns false if it can't.
+  static void Consume(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    CHECK_EQ(parser->stream_callbacks_, nullptr);
+    CHECK(args[0]->IsObject());
+
+    Local<Object> stream = args[0].As<Object>();
+    WITH_GENERIC_STREAM(env, stream, {
+      if (wrap->has_default_callbacks()) {
+        ParserStreamCallbacks* callbacks =
+            new ParserStreamCallbacks(parser, wrap->callbacks());
+        wrap->OverrideCallbacks(callbacks, false);
+        parser->stream_callbacks_ = callbacks;
+        return args.GetReturnValue().Set(true);
+      }
+    });
+
+    args.GetReturnValue().Set(false);
+  }
+
+
+  static void Unconsume(const FunctionCallbackInfo<Value>& args) {
+    Parser* parser = Unwrap<Parser>(args.Holder());
+    parser->Unconsume();
+  }
+
+
+  // Called by ParserStreamCallbacks with a read that the parser now owns.
+  void OnStreamRead(char* data, size_t length) {
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+    // Exceptions from the callbacks are reported as uncaught, like they would
+    // be from MakeCallback().
+    TryCatch try_catch;
+    try_catch.SetVerbose(true);
+
+    stream_data_ = data;
+    stream_data_len_ = length;
+
+    Local<Value> ret = Execute(data, length);
+    if (ret.IsEmpty()) {
+      current_buffer_.Clear();
+      free(stream_data_);
+      stream_data_ = nullptr;
+      return;
     }
+
+    // JS land needs the data for the body that follows an upgrade.
+    Local<Value> argv[3] = {
+      ret,
+      Integer::NewFromUnsigned(env()->isolate(), length),
+      Undefined(env()->isolate())
+    };
+    if (parser_.upgrade)
+      argv[2] = CurrentBuffer();
+
+    current_buffer_.Clear();
+    free(stream_data_);
+    stream_data_ = nullptr;
+
+    // The parser may be gone once this returns.
+    MakeCallback(env(), object(), kOnExecute, ARRAY_SIZE(argv), argv);
   }
 
 
@@ -470,6 +735,10 @@ class Parser : public BaseObject {
     Parser* parser = Unwrap<Parser>(args.Holder());
     // Should always be called from the same context.
     CHECK_EQ(env, parser->env());
+    // A new parser is reinitialized before its first use as well.
+    if (parser->in_use_)
+      parser_counters[kParsersReused]++;
+    parser->in_use_ = true;
     parser->Init(type);
   }
 
@@ -485,6 +754,76 @@ class Parser : public BaseObject {
 
 
  private:
+  friend class ParserStreamCallbacks;
+
+  // Returns the number of bytes parsed or an Error, or an empty handle if
+  // one of the callbacks threw.
+  Local<Value> Execute(char* data, size_t len) {
+    current_buffer_len_ = len;
+    current_buffer_data_ = data;
+    got_exception_ = false;
+
+    size_t nparsed = http_parser_execute(&parser_, &settings, data, len);
+
+    // The chunks before the end of the read or a parse error.
+    if (!got_exception_)
+      FlushBody();
+    num_bodies_ = 0;
+
+    // Stop here if what's left of the headers doesn't fit.  The parser won't
+    // look at the strings that still point into |data| after this.
+    if (!Save())
+      parser_.http_errno = HPE_HEADER_OVERFLOW;
+
+    current_buffer_len_ = 0;
+    current_buffer_data_ = nullptr;
+
+    // If there was an exception in one of the callbacks
+    if (got_exception_)
+      return Local<Value>();
+
+    Local<Integer> nparsed_obj = Integer::New(env()->isolate(), nparsed);
+    // If there was a parse error in one of the callbacks
+    // TODO(bnoordhuis) What if there is an error on EOF?
+    if (HTTP_PARSER_ERRNO(&parser_) == HPE_HEADER_OVERFLOW ||
+        (!parser_.upgrade && nparsed != len)) {
+      enum http_errno err = HTTP_PARSER_ERRNO(&parser_);
+      // The callbacks fail when the arena is full.
+      if (arena_.overflowed())
+        err = HPE_HEADER_OVERFLOW;
+
+      Local<Value> e = Exception::Error(env()->parse_error_string());
+      Local<Object> obj = e->ToObject();
+      obj->Set(env()->bytes_parsed_string(), nparsed_obj);
+      obj->Set(env()->code_string(),
+               OneByteString(env()->isolate(), http_errno_name(err)));
+
+      return e;
+    }
+
+    return nparsed_obj;
+  }
+
+
+  // Reads from a consumed stream are only turned into a Buffer when JS land
+  // needs to see them. The Buffer takes over the memory.
+  Local<Object> CurrentBuffer() {
+    if (current_buffer_.IsEmpty()) {
+      CHECK_NE(stream_data_, nullptr);
+      current_buffer_ = Buffer::Use(env(), stream_data_, stream_data_len_);
+      stream_data_ = nullptr;
+    }
+    return current_buffer_;
+  }
+
+
+  void Unconsume() {
+    if (stream_callbacks_ != nullptr) {
+      stream_callbacks_->parser_ = nullptr;
+      stream_callbacks_ = nullptr;
+    }
+  }
+
 
   Local<Array> CreateHeaders() {
     // num_values_ is either -1 or the entry # of the last header
@@ -529,8 +868,16 @@ class Parser : public BaseObject {
     http_parser_init(&parser_, type);
     url_.Reset();
     status_message_.Reset();
+    // Don't hold on to the copies of the last message's headers while the
+    // parser sits in the pool.
+    for (size_t i = 0; i < ARRAY_SIZE(fields_); i++) {
+      fields_[i].Reset();
+      values_[i].Reset();
+    }
+    arena_.Release();
     num_fields_ = 0;
     num_values_ = 0;
+    num_bodies_ = 0;
     have_flushed_ = false;
     got_exception_ = false;
   }
@@ -541,17 +888,45 @@ class Parser : public BaseObject {
   StringPtr values_[32];  // header values
   StringPtr url_;
   StringPtr status_message_;
+  HeaderArena arena_;
   int num_fields_;
   int num_values_;
+  size_t body_offsets_[32];  // chunks of the body in current_buffer_data_
+  size_t body_lengths_[32];
+  int num_bodies_;
   bool have_flushed_;
   bool got_exception_;
   Local<Object> current_buffer_;
   size_t current_buffer_len_;
   char* current_buffer_data_;
+  char* stream_data_;
+  size_t stream_data_len_;
+  ParserStreamCallbacks* stream_callbacks_;
+  bool in_use_;
   static const struct http_parser_settings settings;
 };
 
 
+ParserStreamCallbacks::~ParserStreamCallbacks() {
+  if (parser_ != nullptr)
+    parser_->stream_callbacks_ = nullptr;
+}
+
+
+void ParserStreamCallbacks::DoRead(uv_stream_t* handle,
+                                   ssize_t nread,
+                                   const uv_buf_t* buf,
+                                   uv_handle_type pending) {
+  // EOF, errors and reads after the parser let go take the usual route.
+  if (parser_ == nullptr || nread <= 0 || pending != UV_UNKNOWN_HANDLE)
+    return StreamWrapCallbacks::DoRead(handle, nread, buf, pending);
+
+  CHECK_LE(static_cast<size_t>(nread), buf->len);
+  char* base = static_cast<char*>(realloc(buf->base, nread));
+  parser_->OnStreamRead(base, nread);
+}
+
+
 const struct http_parser_settings Parser::settings = {
   Parser::on_message_begin,
   Parser::on_url,
@@ -564,6 +939,478 @@ const struct http_parser_settings Parser::settings = {
 };
 
 
+// Bits returned by serializeHeaders(), see OutgoingMessage#_storeHeader().
+#define HEADER_FLAGS(V)                                                       \
+  V(kSentConnectionHeader, 1 << 0)                                            \
+  V(kConnectionClose, 1 << 1)                                                 \
+  V(kConnectionKeepAlive, 1 << 2)                                             \
+  V(kSentTransferEncodingHeader, 1 << 3)                                      \
+  V(kChunkedEncoding, 1 << 4)                                                 \
+  V(kSentContentLengthHeader, 1 << 5)                                         \
+  V(kSentDateHeader, 1 << 6)                                                  \
+  V(kSentExpect, 1 << 7)
+
+enum HeaderFlags {
+#define V(name, value) name = value,
+  HEADER_FLAGS(V)
+#undef V
+};
+
+
+// Accumulates a header block.  The backing store is shared by all writers
+// and only ever grows, so serializing a response doesn't allocate anything
+// but the resulting string.
+class HeaderWriter {
+ public:
+  enum Status { kOk, kException, kNotOneByte };
+
+  HeaderWriter() : length_(0) {}
+
+  char* data() const { return pool_; }
+  size_t length() const { return length_; }
+
+  void Append(const char* s, size_t len) {
+    memcpy(Reserve(len), s, len);
+    length_ += len;
+  }
+
+  // Strings are copied as Latin-1.  Anything wider than that can't be
+  // represented in a one-byte string; the caller falls back to JS then.
+  Status Append(Local<Value> value) {
+    if (value.IsEmpty())
+      return kException;
+    Local<String> s = value->ToString();
+    if (s.IsEmpty())
+      return kException;
+    if (!s->IsOneByte() && !s->ContainsOnlyOneByte())
+      return kNotOneByte;
+    size_t len = s->Length();
+    uint8_t* dst = reinterpret_cast<uint8_t*>(Reserve(len));
+    s->WriteOneByte(dst, 0, len, String::NO_NULL_TERMINATION);
+    length_ += len;
+    return kOk;
+  }
+
+  // Protect against response splitting: drop every run of CR and LF along
+  // with any whitespace that follows it, same as value.replace() used to.
+  void StripLineBreaks(size_t start) {
+    char* s = pool_ + start;
+    char* end = pool_ + length_;
+    char* d = s;
+    while (s < end) {
+      if (*s != '\r' && *s != '\n') {
+        *d++ = *s++;
+        continue;
+      }
+      while (s < end && (*s == '\r' || *s == '\n'))
+        s++;
+      while (s < end && (*s == ' ' || *s == '\t'))
+        s++;
+    }
+    length_ = d - pool_;
+  }
+
+ private:
+  char* Reserve(size_t len) {
+    if (length_ + len > pool_size_) {
+      size_t size = pool_size_ > 0 ? pool_size_ : 4096;
+      while (size < length_ + len)
+        size *= 2;
+      pool_ = static_cast<char*>(realloc(pool_, size));
+      CHECK_NE(pool_, nullptr);
+      pool_size_ = size;
+    }
+    return pool_ + length_;
+  }
+
+  size_t length_;
+  static char* pool_;
+  static size_t pool_size_;
+};
+
+char* HeaderWriter::pool_;
+size_t HeaderWriter::pool_size_;
+
+
+static inline char LowerCase(char c) {
+  return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+
+// Case-insensitive substring search, the native version of /needle/i.
+// |needle| must be lower case.
+static bool ContainsToken(const char* s, size_t len, const char* needle) {
+  size_t needle_len = strlen(needle);
+  if (needle_len > len)
+    return false;
+  for (size_t i = 0; i <= len - needle_len; i++) {
+    size_t k = 0;
+    while (k < needle_len && LowerCase(s[i + k]) == needle[k])
+      k++;
+    if (k == needle_len)
+      return true;
+  }
+  return false;
+}
+
+
+static HeaderWriter::Status StoreHeader(HeaderWriter* writer,
+                                        Local<Value> field,
+                                        Local<Value> value,
+                                        int* flags) {
+  HeaderWriter::Status status;
+
+  size_t field_start = writer->length();
+  if ((status = writer->Append(field)) != HeaderWriter::kOk)
+    return status;
+  size_t field_len = writer->length() - field_start;
+  writer->Append(": ", 2);
+
+  size_t value_start = writer->length();
+  if ((status = writer->Append(value)) != HeaderWriter::kOk)
+    return status;
+  if (memchr(writer->data() + value_start, '\r',
+             writer->length() - value_start) != nullptr ||
+      memchr(writer->data() + value_start, '\n',
+             writer->length() - value_start) != nullptr) {
+    writer->StripLineBreaks(value_start);
+  }
+  size_t value_len = writer->length() - value_start;
+  writer->Append("\r\n", 2);
+
+  const char* f = writer->data() + field_start;
+  const char* v = writer->data() + value_start;
+  if (ContainsToken(f, field_len, "connection")) {
+    *flags |= kSentConnectionHeader;
+    if (ContainsToken(v, value_len, "close"))
+      *flags |= kConnectionClose;
+    else
+      *flags |= kConnectionKeepAlive;
+  } else if (ContainsToken(f, field_len, "transfer-encoding")) {
+    *flags |= kSentTransferEncodingHeader;
+    if (ContainsToken(v, value_len, "chunk"))
+      *flags |= kChunkedEncoding;
+  } else if (ContainsToken(f, field_len, "content-length")) {
+    *flags |= kSentContentLengthHeader;
+  } else if (ContainsToken(f, field_len, "date")) {
+    *flags |= kSentDateHeader;
+  } else if (ContainsToken(f, field_len, "expect")) {
+    *flags |= kSentExpect;
+  }
+
+  return HeaderWriter::kOk;
+}
+
+
+// Returns the "Date: ...\r\n" header line for the current time.  The line
+// is formatted at most once a second.
+static const char* DateLine(size_t* len) {
+  static const char days[][4] = {
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+  };
+  static const char months[][4] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+  };
+  static char line[] = "Date: Thu, 01 Jan 1970 00:00:00 GMT\r\n";
+  static time_t cached = 0;
+
+  time_t now = time(nullptr);
+  if (now != cached) {
+    struct tm tm;
+#ifdef _WIN32
+    gmtime_s(&tm, &now);
+#else
+    gmtime_r(&now, &tm);
+#endif
+    int year = tm.tm_year + 1900;
+    memcpy(line + 6, days[tm.tm_wday], 3);
+    line[11] = '0' + tm.tm_mday / 10;
+    line[12] = '0' + tm.tm_mday % 10;
+    memcpy(line + 14, months[tm.tm_mon], 3);
+    line[18] = '0' + year / 1000 % 10;
+    line[19] = '0' + year / 100 % 10;
+    line[20] = '0' + year / 10 % 10;
+    line[21] = '0' + year % 10;
+    line[23] = '0' + tm.tm_hour / 10;
+    line[24] = '0' + tm.tm_hour % 10;
+    line[26] = '0' + tm.tm_min / 10;
+    line[27] = '0' + tm.tm_min % 10;
+    line[29] = '0' + tm.tm_sec / 10;
+    line[30] = '0' + tm.tm_sec % 10;
+    cached = now;
+  }
+
+  *len = sizeof(line) - 1;
+  return line;
+}
+
+
+// flags = serializeHeaders(state, firstLine, headers, sendDate)
+//
+// Serializes the header block of an outgoing message into
+// state.messageHeader and returns a mask of HeaderFlags describing the
+// headers that were seen.  |headers| is either an object or an array of
+// [field, value] pairs; values may be arrays.  Returns undefined when the
+// block can't be represented as a one-byte string; the caller is expected
+// to build it in JS instead.
+static void SerializeHeaders(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  CHECK(args[0]->IsObject());
+  Local<Object> state = args[0].As<Object>();
+
+  HeaderWriter writer;
+  HeaderWriter::Status status = writer.Append(args[1]);
+  int flags = 0;
+
+  if (status == HeaderWriter::kOk && args[2]->IsObject()) {
+    Local<Object> headers = args[2].As<Object>();
+    bool is_array = headers->IsArray();
+    Local<Array> keys = headers->GetOwnPropertyNames();
+
+    for (uint32_t i = 0; status == HeaderWriter::kOk && i < keys->Length();
+         i++) {
+      Local<Value> field = keys->Get(i);
+      Local<Value> value = headers->Get(field);
+      if (value.IsEmpty())
+        return;
+      if (is_array) {
+        if (!value->IsObject())
+          return;
+        Local<Object> pair = value.As<Object>();
+        field = pair->Get(0);
+        value = pair->Get(1);
+        if (value.IsEmpty())
+          return;
+      }
+
+      if (value->IsArray()) {
+        Local<Array> values = value.As<Array>();
+        for (uint32_t k = 0; status == HeaderWriter::kOk &&
+             k < values->Length(); k++) {
+          status = StoreHeader(&writer, field, values->Get(k), &flags);
+        }
+      } else {
+        status = StoreHeader(&writer, field, value, &flags);
+      }
+    }
+  }
+
+  if (status != HeaderWriter::kOk)
+    return;
+
+  if (args[3]->IsTrue() && !(flags & kSentDateHeader)) {
+    size_t len;
+    const char* line = DateLine(&len);
+    writer.Append(line, len);
+  }
+
+  Local<String> header =
+      String::NewFromOneByte(env->isolate(),
+                             reinterpret_cast<uint8_t*>(writer.data()),
+                             String::kNormalString,
+                             writer.length());
+  state->Set(env->message_header_string(), header);
+  args.GetReturnValue().Set(flags);
+}
+
+
+// framed = frameChunk(buffer)
+//
+// Copies |buffer| into a new Buffer as one chunk of a chunked body: the size
+// line, the data and the CRLF after it.  One write instead of three for the
+// small chunks where the copy is cheaper than the writes.
+static void FrameChunk(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  CHECK(Buffer::HasInstance(args[0]));
+  const char* data = Buffer::Data(args[0]);
+  const size_t length = Buffer::Length(args[0]);
+
+  static const char hex[] = "0123456789abcdef";
+  char size_line[2 * sizeof(length) + 2];
+  char* p = size_line + sizeof(size_line);
+  *--p = '\n';
+  *--p = '\r';
+  size_t n = length;
+  do {
+    *--p = hex[n & 15];
+    n >>= 4;
+  } while (n != 0);
+  const size_t size_line_len = size_line + sizeof(size_line) - p;
+
+  Local<Object> framed = Buffer::New(env, size_line_len + length + 2);
+  char* w = Buffer::Data(framed);
+  memcpy(w, p, size_line_len);
+  memcpy(w + size_line_len, data, length);
+  memcpy(w + size_line_len + length, "\r\n", 2);
+  args.GetReturnValue().Set(framed);
+}
+
+
+// Offsets written by ParseUrl(), in the order url.js reads them.
+#define URL_OFFSETS(V)                                                        \
+  V(kUrlHostStart)                                                            \
+  V(kUrlHostEnd)                                                              \
+  V(kUrlPortEnd)                                                              \
+  V(kUrlPathEnd)                                                              \
+  V(kUrlQueryEnd)
+
+enum UrlOffset {
+#define V(name) name,
+  URL_OFFSETS(V)
+#undef V
+  kUrlOffsetCount
+};
+
+
+// Printable ASCII, minus the characters that url.parse() escapes.
+static inline bool IsPlainUrlChar(uint8_t c) {
+  if (c <= ' ' || c >= 0x7f)
+    return false;
+  switch (c) {
+    case '"': case '\'': case '<': case '>': case '\\':
+    case '^': case '`': case '{': case '|': case '}':
+      return false;
+  }
+  return true;
+}
+
+
+static inline bool IsHostnameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '_';
+}
+
+
+// Schemes that url.parse() expects to be followed by //host, see
+// slashedProtocol in lib/url.js.  file: is left out, it may have an empty
+// host.
+static bool IsSlashedScheme(const char* s, size_t len) {
+  static const char* const schemes[] = { "http", "https", "ftp", "gopher" };
+  for (size_t i = 0; i < ARRAY_SIZE(schemes); i++) {
+    if (strlen(schemes[i]) == len && strncasecmp(s, schemes[i], len) == 0)
+      return true;
+  }
+  return false;
+}
+
+
+// Host names that url.parse() leaves as they are, apart from lower-casing
+// them: no IPv6 literals, IDNs or labels that are too long.
+static bool IsPlainHostname(const char* s, size_t len) {
+  if (len == 0 || len > 255)
+    return false;
+  size_t label = 0;
+  for (size_t i = 0; i < len; i++) {
+    if (!IsHostnameChar(s[i]))
+      return false;
+    label = s[i] == '.' ? 0 : label + 1;
+    if (label > 63)
+      return false;
+  }
+  return true;
+}
+
+
+// Where ParseUrl() leaves its results, exposed to JS as urlOffsets.
+static int32_t url_offsets[kUrlOffsetCount];
+
+
+// ok = parseUrl(url)
+//
+// Splits |url| with http_parser_parse_url() and stores the UrlOffsets in
+// urlOffsets.  Only handles URLs that url.parse() takes apart without
+// rewriting anything, i.e. "scheme://host[:port]/path?query#hash" and
+// "/path?query#hash" made up of IsPlainUrlChar characters.  Returns false
+// for anything else; url.js falls back to its JS parser then.
+static void ParseUrl(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsString());
+  Local<String> url = args[0].As<String>();
+
+  args.GetReturnValue().Set(false);
+
+  char buf[2048];
+  const size_t len = url->Length();
+  if (len == 0 || len > sizeof(buf))
+    return;
+  if (!url->IsOneByte() && !url->ContainsOnlyOneByte())
+    return;
+  url->WriteOneByte(reinterpret_cast<uint8_t*>(buf),
+                    0,
+                    len,
+                    String::NO_NULL_TERMINATION);
+  for (size_t i = 0; i < len; i++) {
+    if (!IsPlainUrlChar(buf[i]))
+      return;
+  }
+
+  struct http_parser_url u;
+  if (http_parser_parse_url(buf, len, 0, &u) != 0)
+    return;
+  if (u.field_set & (1 << UF_USERINFO))
+    return;
+
+  size_t path_start;
+  if (u.field_set & (1 << UF_SCHEMA)) {
+    if (!(u.field_set & (1 << UF_HOST)))
+      return;
+    const size_t scheme_len = u.field_data[UF_SCHEMA].len;
+    const size_t host_start = u.field_data[UF_HOST].off;
+    const size_t host_end = host_start + u.field_data[UF_HOST].len;
+    if (!IsSlashedScheme(buf, scheme_len) ||
+        host_start != scheme_len + 3 ||
+        !IsPlainHostname(buf + host_start, host_end - host_start)) {
+      return;
+    }
+
+    size_t port_end = host_end;
+    if (u.field_set & (1 << UF_PORT)) {
+      if (u.field_data[UF_PORT].off != host_end + 1)
+        return;
+      port_end += 1 + u.field_data[UF_PORT].len;
+    }
+    // Only a path, query or hash may follow; url.parse() would treat an
+    // empty port as part of the host name, for example.
+    if (port_end < len &&
+        buf[port_end] != '/' && buf[port_end] != '?' && buf[port_end] != '#') {
+      return;
+    }
+
+    url_offsets[kUrlHostStart] = host_start;
+    url_offsets[kUrlHostEnd] = host_end;
+    url_offsets[kUrlPortEnd] = port_end;
+    path_start = port_end;
+  } else {
+    // A path on its own.  "//foo" is left to the JS parser, it may or may
+    // not be a host, depending on the arguments.
+    if (buf[0] != '/' || (len > 1 && buf[1] == '/'))
+      return;
+    url_offsets[kUrlHostStart] = -1;
+    url_offsets[kUrlHostEnd] = -1;
+    url_offsets[kUrlPortEnd] = -1;
+    path_start = 0;
+  }
+
+  // The query runs from the first '?' to the first '#', the hash from there
+  // to the end.  Both may be empty, which http_parser doesn't report.
+  size_t path_end = path_start;
+  while (path_end < len && buf[path_end] != '?' && buf[path_end] != '#')
+    path_end++;
+  size_t query_end = path_end;
+  if (query_end < len && buf[query_end] == '?') {
+    while (query_end < len && buf[query_end] != '#')
+      query_end++;
+  }
+  url_offsets[kUrlPathEnd] = path_end;
+  url_offsets[kUrlQueryEnd] = query_end;
+
+  args.GetReturnValue().Set(true);
+}
+
+
 void InitHttpParser(Handle<Object> target,
                     Handle<Value> unused,
                     Handle<Context> context,
@@ -585,6 +1432,8 @@ void InitHttpParser(Handle<Object> target,
          Integer::NewFromUnsigned(env->isolate(), kOnBody));
   t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnMessageComplete"),
          Integer::NewFromUnsigned(env->isolate(), kOnMessageComplete));
+  t->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kOnExecute"),
+         Integer::NewFromUnsigned(env->isolate(), kOnExecute));
 
   Local<Array> methods = Array::New(env->isolate());
 #define V(num, name, string)                                                  \
@@ -599,9 +1448,48 @@ void InitHttpParser(Handle<Object> target,
   env->SetProtoMethod(t, "reinitialize", Parser::Reinitialize);
   env->SetProtoMethod(t, "pause", Parser::Pause<true>);
   env->SetProtoMethod(t, "resume", Parser::Pause<false>);
+  env->SetProtoMethod(t, "consume", Parser::Consume);
+  env->SetProtoMethod(t, "unconsume", Parser::Unconsume);
 
   target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "HTTPParser"),
               t->GetFunction());
+
+  env->SetMethod(target, "serializeHeaders", SerializeHeaders);
+  env->SetMethod(target, "parseUrl", ParseUrl);
+  env->SetMethod(target, "frameChunk", FrameChunk);
+#define V(name, value)                                                        \
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                 \
+                Integer::New(env->isolate(), name));
+  HEADER_FLAGS(V)
+#undef V
+
+#define V(name)                                                               \
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                 \
+                Integer::New(env->isolate(), name));
+  URL_OFFSETS(V)
+#undef V
+
+  Local<Object> url_offsets_obj = Object::New(env->isolate());
+  url_offsets_obj->SetIndexedPropertiesToExternalArrayData(
+      url_offsets,
+      v8::kExternalInt32Array,
+      ARRAY_SIZE(url_offsets));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "urlOffsets"),
+              url_offsets_obj);
+
+#define V(name)                                                               \
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                 \
+                Integer::New(env->isolate(), name));
+  PARSER_COUNTERS(V)
+#undef V
+
+  Local<Object> parser_counters_obj = Object::New(env->isolate());
+  parser_counters_obj->SetIndexedPropertiesToExternalArrayData(
+      parser_counters,
+      v8::kExternalFloat64Array,
+      ARRAY_SIZE(parser_counters));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "parserCounters"),
+              parser_counters_obj);
 }
 
 }  // namespace node
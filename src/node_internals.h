@@ -125,6 +125,11 @@ void AppendExceptionLine(Environment* env,
 
 NO_RETURN void FatalError(const char* location, const char* message);
 
+// Folds |flags| into a hash of all the flags node has passed to V8.  Code
+// cache data is only valid for the flags it was produced with.
+void UpdateV8FlagsHash(const char* flags, size_t length);
+uint32_t V8FlagsHash();
+
 v8::Local<v8::Value> BuildStatsObject(Environment* env, const uv_stat_t* s);
 
 enum Endianness {
@@ -0,0 +1,580 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "node.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdlib.h>  // malloc(), free()
+#include <string.h>  // memcpy(), memmove()
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Native versions of querystring.parse() and querystring.stringify() for the
+// common case: the default separators and the default escape functions.
+// Both return undefined for input that they can't handle exactly like the JS
+// implementation, e.g. malformed percent-escapes, and lib/querystring.js
+// falls back to its JS code then.
+
+namespace node {
+namespace querystring {
+
+using v8::Array;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Handle;
+using v8::HandleScope;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+
+// Grows as needed; used for the copy of the input in Parse() and for the
+// output of Stringify().  Small strings stay on the stack.
+class ScratchBuffer {
+ public:
+  ScratchBuffer() : data_(stack_), length_(0), capacity_(sizeof(stack_)) {}
+
+  ~ScratchBuffer() {
+    if (data_ != stack_)
+      free(data_);
+  }
+
+  char* data() const { return data_; }
+  size_t length() const { return length_; }
+
+  char* Reserve(size_t len) {
+    if (length_ + len > capacity_) {
+      size_t capacity = capacity_;
+      while (capacity < length_ + len)
+        capacity *= 2;
+      char* data = static_cast<char*>(malloc(capacity));
+      CHECK_NE(data, nullptr);
+      memcpy(data, data_, length_);
+      if (data_ != stack_)
+        free(data_);
+      data_ = data;
+      capacity_ = capacity;
+    }
+    return data_ + length_;
+  }
+
+  void Append(char c) {
+    *Reserve(1) = c;
+    length_ += 1;
+  }
+
+  void Append(const char* s, size_t len) {
+    memcpy(Reserve(len), s, len);
+    length_ += len;
+  }
+
+  void SetLength(size_t len) {
+    CHECK_LE(len, capacity_);
+    length_ = len;
+  }
+
+ private:
+  char stack_[1024];
+  char* data_;
+  size_t length_;
+  size_t capacity_;
+};
+
+
+static inline int HexValue(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+
+// Returns the first byte in [p, end) that is |sep|, |eq|, '%' or '+', or
+// that isn't ASCII.  Most keys and values contain none of those, so they
+// are scanned 16 bytes at a time where SSE2 is available.
+static const char* FindSpecial(const char* p,
+                               const char* end,
+                               char sep,
+                               char eq) {
+#if defined(__SSE2__)
+  const __m128i vsep = _mm_set1_epi8(sep);
+  const __m128i veq = _mm_set1_epi8(eq);
+  const __m128i vpct = _mm_set1_epi8('%');
+  const __m128i vplus = _mm_set1_epi8('+');
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i m = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, vsep), _mm_cmpeq_epi8(v, veq)),
+        _mm_or_si128(_mm_cmpeq_epi8(v, vpct), _mm_cmpeq_epi8(v, vplus)));
+    // The sign bits of |v| itself flag the non-ASCII bytes.
+    int mask = _mm_movemask_epi8(_mm_or_si128(m, v));
+    if (mask != 0)
+      return p + __builtin_ctz(mask);
+    p += 16;
+  }
+#endif
+  while (p < end) {
+    char c = *p;
+    if (c == sep || c == eq || c == '%' || c == '+' || (c & 0x80))
+      return p;
+    p++;
+  }
+  return end;
+}
+
+
+// Checks that [p, end) is UTF-8 that decodeURIComponent() accepts: no
+// overlong forms, no surrogates, nothing above U+10FFFF.
+static bool IsValidUtf8(const uint8_t* p, const uint8_t* end) {
+  while (p < end) {
+    uint8_t c = *p++;
+    if (c < 0x80)
+      continue;
+
+    size_t n;
+    uint8_t lo = 0x80;
+    uint8_t hi = 0xbf;
+    if (c >= 0xc2 && c <= 0xdf) {
+      n = 1;
+    } else if (c >= 0xe0 && c <= 0xef) {
+      n = 2;
+      if (c == 0xe0)
+        lo = 0xa0;
+      else if (c == 0xed)
+        hi = 0x9f;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+      n = 3;
+      if (c == 0xf0)
+        lo = 0x90;
+      else if (c == 0xf4)
+        hi = 0x8f;
+    } else {
+      return false;
+    }
+
+    if (static_cast<size_t>(end - p) < n)
+      return false;
+    if (*p < lo || *p > hi)
+      return false;
+    for (size_t i = 1; i < n; i++) {
+      if ((p[i] & 0xc0) != 0x80)
+        return false;
+    }
+    p += n;
+  }
+  return true;
+}
+
+
+// Decodes '+' and percent-escapes in [start, end) in place, stopping at the
+// first |sep|, or at the first |eq| when |stop_at_eq| is set.  Stores the
+// end of the decoded bytes in |*out| and returns where decoding stopped, or
+// nullptr when the input isn't something decodeURIComponent() accepts.
+static char* DecodeInPlace(char* start,
+                           char* end,
+                           char sep,
+                           char eq,
+                           bool stop_at_eq,
+                           bool* non_ascii,
+                           char** out) {
+  char* r = start;
+  char* w = start;
+
+  for (;;) {
+    char* special = const_cast<char*>(FindSpecial(r, end, sep, eq));
+    if (w != r)
+      memmove(w, r, special - r);
+    w += special - r;
+    r = special;
+
+    if (r == end || *r == sep || (*r == eq && stop_at_eq))
+      break;
+
+    char c = *r;
+    if (c == '+') {
+      *w++ = ' ';
+      r++;
+    } else if (c == '%') {
+      if (end - r < 3)
+        return nullptr;
+      int hi = HexValue(r[1]);
+      int lo = HexValue(r[2]);
+      if (hi == -1 || lo == -1)
+        return nullptr;
+      *w = static_cast<char>(hi * 16 + lo);
+      if (*w & 0x80)
+        *non_ascii = true;
+      w++;
+      r += 3;
+    } else if (c & 0x80) {
+      // Left to the JS code, together with the rest of the input.
+      return nullptr;
+    } else {
+      // An |eq| in a value is just a character.
+      *w++ = *r++;
+    }
+  }
+
+  *out = w;
+  return r;
+}
+
+
+static Local<String> MakeString(Environment* env,
+                                const char* data,
+                                size_t len,
+                                bool non_ascii,
+                                String::NewStringType type) {
+  if (non_ascii)
+    return String::NewFromUtf8(env->isolate(), data, type, len);
+  return String::NewFromOneByte(env->isolate(),
+                                reinterpret_cast<const uint8_t*>(data),
+                                type,
+                                len);
+}
+
+
+// obj = parse(qs, sepCode, eqCode, maxKeys)
+static void Parse(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  CHECK(args[0]->IsString());
+  Local<String> qs = args[0].As<String>();
+  const uint32_t sep_code = args[1]->Uint32Value();
+  const uint32_t eq_code = args[2]->Uint32Value();
+  const double max_keys = args[3]->NumberValue();
+
+  if (sep_code >= 0x80 || eq_code >= 0x80)
+    return;
+  // The JS code replaces '+' before it looks for |eq|.
+  if (eq_code == '+' || eq_code == '%')
+    return;
+  if (!qs->IsOneByte() && !qs->ContainsOnlyOneByte())
+    return;
+
+  const char sep = static_cast<char>(sep_code);
+  const char eq = static_cast<char>(eq_code);
+  const size_t len = qs->Length();
+
+  ScratchBuffer buf;
+  qs->WriteOneByte(reinterpret_cast<uint8_t*>(buf.Reserve(len)),
+                   0,
+                   len,
+                   String::NO_NULL_TERMINATION);
+  buf.SetLength(len);
+
+  Local<Object> obj = Object::New(env->isolate());
+  char* p = buf.data();
+  char* const end = p + len;
+
+  // Like qs.split(sep): n separators make n + 1 pairs, empty ones included.
+  for (uint32_t keys = 0; !(max_keys > 0) || keys < max_keys; keys++) {
+    bool key_non_ascii = false;
+    bool value_non_ascii = false;
+    char* key_start = p;
+    char* key_end;
+    char* value_start;
+    char* value_end;
+
+    p = DecodeInPlace(p, end, sep, eq, true, &key_non_ascii, &key_end);
+    if (p == nullptr)
+      return;
+
+    // Stopped at |eq|; when |sep| and |eq| are the same, it's a |sep|.
+    if (p < end && *p != sep) {
+      value_start = p + 1;
+      p = DecodeInPlace(value_start,
+                        end,
+                        sep,
+                        eq,
+                        false,
+                        &value_non_ascii,
+                        &value_end);
+      if (p == nullptr)
+        return;
+    } else {
+      value_start = value_end = p;
+    }
+
+    if (key_non_ascii &&
+        !IsValidUtf8(reinterpret_cast<uint8_t*>(key_start),
+                     reinterpret_cast<uint8_t*>(key_end))) {
+      return;
+    }
+    if (value_non_ascii &&
+        !IsValidUtf8(reinterpret_cast<uint8_t*>(value_start),
+                     reinterpret_cast<uint8_t*>(value_end))) {
+      return;
+    }
+
+    Local<String> key = MakeString(env,
+                                   key_start,
+                                   key_end - key_start,
+                                   key_non_ascii,
+                                   String::kInternalizedString);
+    Local<String> value = MakeString(env,
+                                     value_start,
+                                     value_end - value_start,
+                                     value_non_ascii,
+                                     String::kNormalString);
+
+    if (!obj->HasOwnProperty(key)) {
+      obj->Set(key, value);
+    } else {
+      Local<Value> existing = obj->Get(key);
+      if (existing->IsArray()) {
+        Local<Array> values = existing.As<Array>();
+        values->Set(values->Length(), value);
+      } else {
+        Local<Array> values = Array::New(env->isolate(), 2);
+        values->Set(0, existing);
+        values->Set(1, value);
+        obj->Set(key, values);
+      }
+    }
+
+    if (p == end)
+      break;
+    p++;  // Skip |sep|.
+  }
+
+  args.GetReturnValue().Set(obj);
+}
+
+
+// Characters that encodeURIComponent() leaves alone.
+static inline bool IsUnreserved(uint16_t c) {
+  if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+      (c >= '0' && c <= '9')) {
+    return true;
+  }
+  switch (c) {
+    case '-': case '_': case '.': case '!': case '~':
+    case '*': case '\'': case '(': case ')':
+      return true;
+  }
+  return false;
+}
+
+
+static inline void AppendEscaped(ScratchBuffer* out, uint8_t c) {
+  static const char hex[] = "0123456789ABCDEF";
+  char* w = out->Reserve(3);
+  w[0] = '%';
+  w[1] = hex[c >> 4];
+  w[2] = hex[c & 15];
+  out->SetLength(out->length() + 3);
+}
+
+
+// The equivalent of encodeURIComponent(s).  Returns false for unpaired
+// surrogates, which make encodeURIComponent() throw.
+static bool AppendEncoded(ScratchBuffer* out, Local<String> s) {
+  const int len = s->Length();
+
+  if (s->IsOneByte()) {
+    uint8_t stack[256];
+    uint8_t* data = len <= static_cast<int>(sizeof(stack)) ?
+        stack : static_cast<uint8_t*>(malloc(len));
+    CHECK_NE(data, nullptr);
+    s->WriteOneByte(data, 0, len, String::NO_NULL_TERMINATION);
+    for (int i = 0; i < len; i++) {
+      uint8_t c = data[i];
+      if (IsUnreserved(c)) {
+        out->Append(static_cast<char>(c));
+      } else if (c < 0x80) {
+        AppendEscaped(out, c);
+      } else {
+        AppendEscaped(out, 0xc0 | (c >> 6));
+        AppendEscaped(out, 0x80 | (c & 0x3f));
+      }
+    }
+    if (data != stack)
+      free(data);
+    return true;
+  }
+
+  String::Value value(s);
+  const uint16_t* data = *value;
+  for (int i = 0; i < len; i++) {
+    uint32_t c = data[i];
+    if (c < 0x80) {
+      if (IsUnreserved(c))
+        out->Append(static_cast<char>(c));
+      else
+        AppendEscaped(out, c);
+    } else if (c < 0x800) {
+      AppendEscaped(out, 0xc0 | (c >> 6));
+      AppendEscaped(out, 0x80 | (c & 0x3f));
+    } else if (c < 0xd800 || c > 0xdfff) {
+      AppendEscaped(out, 0xe0 | (c >> 12));
+      AppendEscaped(out, 0x80 | ((c >> 6) & 0x3f));
+      AppendEscaped(out, 0x80 | (c & 0x3f));
+    } else {
+      if (c > 0xdbff || i + 1 == len)
+        return false;
+      uint32_t c2 = data[i + 1];
+      if (c2 < 0xdc00 || c2 > 0xdfff)
+        return false;
+      c = 0x10000 + ((c - 0xd800) << 10) + (c2 - 0xdc00);
+      i++;
+      AppendEscaped(out, 0xf0 | (c >> 18));
+      AppendEscaped(out, 0x80 | ((c >> 12) & 0x3f));
+      AppendEscaped(out, 0x80 | ((c >> 6) & 0x3f));
+      AppendEscaped(out, 0x80 | (c & 0x3f));
+    }
+  }
+  return true;
+}
+
+
+enum StringifyStatus { kStringifyOk, kStringifyException, kStringifyBail };
+
+
+// Appends encodeURIComponent(stringifyPrimitive(v)).
+static StringifyStatus AppendPrimitive(ScratchBuffer* out, Local<Value> v) {
+  if (v.IsEmpty())
+    return kStringifyException;
+
+  if (v->IsString())
+    return AppendEncoded(out, v.As<String>()) ? kStringifyOk : kStringifyBail;
+
+  if (v->IsBoolean()) {
+    if (v->IsTrue())
+      out->Append("true", 4);
+    else
+      out->Append("false", 5);
+  } else if (v->IsNumber()) {
+    // NaN and the infinities come out as ''.
+    double d = v->NumberValue();
+    if (d - d == 0) {
+      Local<String> s = v->ToString();
+      if (s.IsEmpty())
+        return kStringifyException;
+      return AppendEncoded(out, s) ? kStringifyOk : kStringifyBail;
+    }
+  }
+
+  return kStringifyOk;
+}
+
+
+// str = stringify(obj, sep, eq)
+static void Stringify(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args.GetIsolate());
+  HandleScope scope(env->isolate());
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsString());
+  CHECK(args[2]->IsString());
+
+  Local<Object> obj = args[0].As<Object>();
+  Local<String> sep_string = args[1].As<String>();
+  Local<String> eq_string = args[2].As<String>();
+  if (!sep_string->IsOneByte() || !eq_string->IsOneByte())
+    return;
+
+  char sep[16];
+  char eq[16];
+  const int sep_len = sep_string->Length();
+  const int eq_len = eq_string->Length();
+  if (sep_len > static_cast<int>(sizeof(sep)) ||
+      eq_len > static_cast<int>(sizeof(eq))) {
+    return;
+  }
+  sep_string->WriteOneByte(reinterpret_cast<uint8_t*>(sep),
+                           0,
+                           sep_len,
+                           String::NO_NULL_TERMINATION);
+  eq_string->WriteOneByte(reinterpret_cast<uint8_t*>(eq),
+                          0,
+                          eq_len,
+                          String::NO_NULL_TERMINATION);
+
+  ScratchBuffer out;
+  Local<Array> keys = obj->GetOwnPropertyNames();
+  bool first = true;
+
+  for (uint32_t i = 0; i < keys->Length(); i++) {
+    Local<Value> key = keys->Get(i);
+    if (key.IsEmpty())
+      return;
+    Local<String> key_string = key->ToString();
+    if (key_string.IsEmpty())
+      return;
+    Local<Value> value = obj->Get(key);
+    if (value.IsEmpty())
+      return;
+
+    Local<Array> values;
+    uint32_t count = 1;
+    if (value->IsArray()) {
+      values = value.As<Array>();
+      count = values->Length();
+    }
+
+    for (uint32_t k = 0; k < count; k++) {
+      if (!first)
+        out.Append(sep, sep_len);
+      first = false;
+
+      if (!AppendEncoded(&out, key_string))
+        return;
+      out.Append(eq, eq_len);
+
+      Local<Value> v = values.IsEmpty() ? value : values->Get(k);
+      if (AppendPrimitive(&out, v) != kStringifyOk)
+        return;
+    }
+  }
+
+  Local<String> result =
+      String::NewFromOneByte(env->isolate(),
+                             reinterpret_cast<const uint8_t*>(out.data()),
+                             String::kNormalString,
+                             out.length());
+  args.GetReturnValue().Set(result);
+}
+
+
+void Initialize(Handle<Object> target,
+                Handle<Value> unused,
+                Handle<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "parse", Parse);
+  env->SetMethod(target, "stringify", Stringify);
+}
+
+}  // namespace querystring
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(querystring, node::querystring::Initialize)
@@ -20,6 +20,7 @@
 // USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "node.h"
+#include "node_internals.h"
 #include "env.h"
 #include "env-inl.h"
 #include "util.h"
@@ -209,6 +210,7 @@ void StopGarbageCollectionTracking(const FunctionCallbackInfo<Value>& args) {
 void SetFlagsFromString(const FunctionCallbackInfo<Value>& args) {
   String::Utf8Value flags(args[0]);
   V8::SetFlagsFromString(*flags, flags.length());
+  UpdateV8FlagsHash(*flags, flags.length());
 }
 
 
@@ -97,12 +97,15 @@ void PipeWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "readStart", StreamWrap::ReadStart);
   env->SetProtoMethod(t, "readStop", StreamWrap::ReadStop);
   env->SetProtoMethod(t, "shutdown", StreamWrap::Shutdown);
+  env->SetProtoMethod(t, "setIdleTimeout", StreamWrap::SetIdleTimeout);
 
   env->SetProtoMethod(t, "writeBuffer", StreamWrap::WriteBuffer);
   env->SetProtoMethod(t, "writeAsciiString", StreamWrap::WriteAsciiString);
   env->SetProtoMethod(t, "writeUtf8String", StreamWrap::WriteUtf8String);
   env->SetProtoMethod(t, "writeUcs2String", StreamWrap::WriteUcs2String);
   env->SetProtoMethod(t, "writeBinaryString", StreamWrap::WriteBinaryString);
+  env->SetProtoMethod(t, "writev", StreamWrap::Writev);
+  env->SetProtoMethod(t, "writeUtf8Frame", StreamWrap::WriteUtf8Frame);
 
   env->SetProtoMethod(t, "bind", Bind);
   env->SetProtoMethod(t, "listen", Listen);
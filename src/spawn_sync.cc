@@ -47,50 +47,73 @@ using v8::Value;
 
 
 SyncProcessOutputBuffer::SyncProcessOutputBuffer()
-    : used_(0),
-      next_(nullptr) {
+    : data_(nullptr),
+      capacity_(0),
+      used_(0) {
 }
 
 
-void SyncProcessOutputBuffer::OnAlloc(size_t suggested_size,
-                                      uv_buf_t* buf) const {
-  if (used() == kBufferSize)
-    *buf = uv_buf_init(nullptr, 0);
-  else
-    *buf = uv_buf_init(data_ + used(), available());
+SyncProcessOutputBuffer::~SyncProcessOutputBuffer() {
+  free(data_);
 }
 
 
-void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
-  // If we hand out the same chunk twice, this should catch it.
-  CHECK_EQ(buf->base, data_ + used());
-  used_ += static_cast<unsigned int>(nread);
-}
+void SyncProcessOutputBuffer::OnAlloc(size_t limit, uv_buf_t* buf) {
+  // Never grow past `limit`, but always allow at least one full read.
+  if (limit < kMinReadSize)
+    limit = kMinReadSize;
 
+  if (capacity_ - used_ < kMinReadSize && capacity_ < limit) {
+    size_t capacity = capacity_ > 0 ? capacity_ * 2 : kMinReadSize;
+    if (capacity < used_ + kMinReadSize)
+      capacity = used_ + kMinReadSize;
+    if (capacity > limit)
+      capacity = limit;
 
-size_t SyncProcessOutputBuffer::Copy(char* dest) const {
-  memcpy(dest, data_, used());
-  return used();
+    // realloc() of a large block is usually an mremap() rather than a copy.
+    char* data = static_cast<char*>(realloc(data_, capacity));
+    if (data != nullptr) {
+      data_ = data;
+      capacity_ = capacity;
+    }
+  }
+
+  // A zero-sized buffer makes libuv report UV_ENOBUFS, which stops the read.
+  if (used_ == capacity_)
+    *buf = uv_buf_init(nullptr, 0);
+  else
+    *buf = uv_buf_init(data_ + used_,
+                       static_cast<unsigned int>(capacity_ - used_));
 }
 
 
-unsigned int SyncProcessOutputBuffer::available() const {
-  return sizeof data_ - used();
+void SyncProcessOutputBuffer::OnRead(const uv_buf_t* buf, size_t nread) {
+  // If we hand out the same chunk twice, this should catch it.
+  CHECK_EQ(buf->base, data_ + used_);
+  used_ += nread;
 }
 
 
-unsigned int SyncProcessOutputBuffer::used() const {
-  return used_;
-}
+char* SyncProcessOutputBuffer::Release() {
+  char* data = data_;
+
+  // Don't keep up to half of the region around for the life of the Buffer.
+  if (used_ < capacity_) {
+    char* shrunk = static_cast<char*>(realloc(data, used_));
+    if (shrunk != nullptr)
+      data = shrunk;
+  }
 
+  data_ = nullptr;
+  capacity_ = 0;
+  used_ = 0;
 
-SyncProcessOutputBuffer* SyncProcessOutputBuffer::next() const {
-  return next_;
+  return data;
 }
 
 
-void SyncProcessOutputBuffer::set_next(SyncProcessOutputBuffer* next) {
-  next_ = next;
+size_t SyncProcessOutputBuffer::used() const {
+  return used_;
 }
 
 
@@ -103,8 +126,7 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
       writable_(writable),
       input_buffer_(input_buffer),
 
-      first_output_buffer_(nullptr),
-      last_output_buffer_(nullptr),
+      output_buffer_(),
 
       uv_pipe_(),
       write_req_(),
@@ -117,14 +139,6 @@ SyncProcessStdioPipe::SyncProcessStdioPipe(SyncProcessRunner* process_handler,
 
 SyncProcessStdioPipe::~SyncProcessStdioPipe() {
   CHECK(lifecycle_ == kUninitialized || lifecycle_ == kClosed);
-
-  SyncProcessOutputBuffer* buf;
-  SyncProcessOutputBuffer* next;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = next) {
-    next = buf->next();
-    delete buf;
-  }
 }
 
 
@@ -186,11 +200,17 @@ void SyncProcessStdioPipe::Close() {
 }
 
 
-Local<Object> SyncProcessStdioPipe::GetOutputAsBuffer() const {
-  size_t length = OutputLength();
-  Local<Object> js_buffer = Buffer::New(length);
-  CopyOutput(Buffer::Data(js_buffer));
-  return js_buffer;
+Local<Object> SyncProcessStdioPipe::GetOutputAsBuffer() {
+  Environment* env = process_handler_->env();
+  size_t length = output_buffer_.used();
+
+  if (length == 0)
+    return Buffer::New(env, 0);
+
+  // The Buffer takes ownership of the memory, no copy is made.
+  return Buffer::Use(env,
+                     output_buffer_.Release(),
+                     static_cast<uint32_t>(length));
 }
 
 
@@ -233,45 +253,21 @@ uv_handle_t* SyncProcessStdioPipe::uv_handle() const {
 }
 
 
-size_t SyncProcessStdioPipe::OutputLength() const {
-  SyncProcessOutputBuffer* buf;
-  size_t size = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    size += buf->used();
-
-  return size;
-}
-
-
-void SyncProcessStdioPipe::CopyOutput(char* dest) const {
-  SyncProcessOutputBuffer* buf;
-  size_t offset = 0;
-
-  for (buf = first_output_buffer_; buf != nullptr; buf = buf->next())
-    offset += buf->Copy(dest + offset);
-}
-
-
 void SyncProcessStdioPipe::OnAlloc(size_t suggested_size, uv_buf_t* buf) {
   // This function assumes that libuv will never allocate two buffers for the
   // same stream at the same time. There's an assert in
   // SyncProcessOutputBuffer::OnRead that would fail if this assumption was
   // ever violated.
 
-  if (last_output_buffer_ == nullptr) {
-    // Allocate the first capture buffer.
-    first_output_buffer_ = new SyncProcessOutputBuffer();
-    last_output_buffer_ = first_output_buffer_;
-
-  } else if (last_output_buffer_->available() == 0) {
-    // The current capture buffer is full so get us a new one.
-    SyncProcessOutputBuffer* buf = new SyncProcessOutputBuffer();
-    last_output_buffer_->set_next(buf);
-    last_output_buffer_ = buf;
+  // Reading one byte past maxBuffer is enough to detect the overflow, there
+  // is no point in growing the region much further than that.
+  size_t limit = Buffer::kMaxLength;
+  if (process_handler_->max_buffer_ > 0 &&
+      process_handler_->max_buffer_ < limit) {
+    limit = process_handler_->max_buffer_ + 1;
   }
 
-  last_output_buffer_->OnAlloc(suggested_size, buf);
+  output_buffer_.OnAlloc(limit, buf);
 }
 
 
@@ -279,13 +275,20 @@ void SyncProcessStdioPipe::OnRead(const uv_buf_t* buf, ssize_t nread) {
   if (nread == UV_EOF) {
     // Libuv implicitly stops reading on EOF.
 
+  } else if (nread == UV_ENOBUFS) {
+    // The output doesn't fit in a Buffer.  Treat it like a maxBuffer overflow
+    // rather than leave the child blocked on a pipe that nobody reads.
+    uv_read_stop(uv_stream());
+    process_handler_->SetError(UV_ENOBUFS);
+    process_handler_->Kill();
+
   } else if (nread < 0) {
     SetError(static_cast<int>(nread));
     // At some point libuv should really implicitly stop reading on error.
     uv_read_stop(uv_stream());
 
   } else {
-    last_output_buffer_->OnRead(buf, nread);
+    output_buffer_.OnRead(buf, nread);
     process_handler_->IncrementBufferSizeAndCheckOverflow(nread);
   }
 }
@@ -736,7 +739,7 @@ int SyncProcessRunner::ParseOptions(Local<Value> js_value) {
     r = CopyJsStringArray(js_env_pairs, &env_buffer_);
     if (r < 0)
       return r;
-    uv_process_options_.args = reinterpret_cast<char**>(env_buffer_);
+    uv_process_options_.env = reinterpret_cast<char**>(env_buffer_);
   }
 
   Local<Value> js_uid = js_options->Get(env()->uid_string());
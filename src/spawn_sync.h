@@ -47,29 +47,28 @@ class SyncProcessStdioPipe;
 class SyncProcessRunner;
 
 
+// Collects the output of one pipe in a single malloc'd region that grows
+// geometrically.  Once the child is done the region is handed to a Buffer
+// as-is, so the output is never copied after the read that filled it.
 class SyncProcessOutputBuffer {
-  static const unsigned int kBufferSize = 65536;
+  static const size_t kMinReadSize = 65536;
 
  public:
   inline SyncProcessOutputBuffer();
+  inline ~SyncProcessOutputBuffer();
 
-  inline void OnAlloc(size_t suggested_size, uv_buf_t* buf) const;
+  inline void OnAlloc(size_t limit, uv_buf_t* buf);
   inline void OnRead(const uv_buf_t* buf, size_t nread);
 
-  inline size_t Copy(char* dest) const;
+  // Gives up ownership of the data; the caller must free() it.
+  inline char* Release();
 
-  inline unsigned int available() const;
-  inline unsigned int used() const;
-
-  inline SyncProcessOutputBuffer* next() const;
-  inline void set_next(SyncProcessOutputBuffer* next);
+  inline size_t used() const;
 
  private:
-  // Use unsigned int because that's what `uv_buf_init` takes.
-  mutable char data_[kBufferSize];
-  unsigned int used_;
-
-  SyncProcessOutputBuffer* next_;
+  char* data_;
+  size_t capacity_;
+  size_t used_;
 };
 
 
@@ -93,7 +92,7 @@ class SyncProcessStdioPipe {
   int Start();
   void Close();
 
-  Local<Object> GetOutputAsBuffer() const;
+  Local<Object> GetOutputAsBuffer();
 
   inline bool readable() const;
   inline bool writable() const;
@@ -104,9 +103,6 @@ class SyncProcessStdioPipe {
   inline uv_handle_t* uv_handle() const;
 
  private:
-  inline size_t OutputLength() const;
-  inline void CopyOutput(char* dest) const;
-
   inline void OnAlloc(size_t suggested_size, uv_buf_t* buf);
   inline void OnRead(const uv_buf_t* buf, ssize_t nread);
   inline void OnWriteDone(int result);
@@ -131,8 +127,7 @@ class SyncProcessStdioPipe {
   bool writable_;
   uv_buf_t input_buffer_;
 
-  SyncProcessOutputBuffer* first_output_buffer_;
-  SyncProcessOutputBuffer* last_output_buffer_;
+  SyncProcessOutputBuffer output_buffer_;
 
   mutable uv_pipe_t uv_pipe_;
   uv_write_t write_req_;
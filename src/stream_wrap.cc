@@ -64,7 +64,11 @@ StreamWrap::StreamWrap(Environment* env,
       stream_(stream),
       default_callbacks_(this),
       callbacks_(&default_callbacks_),
-      callbacks_gc_(false) {
+      callbacks_gc_(false),
+      idle_timeout_(0),
+      idle_time_(0),
+      idle_list_(nullptr) {
+  QUEUE_INIT(&idle_queue_);
 }
 
 
@@ -146,6 +150,8 @@ void StreamWrap::OnReadCommon(uv_stream_t* handle,
   // uv_close() on the handle.
   CHECK_EQ(wrap->persistent().IsEmpty(), false);
 
+  wrap->UpdateIdleTime();
+
   if (nread > 0) {
     if (wrap->is_tcp()) {
       NODE_COUNT_NET_BYTES_RECV(nread);
@@ -191,6 +197,8 @@ void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
   if (!IsAlive(wrap))
     return args.GetReturnValue().Set(UV_EINVAL);
 
+  wrap->UpdateIdleTime();
+
   CHECK(args[0]->IsObject());
   CHECK(Buffer::HasInstance(args[1]));
 
@@ -243,7 +251,25 @@ void StreamWrap::WriteBuffer(const FunctionCallbackInfo<Value>& args) {
 }
 
 
-template <enum encoding encoding>
+// Writes the little-endian frame header that child_process.js expects in
+// front of a binary IPC message that carries no out-of-band buffers:
+// the size of the rest of the frame, the JSON length and a buffer count of 0.
+static void WriteIPCFrameHeader(char* dst, size_t json_size) {
+  const uint32_t fields[] = {
+    static_cast<uint32_t>(json_size + 8),
+    static_cast<uint32_t>(json_size),
+    0
+  };
+  for (size_t i = 0; i < ARRAY_SIZE(fields); i++) {
+    dst[4 * i + 0] = fields[i] & 0xff;
+    dst[4 * i + 1] = (fields[i] >> 8) & 0xff;
+    dst[4 * i + 2] = (fields[i] >> 16) & 0xff;
+    dst[4 * i + 3] = (fields[i] >> 24) & 0xff;
+  }
+}
+
+
+template <enum encoding encoding, bool framed>
 void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   int err;
@@ -252,6 +278,8 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
   if (!IsAlive(wrap))
     return args.GetReturnValue().Set(UV_EINVAL);
 
+  wrap->UpdateIdleTime();
+
   CHECK(args[0]->IsObject());
   CHECK(args[1]->IsString());
 
@@ -267,6 +295,9 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
   else
     storage_size = StringBytes::StorageSize(env->isolate(), string, encoding);
 
+  const size_t header_size = framed ? kIPCFrameHeaderSize : 0;
+  storage_size += header_size;
+
   if (storage_size > INT_MAX) {
     args.GetReturnValue().Set(UV_ENOBUFS);
     return;
@@ -283,11 +314,13 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
   bool try_write = storage_size + 15 <= sizeof(stack_storage) &&
                    (!wrap->is_named_pipe_ipc() || !args[2]->IsObject());
   if (try_write) {
-    data_size = StringBytes::Write(env->isolate(),
-                                   stack_storage,
-                                   storage_size,
-                                   string,
-                                   encoding);
+    data_size = header_size + StringBytes::Write(env->isolate(),
+                                                 stack_storage + header_size,
+                                                 storage_size - header_size,
+                                                 string,
+                                                 encoding);
+    if (framed)
+      WriteIPCFrameHeader(stack_storage, data_size - header_size);
     buf = uv_buf_init(stack_storage, data_size);
 
     uv_buf_t* bufs = &buf;
@@ -318,11 +351,13 @@ void StreamWrap::WriteStringImpl(const FunctionCallbackInfo<Value>& args) {
     data_size = buf.len;
   } else {
     // Write it
-    data_size = StringBytes::Write(env->isolate(),
-                                   data,
-                                   storage_size,
-                                   string,
-                                   encoding);
+    data_size = header_size + StringBytes::Write(env->isolate(),
+                                                 data + header_size,
+                                                 storage_size - header_size,
+                                                 string,
+                                                 encoding);
+    if (framed)
+      WriteIPCFrameHeader(data, data_size - header_size);
   }
 
   CHECK_LE(data_size, storage_size);
@@ -383,6 +418,8 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
   if (!IsAlive(wrap))
     return args.GetReturnValue().Set(UV_EINVAL);
 
+  wrap->UpdateIdleTime();
+
   CHECK(args[0]->IsObject());
   CHECK(args[1]->IsArray());
 
@@ -461,11 +498,24 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
     bytes += str_size;
   }
 
-  int err = wrap->callbacks()->DoWrite(req_wrap,
-                                       bufs,
-                                       count,
-                                       nullptr,
-                                       StreamWrap::AfterWrite);
+  uv_handle_t* send_handle = nullptr;
+
+  if (wrap->is_named_pipe_ipc() && args[2]->IsObject()) {
+    Local<Object> send_handle_obj = args[2].As<Object>();
+    HandleWrap* handle_wrap = Unwrap<HandleWrap>(send_handle_obj);
+    send_handle = handle_wrap->GetHandle();
+    // Reference StreamWrap instance to prevent it from being garbage
+    // collected before `AfterWrite` is called.
+    CHECK_EQ(false, req_wrap->persistent().IsEmpty());
+    req_wrap->object()->Set(env->handle_string(), send_handle_obj);
+  }
+
+  int err = wrap->callbacks()->DoWrite(
+      req_wrap,
+      bufs,
+      count,
+      reinterpret_cast<uv_stream_t*>(send_handle),
+      StreamWrap::AfterWrite);
 
   // Deallocate space
   if (bufs != bufs_)
@@ -491,21 +541,26 @@ void StreamWrap::Writev(const FunctionCallbackInfo<Value>& args) {
 
 
 void StreamWrap::WriteAsciiString(const FunctionCallbackInfo<Value>& args) {
-  WriteStringImpl<ASCII>(args);
+  WriteStringImpl<ASCII, false>(args);
 }
 
 
 void StreamWrap::WriteUtf8String(const FunctionCallbackInfo<Value>& args) {
-  WriteStringImpl<UTF8>(args);
+  WriteStringImpl<UTF8, false>(args);
+}
+
+
+void StreamWrap::WriteUtf8Frame(const FunctionCallbackInfo<Value>& args) {
+  WriteStringImpl<UTF8, true>(args);
 }
 
 
 void StreamWrap::WriteUcs2String(const FunctionCallbackInfo<Value>& args) {
-  WriteStringImpl<UCS2>(args);
+  WriteStringImpl<UCS2, false>(args);
 }
 
 void StreamWrap::WriteBinaryString(const FunctionCallbackInfo<Value>& args) {
-  WriteStringImpl<BINARY>(args);
+  WriteStringImpl<BINARY, false>(args);
 }
 
 void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
@@ -517,6 +572,158 @@ void StreamWrap::SetBlocking(const FunctionCallbackInfo<Value>& args) {
   args.GetReturnValue().Set(err);
 }
 
+// Lower bound on the time between two sweeps of the idle lists, so that
+// streams with staggered deadlines expire in batches instead of one timer
+// callback each.
+static const uint64_t kIdleSweepInterval = 50;
+
+
+// Streams with the same idle timeout share a list.  A stream moves to the
+// tail of its list on every read or write, so each list is in deadline order
+// and a sweep only looks at the streams that are due.
+struct StreamWrap::IdleList {
+  uint64_t timeout;
+  QUEUE streams;
+  QUEUE member;  // in Environment::stream_idle_queue()
+};
+
+
+inline void StreamWrap::UpdateIdleTime() {
+  if (idle_timeout_ == 0)
+    return;
+  // The loop time of the current tick is good enough here, it is refreshed
+  // by SetIdleTimeout() and before every sweep.
+  idle_time_ = uv_now(env()->event_loop());
+  if (QUEUE_EMPTY(&idle_queue_)) {
+    // Its timeout fired and took it off its list, start over.
+    ArmIdleTimeout();
+  } else {
+    QUEUE_REMOVE(&idle_queue_);
+    QUEUE_INSERT_TAIL(&idle_list_->streams, &idle_queue_);
+  }
+}
+
+
+void StreamWrap::SetIdleTimeout(const FunctionCallbackInfo<Value>& args) {
+  StreamWrap* wrap = Unwrap<StreamWrap>(args.Holder());
+  if (!IsAlive(wrap))
+    return args.GetReturnValue().Set(UV_EINVAL);
+
+  int64_t timeout = args[0]->IntegerValue();
+
+  QUEUE_REMOVE(&wrap->idle_queue_);
+  QUEUE_INIT(&wrap->idle_queue_);
+  wrap->idle_timeout_ = timeout > 0 ? timeout : 0;
+
+  if (wrap->idle_timeout_ != 0) {
+    // The loop time is stale when JS has been running for a while, before
+    // the first tick in particular.  Update it like Timer.now() does.
+    uv_loop_t* loop = wrap->env()->event_loop();
+    uv_update_time(loop);
+    wrap->idle_time_ = uv_now(loop);
+    wrap->ArmIdleTimeout();
+  }
+
+  args.GetReturnValue().Set(0);
+}
+
+
+void StreamWrap::ArmIdleTimeout() {
+  QUEUE* queue = env()->stream_idle_queue();
+  IdleList* list = nullptr;
+  QUEUE* q;
+  QUEUE_FOREACH(q, queue) {
+    IdleList* l = ContainerOf(&IdleList::member, q);
+    if (l->timeout == idle_timeout_) {
+      list = l;
+      break;
+    }
+  }
+
+  if (list == nullptr) {
+    list = new IdleList;
+    list->timeout = idle_timeout_;
+    QUEUE_INIT(&list->streams);
+    QUEUE_INSERT_TAIL(queue, &list->member);
+  }
+
+  idle_list_ = list;
+  QUEUE_INSERT_TAIL(&list->streams, &idle_queue_);
+  ScheduleIdleSweep(env(), idle_time_ + idle_timeout_);
+}
+
+
+void StreamWrap::ScheduleIdleSweep(Environment* env, uint64_t when) {
+  uv_timer_t* timer = env->stream_idle_timer_handle();
+  if (uv_is_active(reinterpret_cast<uv_handle_t*>(timer)) &&
+      env->stream_idle_sweep_time() <= when) {
+    return;
+  }
+
+  uint64_t now = uv_now(env->event_loop());
+  env->set_stream_idle_sweep_time(when);
+  uv_timer_start(timer, OnIdleSweep, when > now ? when - now : 0, 0);
+}
+
+
+void StreamWrap::OnIdleSweep(uv_timer_t* handle) {
+  Environment* env = Environment::from_stream_idle_timer_handle(handle);
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  uv_loop_t* loop = env->event_loop();
+  uv_update_time(loop);
+  uint64_t now = uv_now(loop);
+  uint64_t next = 0;
+  QUEUE expired;
+  QUEUE_INIT(&expired);
+
+  // Collect the expired streams first, their ontimeout callbacks are free
+  // to close streams or to change timeouts.
+  QUEUE* queue = env->stream_idle_queue();
+  QUEUE* lq = QUEUE_HEAD(queue);
+  while (lq != queue) {
+    IdleList* list = ContainerOf(&IdleList::member, lq);
+    lq = QUEUE_NEXT(lq);
+
+    while (!QUEUE_EMPTY(&list->streams)) {
+      QUEUE* q = QUEUE_HEAD(&list->streams);
+      StreamWrap* wrap = ContainerOf(&StreamWrap::idle_queue_, q);
+      uint64_t deadline = wrap->idle_time_ + list->timeout;
+      if (deadline > now) {
+        if (next == 0 || deadline < next)
+          next = deadline;
+        break;
+      }
+      QUEUE_REMOVE(q);
+      QUEUE_INSERT_TAIL(&expired, q);
+    }
+
+    if (QUEUE_EMPTY(&list->streams)) {
+      QUEUE_REMOVE(&list->member);
+      delete list;
+    }
+  }
+
+  // A stream stays off its list until its next read or write, which is
+  // when net.Socket would have put it back on its timer list.
+  while (!QUEUE_EMPTY(&expired)) {
+    QUEUE* q = QUEUE_HEAD(&expired);
+    QUEUE_REMOVE(q);
+    QUEUE_INIT(q);
+    StreamWrap* wrap = ContainerOf(&StreamWrap::idle_queue_, q);
+    if (IsAlive(wrap))
+      wrap->MakeCallback(env->ontimeout_string(), 0, nullptr);
+  }
+
+  if (next != 0) {
+    if (next < now + kIdleSweepInterval)
+      next = now + kIdleSweepInterval;
+    ScheduleIdleSweep(env, next);
+  }
+}
+
+
 void StreamWrap::AfterWrite(uv_write_t* req, int status) {
   WriteWrap* req_wrap = ContainerOf(&WriteWrap::req_, req);
   StreamWrap* wrap = req_wrap->wrap();
@@ -529,6 +736,8 @@ void StreamWrap::AfterWrite(uv_write_t* req, int status) {
   CHECK_EQ(req_wrap->persistent().IsEmpty(), false);
   CHECK_EQ(wrap->persistent().IsEmpty(), false);
 
+  wrap->UpdateIdleTime();
+
   // Unref handle property
   Local<Object> req_wrap_obj = req_wrap->object();
   req_wrap_obj->Delete(env->handle_string());
@@ -113,6 +113,10 @@ class StreamWrap : public HandleWrap {
       delete old;
   }
 
+  inline bool has_default_callbacks() const {
+    return callbacks_ == &default_callbacks_;
+  }
+
   static void GetFD(v8::Local<v8::String>,
                     const v8::PropertyCallbackInfo<v8::Value>&);
 
@@ -125,11 +129,15 @@ class StreamWrap : public HandleWrap {
   static void WriteBuffer(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void WriteAsciiString(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void WriteUtf8String(const v8::FunctionCallbackInfo<v8::Value>& args);
+  // Like WriteUtf8String but prefixes the string with the frame header of a
+  // binary serialization IPC message, see lib/child_process.js.
+  static void WriteUtf8Frame(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void WriteUcs2String(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void WriteBinaryString(
       const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static void SetBlocking(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetIdleTimeout(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   inline StreamWrapCallbacks* callbacks() const {
     return callbacks_;
@@ -165,11 +173,14 @@ class StreamWrap : public HandleWrap {
       delete callbacks_;
     }
     callbacks_ = nullptr;
+    QUEUE_REMOVE(&idle_queue_);
   }
 
   void StateChange() { }
   void UpdateWriteQueueSize();
 
+  inline void UpdateIdleTime();
+
  private:
   // Callbacks for libuv
   static void AfterWrite(uv_write_t* req, int status);
@@ -186,14 +197,30 @@ class StreamWrap : public HandleWrap {
                            const uv_buf_t* buf,
                            uv_handle_type pending);
 
-  template <enum encoding encoding>
+  static const size_t kIPCFrameHeaderSize = 12;
+
+  template <enum encoding encoding, bool framed>
   static void WriteStringImpl(const v8::FunctionCallbackInfo<v8::Value>& args);
 
+  struct IdleList;
+
+  void ArmIdleTimeout();
+  static void ScheduleIdleSweep(Environment* env, uint64_t when);
+  static void OnIdleSweep(uv_timer_t* handle);
+
   uv_stream_t* const stream_;
   StreamWrapCallbacks default_callbacks_;
   StreamWrapCallbacks* callbacks_;  // Overridable callbacks
   bool callbacks_gc_;
 
+  // Idle timeout in milliseconds, 0 when disabled, and the loop time of the
+  // last read or write. While armed, the stream is on idle_list_, one of the
+  // lists in the environment's stream_idle_queue().
+  uint64_t idle_timeout_;
+  uint64_t idle_time_;
+  IdleList* idle_list_;
+  QUEUE idle_queue_;
+
   friend class StreamWrapCallbacks;
 };
 
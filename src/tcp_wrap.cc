@@ -104,6 +104,7 @@ void TCPWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "readStart", StreamWrap::ReadStart);
   env->SetProtoMethod(t, "readStop", StreamWrap::ReadStop);
   env->SetProtoMethod(t, "shutdown", StreamWrap::Shutdown);
+  env->SetProtoMethod(t, "setIdleTimeout", StreamWrap::SetIdleTimeout);
 
   env->SetProtoMethod(t, "writeBuffer", StreamWrap::WriteBuffer);
   env->SetProtoMethod(t, "writeAsciiString", StreamWrap::WriteAsciiString);
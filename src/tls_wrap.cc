@@ -82,6 +82,10 @@ TLSCallbacks::TLSCallbacks(Environment* env,
   QUEUE_INIT(&write_item_queue_);
   QUEUE_INIT(&pending_write_items_);
 
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  sni_map_ = nullptr;
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+
   // We've our own session callbacks
   SSL_CTX_sess_set_get_cb(sc_->ctx_, SSLWrap<TLSCallbacks>::GetSessionCallback);
   SSL_CTX_sess_set_new_cb(sc_->ctx_, SSLWrap<TLSCallbacks>::NewSessionCallback);
@@ -102,6 +106,8 @@ TLSCallbacks::~TLSCallbacks() {
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   sni_context_.Reset();
+  sni_map_ = nullptr;
+  sni_map_handle_.Reset();
 #endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
 
   // Move all writes to pending
@@ -711,6 +717,23 @@ void TLSCallbacks::EnableHelloParser(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TLSCallbacks::SetSNIContextMap(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  TLSCallbacks* wrap = Unwrap<TLSCallbacks>(args.Holder());
+
+  Local<FunctionTemplate> cons = env->sni_context_map_constructor_template();
+  if (args.Length() < 1 || !cons->HasInstance(args[0]))
+    return env->ThrowTypeError("First argument should be a SNIContextMap");
+
+#ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+  Local<Object> map = args[0].As<Object>();
+  wrap->sni_map_ = Unwrap<SNIContextMap>(map);
+  wrap->sni_map_handle_.Reset(env->isolate(), map);
+#endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
+}
+
+
 void TLSCallbacks::OnClientHelloParseEnd(void* arg) {
   TLSCallbacks* c = static_cast<TLSCallbacks*>(arg);
   c->Cycle();
@@ -768,6 +791,13 @@ int TLSCallbacks::SelectSNIContextCallback(SSL* s, int* ad, void* arg) {
   Local<Object> object = p->object();
   Local<Value> ctx = object->Get(env->sni_context_string());
 
+  // Nothing picked in JS, try the contexts added with `server.addContext()`
+  if (!ctx->IsObject() && p->sni_map_ != nullptr) {
+    Local<Object> match = p->sni_map_->Lookup(servername);
+    if (!match.IsEmpty())
+      ctx = match;
+  }
+
   // Not an object, probably undefined or null
   if (!ctx->IsObject())
     return SSL_TLSEXT_ERR_NOACK;
@@ -807,6 +837,7 @@ void TLSCallbacks::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "setVerifyMode", SetVerifyMode);
   env->SetProtoMethod(t, "enableSessionCallbacks", EnableSessionCallbacks);
   env->SetProtoMethod(t, "enableHelloParser", EnableHelloParser);
+  env->SetProtoMethod(t, "setSNIContextMap", SetSNIContextMap);
 
   SSLWrap<TLSCallbacks>::AddMethods(env, t);
 
@@ -816,6 +847,312 @@ void TLSCallbacks::Initialize(Handle<Object> target,
 #endif  // SSL_CRT_SET_TLSEXT_SERVERNAME_CB
 
   env->set_tls_wrap_constructor_function(t->GetFunction());
+
+  SNIContextMap::Initialize(env, target);
+}
+
+
+static inline char ToLower(char c) {
+  return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+
+SNIContextMap::~SNIContextMap() {
+  FreeChildren(&root_);
+}
+
+
+void SNIContextMap::Initialize(Environment* env, Handle<Object> target) {
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "add", Add);
+  env->SetProtoMethod(t, "lookup", Lookup);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "SNIContextMap"),
+              t->GetFunction());
+  env->set_sni_context_map_constructor_template(t);
+}
+
+
+void SNIContextMap::New(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  new SNIContextMap(env, args.This());
+}
+
+
+// map.add(pattern, secureContext)
+//
+// Adding a pattern that is already in the map is a no-op: like the JS
+// SNICallback, the first context added for a pattern wins.
+void SNIContextMap::Add(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SNIContextMap* map = Unwrap<SNIContextMap>(args.Holder());
+
+  if (args.Length() < 1 || !args[0]->IsString())
+    return env->ThrowTypeError("First argument should be a string");
+
+  Local<FunctionTemplate> cons = env->secure_context_constructor_template();
+  if (args.Length() < 2 || !cons->HasInstance(args[1]))
+    return env->ThrowTypeError("Second argument should be a SecureContext");
+
+  node::Utf8Value pattern(args[0]);
+  if (pattern.length() == 0)
+    return env->ThrowTypeError("Pattern must not be empty");
+
+  char* name = *pattern;
+  size_t len = pattern.length();
+  for (size_t i = 0; i < len; i++)
+    name[i] = ToLower(name[i]);
+
+  // Walk the labels right to left, creating nodes as we go
+  Node* parent = &map->root_;
+  Node* node = nullptr;
+  for (;;) {
+    size_t start = len;
+    while (start > 0 && name[start - 1] != '.')
+      start--;
+
+    const char* label = name + start;
+    size_t label_len = len - start;
+    uint32_t hash = HashLabel(label, label_len);
+    node = FindChild(parent, label, label_len, hash);
+
+    if (node == nullptr) {
+      node = new Node();
+      node->label = new char[label_len + 1];
+      memcpy(node->label, label, label_len);
+      node->label[label_len] = '\0';
+      node->label_len = label_len;
+      node->hash = hash;
+      AddChild(parent, node);
+    }
+
+    if (start == 0)
+      break;
+    parent = node;
+    len = start - 1;
+  }
+
+  if (node->seq == 0) {
+    node->seq = ++map->seq_;
+    node->context.Reset(env->isolate(), args[1].As<Object>());
+  }
+}
+
+
+// map.lookup(servername)
+void SNIContextMap::Lookup(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  SNIContextMap* map = Unwrap<SNIContextMap>(args.Holder());
+
+  if (args.Length() < 1 || !args[0]->IsString())
+    return env->ThrowTypeError("First argument should be a string");
+
+  node::Utf8Value servername(args[0]);
+  Local<Object> ctx = map->Lookup(*servername);
+  if (!ctx.IsEmpty())
+    args.GetReturnValue().Set(ctx);
+}
+
+
+Local<Object> SNIContextMap::Lookup(const char* servername) {
+  char name[256];
+  size_t len = strlen(servername);
+
+  // Longer than any valid DNS name, treat it as a miss
+  if (len == 0 || len >= sizeof(name))
+    return Local<Object>();
+
+  for (size_t i = 0; i < len; i++)
+    name[i] = ToLower(servername[i]);
+
+  Node* best = nullptr;
+  Find(&root_, name, len, &best);
+  if (best == nullptr)
+    return Local<Object>();
+  return PersistentToLocal(env()->isolate(), best->context);
+}
+
+
+// FNV-1a
+uint32_t SNIContextMap::HashLabel(const char* label, size_t label_len) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < label_len; i++) {
+    hash ^= static_cast<unsigned char>(label[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+
+// Returns the child of |parent| whose label is exactly |label|, glob or not.
+SNIContextMap::Node* SNIContextMap::FindChild(Node* parent,
+                                              const char* label,
+                                              size_t label_len,
+                                              uint32_t hash) {
+  if (memchr(label, '*', label_len) == nullptr)
+    return FindExact(parent, label, label_len, hash);
+
+  for (Node* node = parent->globs; node != nullptr; node = node->next) {
+    if (node->label_len == label_len &&
+        memcmp(node->label, label, label_len) == 0) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+
+SNIContextMap::Node* SNIContextMap::FindExact(Node* parent,
+                                              const char* label,
+                                              size_t label_len,
+                                              uint32_t hash) {
+  if (parent->bucket_count == 0)
+    return nullptr;
+
+  Node* node = parent->buckets[hash & (parent->bucket_count - 1)];
+  for (; node != nullptr; node = node->next) {
+    if (node->hash == hash &&
+        node->label_len == label_len &&
+        memcmp(node->label, label, label_len) == 0) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+
+void SNIContextMap::AddChild(Node* parent, Node* child) {
+  if (memchr(child->label, '*', child->label_len) != nullptr) {
+    child->next = parent->globs;
+    parent->globs = child;
+    return;
+  }
+
+  // Keep the load factor at or below one, the bucket count a power of two
+  if (parent->child_count >= parent->bucket_count) {
+    size_t count = parent->bucket_count == 0 ? 4 : parent->bucket_count * 2;
+    Node** buckets = new Node*[count]();
+    for (size_t i = 0; i < parent->bucket_count; i++) {
+      Node* node = parent->buckets[i];
+      while (node != nullptr) {
+        Node* next = node->next;
+        Node** bucket = &buckets[node->hash & (count - 1)];
+        node->next = *bucket;
+        *bucket = node;
+        node = next;
+      }
+    }
+    delete[] parent->buckets;
+    parent->buckets = buckets;
+    parent->bucket_count = count;
+  }
+
+  Node** bucket = &parent->buckets[child->hash & (parent->bucket_count - 1)];
+  child->next = *bucket;
+  *bucket = child;
+  parent->child_count++;
+}
+
+
+// Matches the last label of |name| against the children of |parent| and
+// recurses into every matching child, keeping the earliest added pattern
+// that covers all of |name|.  Only the glob children need to be scanned,
+// exact labels are a single hash table probe.
+void SNIContextMap::Find(Node* parent,
+                         const char* name,
+                         size_t len,
+                         Node** best) {
+  size_t start = len;
+  while (start > 0 && name[start - 1] != '.')
+    start--;
+
+  const char* label = name + start;
+  size_t label_len = len - start;
+  Node* exact =
+      FindExact(parent, label, label_len, HashLabel(label, label_len));
+  if (exact != nullptr)
+    Descend(exact, name, start, best);
+
+  for (Node* glob = parent->globs; glob != nullptr; glob = glob->next) {
+    if (MatchLabel(glob->label, glob->label_len, label, label_len))
+      Descend(glob, name, start, best);
+  }
+}
+
+
+// |node| matched the label of |name| that starts at |start|.
+void SNIContextMap::Descend(Node* node,
+                            const char* name,
+                            size_t start,
+                            Node** best) {
+  if (start != 0) {
+    Find(node, name, start - 1, best);
+  } else if (node->seq != 0 && (*best == nullptr ||
+                                node->seq < (*best)->seq)) {
+    *best = node;
+  }
+}
+
+
+bool SNIContextMap::MatchLabel(const char* pattern,
+                               size_t pattern_len,
+                               const char* label,
+                               size_t label_len) {
+  while (pattern_len > 0) {
+    if (*pattern == '*') {
+      // Collapse runs of `*`, then try every possible tail of the label
+      while (pattern_len > 0 && *pattern == '*') {
+        pattern++;
+        pattern_len--;
+      }
+      if (pattern_len == 0)
+        return true;
+      for (size_t i = 0; i <= label_len; i++) {
+        if (MatchLabel(pattern, pattern_len, label + i, label_len - i))
+          return true;
+      }
+      return false;
+    }
+
+    if (label_len == 0 || *pattern != *label)
+      return false;
+    pattern++;
+    pattern_len--;
+    label++;
+    label_len--;
+  }
+  return label_len == 0;
+}
+
+
+void SNIContextMap::FreeChildren(Node* parent) {
+  for (size_t i = 0; i < parent->bucket_count; i++) {
+    Node* node = parent->buckets[i];
+    while (node != nullptr) {
+      Node* next = node->next;
+      FreeChildren(node);
+      node->context.Reset();
+      delete[] node->label;
+      delete node;
+      node = next;
+    }
+  }
+  delete[] parent->buckets;
+  parent->buckets = nullptr;
+  parent->bucket_count = 0;
+  parent->child_count = 0;
+
+  while (parent->globs != nullptr) {
+    Node* next = parent->globs->next;
+    FreeChildren(parent->globs);
+    parent->globs->context.Reset();
+    delete[] parent->globs->label;
+    delete parent->globs;
+    parent->globs = next;
+  }
 }
 
 }  // namespace node
@@ -26,6 +26,7 @@
 #include "node_crypto.h"  // SSLWrap
 
 #include "async-wrap.h"
+#include "base-object.h"
 #include "env.h"
 #include "queue.h"
 #include "stream_wrap.h"
@@ -42,6 +43,73 @@ namespace crypto {
   class SecureContext;
 }
 
+// Hostname -> SecureContext map backing `server.addContext()`.  Patterns are
+// stored in a trie keyed by DNS labels, right to left, so that the servername
+// callback can pick the context during the handshake without calling into JS.
+// Plain labels are kept in a hash table per node, so a lookup costs one probe
+// per label no matter how many hosts are configured; the few labels with a
+// `*`, which matches any run of characters within a single label, are tried
+// one by one.  When several patterns match, the one added first wins.
+class SNIContextMap : public BaseObject {
+ public:
+  ~SNIContextMap() override;
+
+  static void Initialize(Environment* env, v8::Handle<v8::Object> target);
+
+  // Returns an empty handle if no pattern matches |servername|.
+  v8::Local<v8::Object> Lookup(const char* servername);
+
+ protected:
+  struct Node {
+    char* label;
+    size_t label_len;
+    uint32_t hash;
+    unsigned int seq;  // Insertion order of the pattern ending here, 0 if none
+    v8::Persistent<v8::Object> context;
+    Node** buckets;  // Children without a `*`, chained through |next|
+    size_t bucket_count;
+    size_t child_count;
+    Node* globs;  // Children with a `*`, chained through |next|
+    Node* next;
+  };
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Add(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Lookup(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  static bool MatchLabel(const char* pattern,
+                         size_t pattern_len,
+                         const char* label,
+                         size_t label_len);
+  static uint32_t HashLabel(const char* label, size_t label_len);
+  static Node* FindChild(Node* parent,
+                         const char* label,
+                         size_t label_len,
+                         uint32_t hash);
+  static Node* FindExact(Node* parent,
+                         const char* label,
+                         size_t label_len,
+                         uint32_t hash);
+  static void AddChild(Node* parent, Node* child);
+  static void Find(Node* parent, const char* name, size_t len, Node** best);
+  static void Descend(Node* node,
+                      const char* name,
+                      size_t start,
+                      Node** best);
+  static void FreeChildren(Node* parent);
+
+  SNIContextMap(Environment* env, v8::Local<v8::Object> wrap)
+      : BaseObject(env, wrap),
+        root_(),
+        seq_(0) {
+    MakeWeak<SNIContextMap>(this);
+  }
+
+ private:
+  Node root_;
+  unsigned int seq_;
+};
+
 class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
                      public StreamWrapCallbacks,
                      public AsyncWrap {
@@ -137,6 +205,8 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void EnableHelloParser(
       const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetSNIContextMap(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   static void GetServername(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -166,6 +236,8 @@ class TLSCallbacks : public crypto::SSLWrap<TLSCallbacks>,
 
 #ifdef SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
   v8::Persistent<v8::Value> sni_context_;
+  SNIContextMap* sni_map_;
+  v8::Persistent<v8::Object> sni_map_handle_;
 #endif  // SSL_CTRL_SET_TLSEXT_SERVERNAME_CB
 };
 
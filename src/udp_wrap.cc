@@ -33,6 +33,7 @@
 
 namespace node {
 
+using v8::Array;
 using v8::Context;
 using v8::Function;
 using v8::FunctionCallbackInfo;
@@ -45,6 +46,7 @@ using v8::Object;
 using v8::PropertyAttribute;
 using v8::PropertyCallbackInfo;
 using v8::String;
+using v8::True;
 using v8::Uint32;
 using v8::Undefined;
 using v8::Value;
@@ -76,12 +78,22 @@ UDPWrap::UDPWrap(Environment* env, Handle<Object> object)
     : HandleWrap(env,
                  object,
                  reinterpret_cast<uv_handle_t*>(&handle_),
-                 AsyncWrap::PROVIDER_UDPWRAP) {
+                 AsyncWrap::PROVIDER_UDPWRAP),
+      recv_buffer_(nullptr),
+      recv_buffer_size_(0),
+      recv_batch_(false),
+      recv_batch_count_(0) {
   int r = uv_udp_init(env->event_loop(), &handle_);
   CHECK_EQ(r, 0);  // can't fail anyway
 }
 
 
+UDPWrap::~UDPWrap() {
+  free(recv_buffer_);
+  recv_buffer_ = nullptr;
+}
+
+
 void UDPWrap::Initialize(Handle<Object> target,
                          Handle<Value> unused,
                          Handle<Context> context) {
@@ -104,6 +116,8 @@ void UDPWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "send", Send);
   env->SetProtoMethod(t, "bind6", Bind6);
   env->SetProtoMethod(t, "send6", Send6);
+  env->SetProtoMethod(t, "sendBatch", SendBatch);
+  env->SetProtoMethod(t, "sendBatch6", SendBatch6);
   env->SetProtoMethod(t, "close", Close);
   env->SetProtoMethod(t, "recvStart", RecvStart);
   env->SetProtoMethod(t, "recvStop", RecvStop);
@@ -114,6 +128,7 @@ void UDPWrap::Initialize(Handle<Object> target,
   env->SetProtoMethod(t, "setMulticastLoopback", SetMulticastLoopback);
   env->SetProtoMethod(t, "setBroadcast", SetBroadcast);
   env->SetProtoMethod(t, "setTTL", SetTTL);
+  env->SetProtoMethod(t, "setRecvBatch", SetRecvBatch);
 
   env->SetProtoMethod(t, "ref", HandleWrap::Ref);
   env->SetProtoMethod(t, "unref", HandleWrap::Unref);
@@ -201,6 +216,19 @@ X(SetMulticastLoopback, uv_udp_set_multicast_loop)
 #undef X
 
 
+// Receive up to kRecvBatchSize datagrams per system call and deliver them
+// to JS in one onmessages() call.  Fails with UV_ENOSYS where libuv can't
+// do that, the socket keeps working one datagram at a time then.
+void UDPWrap::SetRecvBatch(const FunctionCallbackInfo<Value>& args) {
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+  bool on = args[0]->BooleanValue();
+  int err = uv_udp_set_recvmmsg(&wrap->handle_, on);
+  if (err == 0)
+    wrap->recv_batch_ = on;
+  args.GetReturnValue().Set(err);
+}
+
+
 void UDPWrap::SetMembership(const FunctionCallbackInfo<Value>& args,
                             uv_membership membership) {
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
@@ -303,6 +331,141 @@ void UDPWrap::Send6(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// sendBatch(req, list, hasCallback), where list is [buffer, port, address,
+// buffer, port, address, ...].  Runs of datagrams to the same destination
+// that are all as long as the first, save for a shorter last one, go out as
+// one request through uv_udp_send_segments().  Everything else, and
+// everything on platforms without it, gets a request per datagram.  All
+// requests share req, which calls oncomplete() for each of them when
+// hasCallback is true.  req.pending is set to the number of requests started.
+void UDPWrap::DoSendBatch(const FunctionCallbackInfo<Value>& args,
+                          int family) {
+  Environment* env = Environment::GetCurrent(args);
+
+  UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
+
+  CHECK(args[0]->IsObject());
+  CHECK(args[1]->IsArray());
+  CHECK(args[2]->IsBoolean());
+
+  Local<Object> req_wrap_obj = args[0].As<Object>();
+  Local<Array> list = args[1].As<Array>();
+  const bool have_callback = args[2]->IsTrue();
+  const uint32_t count = list->Length() / 3;
+
+  uv_buf_t bufs[UV_UDP_SEGMENTS_MAX];
+  char addr[sizeof(sockaddr_in6)];
+  bool segments = true;
+  uint32_t pending = 0;
+  int err = 0;
+
+  for (uint32_t i = 0; i < count && err == 0;) {
+    Local<Value> buffer_obj = list->Get(i * 3);
+    Local<Value> port_obj = list->Get(i * 3 + 1);
+    Local<Value> address_obj = list->Get(i * 3 + 2);
+    CHECK(Buffer::HasInstance(buffer_obj));
+    CHECK(port_obj->IsUint32());
+    CHECK(address_obj->IsString());
+
+    const unsigned short port = port_obj->Uint32Value();
+    node::Utf8Value address(address_obj);
+
+    switch (family) {
+    case AF_INET:
+      err = uv_ip4_addr(*address, port, reinterpret_cast<sockaddr_in*>(&addr));
+      break;
+    case AF_INET6:
+      err = uv_ip6_addr(*address,
+                        port,
+                        reinterpret_cast<sockaddr_in6*>(&addr));
+      break;
+    default:
+      CHECK(0 && "unexpected address family");
+      abort();
+    }
+
+    if (err)
+      break;
+
+    size_t nbufs = 0;
+    size_t total = Buffer::Length(buffer_obj);
+    bufs[nbufs++] = uv_buf_init(Buffer::Data(buffer_obj), total);
+    i++;
+
+    while (segments &&
+           bufs[0].len > 0 &&
+           i < count &&
+           nbufs < UV_UDP_SEGMENTS_MAX &&
+           bufs[nbufs - 1].len == bufs[0].len) {
+      Local<Value> next_obj = list->Get(i * 3);
+      CHECK(Buffer::HasInstance(next_obj));
+      size_t length = Buffer::Length(next_obj);
+      if (length == 0 ||
+          length > bufs[0].len ||
+          total + length > UV_UDP_SEGMENTS_MAXSIZE ||
+          list->Get(i * 3 + 1)->Uint32Value() != port ||
+          !list->Get(i * 3 + 2)->StrictEquals(address_obj)) {
+        break;
+      }
+      bufs[nbufs++] = uv_buf_init(Buffer::Data(next_obj), length);
+      total += length;
+      i++;
+    }
+
+    const sockaddr* dest = reinterpret_cast<const sockaddr*>(&addr);
+
+    if (nbufs > 1) {
+      SendWrap* req_wrap = new SendWrap(env, req_wrap_obj, have_callback);
+      err = uv_udp_send_segments(&req_wrap->req_,
+                                 &wrap->handle_,
+                                 bufs,
+                                 nbufs,
+                                 dest,
+                                 OnSend);
+      req_wrap->Dispatched();
+      if (err == 0) {
+        pending++;
+        continue;
+      }
+      delete req_wrap;
+      if (err != UV_ENOSYS)
+        break;
+      segments = false;
+      err = 0;
+    }
+
+    for (size_t k = 0; k < nbufs && err == 0; k++) {
+      SendWrap* req_wrap = new SendWrap(env, req_wrap_obj, have_callback);
+      err = uv_udp_send(&req_wrap->req_,
+                        &wrap->handle_,
+                        &bufs[k],
+                        1,
+                        dest,
+                        OnSend);
+      req_wrap->Dispatched();
+      if (err)
+        delete req_wrap;
+      else
+        pending++;
+    }
+  }
+
+  req_wrap_obj->Set(env->pending_string(),
+                    Integer::NewFromUnsigned(env->isolate(), pending));
+  args.GetReturnValue().Set(err);
+}
+
+
+void UDPWrap::SendBatch(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET);
+}
+
+
+void UDPWrap::SendBatch6(const FunctionCallbackInfo<Value>& args) {
+  DoSendBatch(args, AF_INET6);
+}
+
+
 void UDPWrap::RecvStart(const FunctionCallbackInfo<Value>& args) {
   UDPWrap* wrap = Unwrap<UDPWrap>(args.Holder());
   int err = uv_udp_recv_start(&wrap->handle_, OnAlloc, OnRecv);
@@ -357,16 +520,83 @@ void UDPWrap::OnSend(uv_udp_send_t* req, int status) {
 }
 
 
+// Datagrams are read into a buffer that is owned by the UDPWrap and copied
+// out at their actual size, instead of allocating 64 KB per datagram and
+// shrinking it afterwards.
 void UDPWrap::OnAlloc(uv_handle_t* handle,
                       size_t suggested_size,
                       uv_buf_t* buf) {
-  buf->base = static_cast<char*>(malloc(suggested_size));
-  buf->len = suggested_size;
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+  size_t size = suggested_size;
+
+  if (wrap->recv_batch_ && size < kRecvBatchSize * kRecvSlotSize)
+    size = kRecvBatchSize * kRecvSlotSize;
+
+  if (wrap->recv_buffer_size_ < size) {
+    free(wrap->recv_buffer_);
+    wrap->recv_buffer_ = static_cast<char*>(malloc(size));
+    wrap->recv_buffer_size_ = size;
+    if (wrap->recv_buffer_ == nullptr) {
+      FatalError("node::UDPWrap::OnAlloc(uv_handle_t*, size_t, uv_buf_t*)",
+                 "Out Of Memory");
+    }
+  }
+
+  buf->base = wrap->recv_buffer_;
+  buf->len = wrap->recv_buffer_size_;
+}
+
+
+// The rinfo object of a datagram.  Datagrams that didn't fit into the
+// receive buffer have been cut short by the OS and are marked as truncated.
+static Local<Object> RecvInfoToJS(Environment* env,
+                                  const sockaddr* addr,
+                                  unsigned int flags) {
+  Local<Object> info = AddressToJS(env, addr);
+  if (flags & UV_UDP_PARTIAL)
+    info->Set(env->truncated_string(), True(env->isolate()));
+  return info;
+}
+
+
+// Copies the datagrams of the last recvmmsg(2) call into a single Buffer
+// and hands it to JS along with a [length, rinfo, ...] array.
+void UDPWrap::FlushRecvBatch() {
+  Environment* env = this->env();
+  size_t count = recv_batch_count_;
+  size_t total = 0;
+  size_t i;
+
+  recv_batch_count_ = 0;
 
-  if (buf->base == nullptr && suggested_size > 0) {
-    FatalError("node::UDPWrap::OnAlloc(uv_handle_t*, size_t, uv_buf_t*)",
-               "Out Of Memory");
+  for (i = 0; i < count; i++)
+    total += recv_batch_entries_[i].length;
+
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  Local<Object> buffer = Buffer::New(env, total);
+  Local<Array> info = Array::New(env->isolate(), count * 2);
+  char* data = Buffer::Data(buffer);
+
+  for (i = 0; i < count; i++) {
+    const RecvBatchEntry& entry = recv_batch_entries_[i];
+    memcpy(data, entry.data, entry.length);
+    data += entry.length;
+    info->Set(i * 2, Integer::New(env->isolate(), entry.length));
+    info->Set(i * 2 + 1,
+              RecvInfoToJS(env,
+                           reinterpret_cast<const sockaddr*>(&entry.addr),
+                           entry.flags));
   }
+
+  Local<Value> argv[] = {
+    Integer::New(env->isolate(), count),
+    object(),
+    buffer,
+    info
+  };
+  MakeCallback(env->onmessages_string(), ARRAY_SIZE(argv), argv);
 }
 
 
@@ -375,13 +605,31 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
                      const uv_buf_t* buf,
                      const struct sockaddr* addr,
                      unsigned int flags) {
+  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
+
+  if (flags & UV_UDP_MMSG_CHUNK) {
+    CHECK_LT(wrap->recv_batch_count_, kRecvBatchSize);
+    if (addr == nullptr)
+      return;
+    RecvBatchEntry* entry = &wrap->recv_batch_entries_[wrap->recv_batch_count_];
+    entry->data = buf->base;
+    entry->length = nread;
+    entry->flags = flags;
+    memcpy(&entry->addr,
+           addr,
+           addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6) :
+                                         sizeof(sockaddr_in));
+    wrap->recv_batch_count_++;
+    return;
+  }
+
+  // End of a recvmmsg(2) batch, or nothing to read.
   if (nread == 0 && addr == nullptr) {
-    if (buf->base != nullptr)
-      free(buf->base);
+    if (wrap->recv_batch_count_ > 0)
+      wrap->FlushRecvBatch();
     return;
   }
 
-  UDPWrap* wrap = static_cast<UDPWrap*>(handle->data);
   Environment* env = wrap->env();
 
   HandleScope handle_scope(env->isolate());
@@ -396,15 +644,12 @@ void UDPWrap::OnRecv(uv_udp_t* handle,
   };
 
   if (nread < 0) {
-    if (buf->base != nullptr)
-      free(buf->base);
     wrap->MakeCallback(env->onmessage_string(), ARRAY_SIZE(argv), argv);
     return;
   }
 
-  char* base = static_cast<char*>(realloc(buf->base, nread));
-  argv[2] = Buffer::Use(env, base, nread);
-  argv[3] = AddressToJS(env, addr);
+  argv[2] = Buffer::New(env, buf->base, nread);
+  argv[3] = RecvInfoToJS(env, addr, flags);
   wrap->MakeCallback(env->onmessage_string(), ARRAY_SIZE(argv), argv);
 }
 
@@ -42,6 +42,8 @@ class UDPWrap: public HandleWrap {
   static void Send(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Send6(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SendBatch6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStart(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void RecvStop(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void GetSockName(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -52,17 +54,35 @@ class UDPWrap: public HandleWrap {
       const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetBroadcast(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetTTL(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetRecvBatch(const v8::FunctionCallbackInfo<v8::Value>& args);
 
   static v8::Local<v8::Object> Instantiate(Environment* env);
   uv_udp_t* UVHandle();
 
  private:
+  // Datagrams per recvmmsg(2) call in batch mode, each gets a 64 KB slot in
+  // the receive buffer.
+  static const size_t kRecvBatchSize = 20;
+  static const size_t kRecvSlotSize = 64 * 1024;
+
+  struct RecvBatchEntry {
+    const char* data;
+    size_t length;
+    unsigned int flags;
+    struct sockaddr_storage addr;
+  };
+
   UDPWrap(Environment* env, v8::Handle<v8::Object> object);
+  ~UDPWrap();
+
+  void FlushRecvBatch();
 
   static void DoBind(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
   static void DoSend(const v8::FunctionCallbackInfo<v8::Value>& args,
                      int family);
+  static void DoSendBatch(const v8::FunctionCallbackInfo<v8::Value>& args,
+                          int family);
   static void SetMembership(const v8::FunctionCallbackInfo<v8::Value>& args,
                             uv_membership membership);
 
@@ -77,6 +97,14 @@ class UDPWrap: public HandleWrap {
                      unsigned int flags);
 
   uv_udp_t handle_;
+
+  // Receive buffer, reused for every read.  Big enough for kRecvBatchSize
+  // datagrams in batch mode, for one otherwise.
+  char* recv_buffer_;
+  size_t recv_buffer_size_;
+  bool recv_batch_;
+  RecvBatchEntry recv_batch_entries_[kRecvBatchSize];
+  size_t recv_batch_count_;
 };
 
 }  // namespace node
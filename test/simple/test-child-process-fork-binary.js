@@ -0,0 +1,111 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var fork = require('child_process').fork;
+var net = require('net');
+
+if (process.argv[2] === 'child') {
+  // Echo everything back; tell the parent when a server handle arrives.
+  process.on('message', function(msg, handle) {
+    if (handle) {
+      handle.close();
+      process.send({ what: 'got server', msg: msg });
+      return;
+    }
+    process.send(msg);
+  });
+  return;
+}
+
+var big = new Buffer(1024 * 1024 + 7);
+for (var i = 0; i < big.length; i++) big[i] = i % 253;
+
+var messages = [
+  'hello',
+  42,
+  null,
+  [1, 'two', { three: 3 }],
+  { unicode: 'é中😀', nested: { a: [true, false] } },
+  { buf: new Buffer('buffer in an object') },
+  [new Buffer('first'), new Buffer(0), new Buffer('third')],
+  { deep: { list: [{ b: big }] }, text: new Array(100000).join('x') },
+  { date: new Date(0) }
+];
+
+// Lots of small messages that will be coalesced into a few reads.
+for (i = 0; i < 1000; i++) messages.push({ seq: i });
+
+function expected(msg) {
+  return JSON.parse(JSON.stringify(msg));
+}
+
+var child = fork(__filename, ['child'], { serialization: 'binary' });
+var received = [];
+var gotServer = false;
+
+child.on('message', function(msg) {
+  if (msg && msg.what === 'got server') {
+    assert.deepEqual(msg.msg, { what: 'server', n: 1 });
+    gotServer = true;
+    child.disconnect();
+    return;
+  }
+
+  received.push(msg);
+  if (received.length !== messages.length) return;
+
+  // Buffers come back as Buffers, not as { type: 'Buffer', data: [...] }.
+  assert.ok(Buffer.isBuffer(received[5].buf));
+  assert.equal(received[5].buf.toString(), 'buffer in an object');
+  assert.ok(Buffer.isBuffer(received[6][1]));
+  assert.equal(received[6][1].length, 0);
+  assert.equal(received[6][2].toString(), 'third');
+  assert.ok(Buffer.isBuffer(received[7].deep.list[0].b));
+  assert.equal(received[7].deep.list[0].b.toString('hex'), big.toString('hex'));
+
+  for (var i = 0; i < messages.length; i++)
+    assert.deepEqual(expected(received[i]), expected(messages[i]));
+
+  // The messages with buffers weren't modified by sending them.
+  assert.ok(Buffer.isBuffer(messages[5].buf));
+  assert.ok(Buffer.isBuffer(messages[6][0]));
+
+  var server = net.createServer();
+  server.listen(common.PORT, function() {
+    child.send({ what: 'server', n: 1 }, server);
+    server.close();
+  });
+});
+
+messages.forEach(function(msg) {
+  child.send(msg);
+});
+
+assert.throws(function() {
+  fork(__filename, ['child'], { serialization: 'xml' });
+}, TypeError);
+
+process.on('exit', function() {
+  assert.equal(received.length, messages.length);
+  assert.ok(gotServer);
+});
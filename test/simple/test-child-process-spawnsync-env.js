@@ -0,0 +1,43 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+var spawnSync = require('child_process').spawnSync;
+
+if (process.argv[2] === 'child') {
+  console.log(process.env.SPAWNSYNC_ENV_TEST);
+  return;
+}
+
+var env = { SPAWNSYNC_ENV_TEST: 'from the parent' };
+for (var key in process.env)
+  env[key] = process.env[key];
+
+// The child sees the environment it is given, not the parent's.
+var ret = spawnSync(process.execPath, [__filename, 'child'], { env: env });
+common.checkSpawnSyncRet(ret);
+assert.equal(ret.stdout.toString().trim(), 'from the parent');
+
+ret = spawnSync(process.execPath, [__filename, 'child']);
+common.checkSpawnSyncRet(ret);
+assert.equal(ret.stdout.toString().trim(), 'undefined');
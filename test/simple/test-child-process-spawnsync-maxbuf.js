@@ -0,0 +1,54 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var spawnSync = require('child_process').spawnSync;
+
+// Several megabytes of output, so that the capture region has to grow a
+// number of times before the child is done.
+var SIZE = 5 * 1024 * 1024 + 123;
+var script = 'var b = new Buffer(' + SIZE + ');' +
+             'for (var i = 0; i < b.length; i++) b[i] = i % 251;' +
+             'process.stdout.write(b);';
+
+var ret = spawnSync(process.execPath, ['-e', script]);
+
+common.checkSpawnSyncRet(ret);
+assert.equal(ret.stdout.length, SIZE);
+for (var i = 0; i < SIZE; i++) {
+  if (ret.stdout[i] !== i % 251)
+    assert.fail(ret.stdout[i], i % 251, 'byte ' + i + ' is wrong');
+}
+assert.equal(ret.stderr.length, 0);
+
+// Going over maxBuffer still kills the child, and what was read up to that
+// point is returned.
+ret = spawnSync(process.execPath, ['-e', script], { maxBuffer: 1024 * 1024 });
+
+assert.ok(ret.error, 'maxBuffer should error');
+assert.strictEqual(ret.error.errno, 'ENOBUFS');
+assert.ok(ret.stdout.length > 1024 * 1024);
+assert.ok(ret.stdout.length < SIZE);
+for (i = 0; i < ret.stdout.length; i++) {
+  if (ret.stdout[i] !== i % 251)
+    assert.fail(ret.stdout[i], i % 251, 'byte ' + i + ' is wrong');
+}
@@ -0,0 +1,75 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var cluster = require('cluster');
+var net = require('net');
+
+// The cluster's own messages (online, listening, disconnect) go over the
+// same channel, so a worker that can listen and talk back shows that both
+// sides picked up the binary serialization.
+if (cluster.isWorker) {
+  var server = net.createServer(function(socket) {
+    socket.end('ok');
+  });
+  server.listen(common.PORT, function() {
+    process.send({ cmd: 'ready', payload: new Buffer('from worker') });
+  });
+  process.on('message', function(msg) {
+    assert.ok(Buffer.isBuffer(msg.payload));
+    assert.equal(msg.payload.toString(), 'from master');
+    server.close();
+    cluster.worker.disconnect();
+  });
+  return;
+}
+
+var gotReady = false;
+var gotResponse = false;
+
+cluster.setupMaster({ serialization: 'binary' });
+assert.equal(cluster.settings.serialization, 'binary');
+
+var worker = cluster.fork();
+
+worker.on('message', function(msg) {
+  assert.equal(msg.cmd, 'ready');
+  assert.ok(Buffer.isBuffer(msg.payload));
+  assert.equal(msg.payload.toString(), 'from worker');
+  gotReady = true;
+
+  net.connect(common.PORT, function() {
+    var data = '';
+    this.setEncoding('utf8');
+    this.on('data', function(chunk) { data += chunk; });
+    this.on('end', function() {
+      assert.equal(data, 'ok');
+      gotResponse = true;
+      worker.send({ payload: new Buffer('from master') });
+    });
+  });
+});
+
+process.on('exit', function() {
+  assert.ok(gotReady);
+  assert.ok(gotResponse);
+});
@@ -0,0 +1,112 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+crypto.DEFAULT_ENCODING = 'buffer';
+
+var data = ['', 'foo', new Buffer('bar'), new Array(1025).join('x')];
+var keys = ['', 'key1', new Buffer('key2'), 'key1'];
+
+function hashes(algo) {
+  return data.map(function(d) {
+    return crypto.createHash(algo).update(d).digest('hex');
+  });
+}
+
+function hmacs(algo, key) {
+  return data.map(function(d, i) {
+    var k = Array.isArray(key) ? key[i] : key;
+    return crypto.createHmac(algo, k).update(d).digest('hex');
+  });
+}
+
+function hex(digests) {
+  return digests.map(function(d) {
+    assert.ok(Buffer.isBuffer(d));
+    return d.toString('hex');
+  });
+}
+
+['md5', 'sha1', 'sha256', 'sha512'].forEach(function(algo) {
+  assert.deepEqual(hex(crypto.hashBatch(algo, data)), hashes(algo));
+  assert.deepEqual(hex(crypto.hmacBatch(algo, 'secret', data)),
+                   hmacs(algo, 'secret'));
+  assert.deepEqual(hex(crypto.hmacBatch(algo, keys, data)),
+                   hmacs(algo, keys));
+
+  crypto.hashBatch(algo, data, common.mustCall(function(err, digests) {
+    assert.equal(err, null);
+    assert.deepEqual(hex(digests), hashes(algo));
+  }));
+
+  crypto.hmacBatch(algo, keys, data, common.mustCall(function(err, digests) {
+    assert.equal(err, null);
+    assert.deepEqual(hex(digests), hmacs(algo, keys));
+  }));
+});
+
+assert.deepEqual(crypto.hashBatch('sha1', []), []);
+
+// The caller may reuse its array while the batch is in flight.
+(function() {
+  var copy = data.map(function(d) { return new Buffer(d); });
+  crypto.hashBatch('sha1', copy, common.mustCall(function(err, digests) {
+    assert.equal(err, null);
+    assert.deepEqual(hex(digests), hashes('sha1'));
+  }));
+  for (var i = 0; i < copy.length; i++)
+    copy[i] = null;
+})();
+
+// DEFAULT_ENCODING is honored for the digests.
+var expected = hashes('sha1');
+crypto.DEFAULT_ENCODING = 'hex';
+assert.deepEqual(crypto.hashBatch('sha1', data), expected);
+crypto.DEFAULT_ENCODING = 'buffer';
+
+assert.throws(function() {
+  crypto.hashBatch('sha1', 'foo');
+}, /data must be an array/);
+
+assert.throws(function() {
+  crypto.hashBatch('sha1', [{}]);
+}, /Not a buffer/);
+
+assert.throws(function() {
+  crypto.hashBatch('no-such-digest', data);
+}, /Digest method not supported/);
+
+assert.throws(function() {
+  crypto.hmacBatch('sha1', ['a'], data);
+}, /same length/);
+
+assert.throws(function() {
+  crypto.hmacBatch('sha1', null, data);
+}, /key must be/);
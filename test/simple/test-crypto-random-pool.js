@@ -0,0 +1,114 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+crypto.DEFAULT_ENCODING = 'buffer';
+
+crypto.setRandomBytesPool({ size: 4096, threshold: 4096, maxRequestSize: 64 });
+
+// Invalid sizes still throw when the pool is enabled.
+[-1, 1.5, undefined, null, {}].forEach(function(value) {
+  assert.throws(function() { crypto.randomBytes(value); });
+});
+
+// The pool may not be filled yet, requests fall back to the regular path
+// until it is.
+var seen = {};
+for (var i = 0; i < 1000; i++) {
+  var buf = crypto.randomBytes(16);
+  assert.ok(Buffer.isBuffer(buf));
+  assert.equal(buf.length, 16);
+  var hex = buf.toString('hex');
+  assert.ok(!seen.hasOwnProperty(hex));
+  seen[hex] = true;
+}
+
+assert.equal(crypto.randomBytes(0).length, 0);
+assert.equal(crypto.randomBytes(1024).length, 1024);  // bypasses the pool
+
+// Give the background refill a chance to run, then check that async
+// requests served from the pool are still asynchronous.
+setTimeout(function() {
+  var sync = true;
+  crypto.randomBytes(32, common.mustCall(function(err, buf) {
+    assert.equal(err, null);
+    assert.equal(buf.length, 32);
+    assert.equal(sync, false);
+  }));
+  sync = false;
+
+  assert.throws(function() {
+    crypto.setRandomBytesPool({ size: 16, maxRequestSize: 32 });
+  }, RangeError);
+  assert.throws(function() {
+    crypto.setRandomBytesPool({ size: 16, threshold: 32 });
+  }, RangeError);
+
+  crypto.setRandomBytesPool(null);
+  assert.equal(crypto.randomBytes(16).length, 16);
+}, 50);
+
+// Calls cb once pool.read(size) returns a buffer.
+function whenReadable(pool, size, cb, tries) {
+  var buf = pool.read(size);
+  if (buf)
+    return cb(buf);
+  tries = (tries | 0) + 1;
+  assert.ok(tries < 1000, 'pool did not refill');
+  setTimeout(function() {
+    whenReadable(pool, size, cb, tries);
+  }, 1);
+}
+
+var RandomBytesPool = process.binding('crypto').RandomBytesPool;
+
+// A threshold of 0 refills the pool once it is empty.
+(function() {
+  var pool = new RandomBytesPool(64, 0);
+  whenReadable(pool, 16, common.mustCall(function(buf) {
+    assert.equal(buf.length, 16);
+    assert.equal(pool.read(48).length, 48);
+    whenReadable(pool, 64, common.mustCall(function(buf) {
+      assert.equal(buf.length, 64);
+    }));
+  }));
+})();
+
+// A read the pool can't serve refills it, even with more than `threshold`
+// bytes left.
+(function() {
+  var pool = new RandomBytesPool(64, 0);
+  whenReadable(pool, 40, common.mustCall(function(buf) {
+    assert.equal(pool.read(32), undefined);
+    whenReadable(pool, 32, common.mustCall(function(buf) {
+      assert.equal(buf.length, 32);
+    }));
+  }));
+})();
@@ -0,0 +1,146 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+
+try {
+  var crypto = require('crypto');
+} catch (e) {
+  console.log('Not compiled with OPENSSL support.');
+  process.exit();
+}
+
+crypto.DEFAULT_ENCODING = 'buffer';
+
+var key = new Buffer('0123456789abcdef0123456789abcdef');
+var iv = new Buffer('0123456789abcdef');
+var plain = new Buffer(1000);
+for (var i = 0; i < plain.length; i++)
+  plain[i] = i & 0xff;
+
+// hash.update(buffer, offset, length) and hash.digestInto()
+(function() {
+  var expected = crypto.createHash('sha256')
+                       .update(plain.slice(100, 300))
+                       .digest();
+  var out = new Buffer(40);
+  out.fill(0);
+  var n = crypto.createHash('sha256')
+                .update(plain, 100, 200)
+                .digestInto(out, 8);
+  assert.equal(n, 32);
+  assert.equal(out.slice(8, 40).toString('hex'), expected.toString('hex'));
+  assert.equal(out.slice(0, 8).toString('hex'), '0000000000000000');
+
+  // The length defaults to the rest of the buffer.
+  assert.equal(crypto.createHash('md5').update(plain, 990).digest('hex'),
+               crypto.createHash('md5').update(plain.slice(990)).digest('hex'));
+
+  assert.throws(function() {
+    crypto.createHash('sha256').update(plain, 900, 200);
+  }, RangeError);
+  assert.throws(function() {
+    crypto.createHash('sha256').update('foo', 0, 1);
+  }, TypeError);
+  assert.throws(function() {
+    crypto.createHash('sha256').digestInto(new Buffer(31));
+  }, RangeError);
+
+  var h = crypto.createHash('sha1');
+  h.digestInto(new Buffer(20));
+  assert.throws(function() {
+    h.digestInto(new Buffer(20));
+  }, /Not initialized/);
+})();
+
+// hmac.update(buffer, offset, length) and hmac.digestInto()
+(function() {
+  var expected = crypto.createHmac('sha1', key).update(plain).digest('hex');
+  var out = new Buffer(20);
+  var n = crypto.createHmac('sha1', key)
+                .update(plain, 0, 500)
+                .update(plain, 500, 500)
+                .digestInto(out);
+  assert.equal(n, 20);
+  assert.equal(out.toString('hex'), expected);
+})();
+
+// cipher.updateInto() and cipher.finalInto()
+['aes-256-cbc', 'aes-256-ctr', 'aes-256-ecb'].forEach(function(algo) {
+  var civ = algo === 'aes-256-ecb' ? new Buffer(0) : iv;
+  var c = crypto.createCipheriv(algo, key, civ);
+  var expected = Buffer.concat([c.update(plain), c.final()]);
+
+  var enc = new Buffer(plain.length + 64);
+  var cipher = crypto.createCipheriv(algo, key, civ);
+  var written = cipher.updateInto(plain, 0, 333, enc, 0);
+  written += cipher.updateInto(plain, 333, plain.length - 333, enc, written);
+  written += cipher.finalInto(enc, written);
+  assert.equal(written, expected.length);
+  assert.equal(enc.slice(0, written).toString('hex'), expected.toString('hex'));
+
+  var dec = new Buffer(plain.length + 64);
+  var decipher = crypto.createDecipheriv(algo, key, civ);
+  var n = decipher.updateInto(enc, 0, written, dec, 0);
+  n += decipher.finalInto(dec, n);
+  assert.equal(n, plain.length);
+  assert.equal(dec.slice(0, n).toString('hex'), plain.toString('hex'));
+
+  assert.throws(function() {
+    crypto.createCipheriv(algo, key, civ).updateInto(plain, 0, 100,
+                                                     new Buffer(100), 0);
+  }, RangeError);
+  assert.throws(function() {
+    crypto.createCipheriv(algo, key, civ).updateInto(plain, 999, 2, enc, 0);
+  }, RangeError);
+  assert.throws(function() {
+    cipher.updateInto(plain, 0, 16, enc, 0);
+  }, /unsupported state/);
+});
+
+// Cipher streams write into a shared pool, make sure that chunks that
+// were already pushed are not clobbered by later ones.
+(function() {
+  var cipher = crypto.createCipheriv('aes-256-cbc', key, iv);
+  var decipher = crypto.createDecipheriv('aes-256-cbc', key, iv);
+  var chunks = [];
+
+  cipher.pipe(decipher);
+  decipher.on('data', function(chunk) {
+    chunks.push(chunk);
+  });
+  decipher.on('end', common.mustCall(function() {
+    var out = Buffer.concat(chunks);
+    assert.equal(out.length, plain.length * 100);
+    for (var i = 0; i < 100; i++) {
+      var slice = out.slice(i * plain.length, (i + 1) * plain.length);
+      assert.equal(slice.toString('hex'), plain.toString('hex'));
+    }
+  }));
+
+  for (var i = 0; i < 100; i++) {
+    var split = 7 * i % plain.length;
+    cipher.write(plain.slice(0, split));
+    cipher.write(plain.slice(split));
+  }
+  cipher.end();
+})();
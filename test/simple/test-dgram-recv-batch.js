@@ -0,0 +1,64 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+var N = 100;
+var received = [];
+
+function payload(i) {
+  return 'message ' + i + ' ' + new Array(i % 50).join('x');
+}
+
+var server = dgram.createSocket({ type: 'udp4', recvBatch: true });
+var client = dgram.createSocket('udp4');
+
+server.on('message', function(buf, rinfo) {
+  assert.equal(rinfo.size, buf.length);
+  assert.equal(rinfo.address, '127.0.0.1');
+  assert.equal(rinfo.port, client.address().port);
+  assert.equal(rinfo.truncated, undefined);
+  received.push(buf.toString());
+  if (received.length === N) {
+    server.close();
+    client.close();
+  }
+});
+
+server.bind(common.PORT, '127.0.0.1', function() {
+  // Fire them all off at once so that several are queued on the server
+  // socket when it gets around to reading.
+  for (var i = 0; i < N; i++) {
+    var buf = new Buffer(payload(i));
+    client.send(buf, 0, buf.length, common.PORT, '127.0.0.1');
+  }
+});
+
+process.on('exit', function() {
+  // UDP on loopback doesn't drop or reorder datagrams unless the socket
+  // buffer overflows, which 100 small datagrams don't do.
+  assert.equal(received.length, N);
+  for (var i = 0; i < N; i++)
+    assert.equal(received[i], payload(i));
+});
@@ -0,0 +1,118 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var dgram = require('dgram');
+
+// Runs of same-sized datagrams with a shorter one at the end, one on its
+// own, an empty one and datagrams that alternate between two destinations.
+function batch(port1, port2) {
+  var messages = [];
+  var i;
+  for (i = 0; i < 40; i++)
+    messages.push({ buffer: fill(i, 1000), port: port1, address: '127.0.0.1' });
+  messages.push({ buffer: fill(40, 10), port: port1, address: '127.0.0.1' });
+  messages.push({ buffer: 'single', port: port2, address: 'localhost' });
+  messages.push({ buffer: '', port: port1, address: '127.0.0.1' });
+  for (i = 0; i < 10; i++) {
+    messages.push({
+      buffer: fill(i, 100),
+      port: i % 2 ? port1 : port2,
+      address: '127.0.0.1'
+    });
+  }
+  return messages;
+}
+
+function fill(n, length) {
+  var buf = new Buffer(length);
+  buf.fill(n);
+  return buf;
+}
+
+var messages = batch(common.PORT, common.PORT + 1);
+var expected = {};
+var received = {};
+var pending = messages.length;
+var batches = 1;
+
+messages.forEach(function(message) {
+  var port = message.port;
+  (expected[port] = expected[port] || []).push(String(message.buffer));
+});
+
+var servers = [common.PORT, common.PORT + 1].map(function(port) {
+  var server = dgram.createSocket('udp4');
+  received[port] = [];
+  server.on('message', function(buf, rinfo) {
+    received[port].push(String(buf));
+    if (--pending > 0)
+      return;
+    if (batches === 1) {
+      // Once the first batch is in, so the socket buffers don't overflow.
+      batches++;
+      pending = messages.length;
+      client.sendBatch(batch(common.PORT, common.PORT + 1));
+      return;
+    }
+    servers.forEach(function(server) {
+      server.close();
+    });
+    client.close();
+  });
+  server.bind(port, '127.0.0.1');
+  return server;
+});
+
+var client = dgram.createSocket('udp4');
+
+// Sent while the client is still unbound, and then once more without a
+// callback after the first batch has been received.
+client.sendBatch(messages, common.mustCall(function(err) {
+  assert.equal(err, null);
+}));
+
+assert.throws(function() {
+  client.sendBatch('nope');
+}, TypeError);
+
+assert.throws(function() {
+  client.sendBatch([{ buffer: 'x', port: 0, address: '127.0.0.1' }]);
+}, RangeError);
+
+assert.throws(function() {
+  client.sendBatch([{ buffer: 42, port: common.PORT }]);
+}, TypeError);
+
+// An empty batch still calls back.
+client.sendBatch([], common.mustCall(function(err) {
+  assert.equal(err, null);
+}));
+
+process.on('exit', function() {
+  // Loopback doesn't drop or reorder datagrams as long as the socket
+  // buffers have room, which they have for this much data.
+  for (var port in expected) {
+    assert.deepEqual(received[port], expected[port].concat(expected[port]));
+  }
+});
@@ -0,0 +1,167 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+
+var server = http.createServer(function(req, res) {
+  res.end(req.url);
+});
+
+var name = 'localhost:' + common.PORT + '::';
+
+function get(agent, path, cb) {
+  return http.get({
+    host: 'localhost',
+    port: common.PORT,
+    agent: agent,
+    path: path
+  }, function(res) {
+    res.resume();
+    res.on('end', function() {
+      // The socket goes back to the pool on the next tick.
+      setImmediate(cb);
+    });
+  });
+}
+
+function lifo(next) {
+  var agent = new http.Agent({ keepAlive: true, maxSockets: 2 });
+  var pending = 2;
+  get(agent, '/a', done);
+  get(agent, '/b', done);
+
+  function done() {
+    if (--pending > 0)
+      return;
+    assert.equal(agent.freeSockets[name].length, 2);
+    var newest = agent.freeSockets[name][1];
+    var req = get(agent, '/c', function() {
+      var stats = agent.getPoolStats(name);
+      assert.equal(stats.requests, 3);
+      assert.equal(stats.created, 2);
+      assert.equal(stats.reused, 1);
+      assert.equal(stats.active, 0);
+      assert.equal(stats.idle, 2);
+      agent.destroy();
+      next();
+    });
+    req.on('socket', function(socket) {
+      assert.strictEqual(socket, newest);
+    });
+  }
+}
+
+function evict(next) {
+  var agent = new http.Agent({ keepAlive: true, freeSocketTimeout: 50 });
+  get(agent, '/', function() {
+    assert.equal(agent.freeSockets[name].length, 1);
+    setTimeout(function() {
+      assert.equal(agent.freeSockets[name], undefined);
+      assert.equal(agent.getPoolStats(name).evicted, 1);
+
+      // A socket that is reused doesn't time out under the request.
+      get(agent, '/', function() {
+        var socket = agent.freeSockets[name][0];
+        get(agent, '/', function() {
+          assert.strictEqual(agent.freeSockets[name][0], socket);
+          assert.equal(agent.getPoolStats(name).evicted, 1);
+          agent.destroy();
+          next();
+        });
+      });
+    }, 200);
+  });
+}
+
+function warm(next) {
+  var agent = new http.Agent({ keepAlive: true, minSockets: 3 });
+  get(agent, '/', function() {
+    setTimeout(function() {
+      var stats = agent.getPoolStats(name);
+      assert.equal(stats.created, 3);
+      assert.equal(stats.active, 0);
+      assert.equal(stats.idle, 3);
+      agent.destroy();
+      next();
+    }, 100);
+  });
+}
+
+function queue(next) {
+  var agent = new http.Agent({ keepAlive: true, maxSockets: 1 });
+  var pending = 3;
+  get(agent, '/', done);
+  get(agent, '/', done);
+  get(agent, '/', done);
+  var stats = agent.getPoolStats(name);
+  assert.equal(stats.active, 1);
+  assert.equal(stats.queued, 2);
+
+  function done() {
+    if (--pending > 0)
+      return;
+    var all = agent.getPoolStats();
+    assert.deepEqual(Object.keys(all), [name]);
+    assert.equal(all[name].created, 1);
+    assert.equal(all[name].queued, 0);
+    assert.equal(all[name].waited, 2);
+    assert(all[name].waitTime >= 0);
+    agent.destroy();
+    next();
+  }
+}
+
+function idleError(next) {
+  var agent = new http.Agent({ keepAlive: true });
+  get(agent, '/', function() {
+    var socket = agent.freeSockets[name][0];
+    socket.on('close', function() {
+      assert.equal(agent.freeSockets[name], undefined);
+      // The next request gets a new connection.
+      get(agent, '/', function() {
+        assert.equal(agent.getPoolStats(name).created, 2);
+        agent.destroy();
+        next();
+      });
+    });
+    socket.emit('error', new Error('ECONNRESET'));
+  });
+}
+
+var tests = [lifo, evict, warm, queue, idleError];
+var ran = 0;
+
+server.listen(common.PORT, function run() {
+  var test = tests.shift();
+  if (!test)
+    return server.close();
+  test(function() {
+    ran++;
+    run();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(ran, 5);
+});
@@ -0,0 +1,81 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+
+// Buffers of any size written to a chunked response are framed the same way,
+// whether they are copied into one chunk or written as they are.
+var sizes = [1, 15, 16, 255, 256, 16 * 1024 - 1, 16 * 1024, 16 * 1024 + 1,
+             100 * 1024];
+var buffers = sizes.map(function(size, i) {
+  var b = new Buffer(size);
+  b.fill(97 + i);
+  return b;
+});
+
+var server = http.createServer(function(req, res) {
+  var callbacks = 0;
+  buffers.forEach(function(b) {
+    res.write(b, function() {
+      callbacks++;
+    });
+  });
+  res.write('string', 'utf8');
+  res.write('ffff', 'hex');
+  res.end(function() {
+    assert.equal(callbacks, buffers.length);
+  });
+});
+
+server.listen(common.PORT, function() {
+  var socket = net.connect(common.PORT);
+  var received = [];
+  socket.write('GET / HTTP/1.1\r\nConnection: close\r\n\r\n');
+  socket.on('data', function(d) {
+    received.push(d);
+  });
+  socket.on('end', function() {
+    server.close();
+    var response = Buffer.concat(received).toString('binary');
+    var body = response.slice(response.indexOf('\r\n\r\n') + 4);
+
+    var expected = '';
+    buffers.forEach(function(b) {
+      expected += b.length.toString(16) + '\r\n' +
+                  b.toString('binary') + '\r\n';
+    });
+    expected += '6\r\nstring\r\n';
+    expected += '2\r\n\xff\xff\r\n';
+    expected += '0\r\n\r\n';
+    assert.equal(body, expected);
+  });
+});
+
+// The framing itself.
+var frameChunk = process.binding('http_parser').frameChunk;
+assert.equal(frameChunk(new Buffer('abc')).toString(), '3\r\nabc\r\n');
+assert.equal(frameChunk(new Buffer(0)).toString(), '0\r\n\r\n');
+assert.equal(frameChunk(new Buffer(0x1234)).slice(0, 6).toString(),
+             '1234\r\n');
@@ -0,0 +1,62 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// The cached Date header does not go stale when idle timeouts are rounded
+// to a coarse resolution.
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var timers = require('timers');
+
+timers.setIdleTimeoutResolution(10000);
+
+var dates = [];
+
+var server = http.createServer(function(req, res) {
+  // Not a one-byte string, so the headers are built in JS.
+  res.setHeader('X-Wide', '\u263a');
+  res.end();
+});
+
+function get(cb) {
+  http.get({ port: common.PORT, path: '/' }, function(res) {
+    dates.push(res.headers.date);
+    res.resume();
+    res.on('end', cb);
+  });
+}
+
+server.listen(common.PORT, function() {
+  get(function() {
+    // Just past the start of the next second.
+    setTimeout(function() {
+      get(function() {
+        server.close();
+      });
+    }, 1100 - new Date().getMilliseconds());
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(dates.length, 2);
+  assert.notEqual(dates[0], dates[1]);
+});
@@ -0,0 +1,164 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Flags: --expose-gc
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+
+var requests = [];
+var upgrades = 0;
+var clientErrors = 0;
+
+var server = http.createServer(function(req, res) {
+  var body = '';
+  req.setEncoding('utf8');
+  req.on('data', function(chunk) {
+    body += chunk;
+    // Collect anything the parser doesn't keep alive in the middle of a read.
+    gc();
+  });
+  req.on('end', function() {
+    requests.push({ method: req.method, url: req.url, body: body });
+    res.end(req.url);
+  });
+});
+server.nativeParsing = true;
+
+server.on('connection', function(socket) {
+  socket.on('data', function() {
+    assert.fail('socket should not emit data while the parser reads');
+  });
+});
+
+server.on('upgrade', function(req, socket, head) {
+  upgrades++;
+  assert.equal(req.headers.upgrade, 'test');
+  assert.equal(head.toString(), 'hello');
+  socket.removeAllListeners('data');
+  socket.write('HTTP/1.1 101 Switching Protocols\r\n' +
+               'Upgrade: test\r\n' +
+               'Connection: Upgrade\r\n\r\n');
+  // Data after the upgrade goes to the socket again.
+  socket.on('data', function(d) {
+    socket.end(d);
+  });
+});
+
+server.on('clientError', function(err, socket) {
+  clientErrors++;
+});
+
+server.listen(common.PORT, function() {
+  pipelined();
+});
+
+function pipelined() {
+  var body = new Array(100000).join('x');
+  var c = net.connect(common.PORT, function() {
+    c.write('GET /a HTTP/1.1\r\n\r\n' +
+            'POST /b HTTP/1.1\r\nContent-Length: ' + body.length + '\r\n\r\n' +
+            body +
+            'GET /c HTTP/1.1\r\nConnection: close\r\n\r\n');
+  });
+  var response = '';
+  c.setEncoding('utf8');
+  c.on('data', function(d) {
+    response += d;
+  });
+  c.on('end', function() {
+    assert.deepEqual(requests.map(function(r) { return r.url; }),
+                     ['/a', '/b', '/c']);
+    assert.equal(requests[1].method, 'POST');
+    assert.equal(requests[1].body, body);
+    assert.notEqual(response.indexOf('\r\n/c\r\n'), -1);
+    pipelinedChunked();
+  });
+}
+
+// The end of a chunked body in the same read as the next request, and as an
+// upgrade.
+function pipelinedChunked() {
+  var c = net.connect(common.PORT, function() {
+    c.write('POST /d HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n' +
+            '5\r\nhello\r\n0\r\n\r\n' +
+            'POST /e HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n' +
+            '3\r\nabc\r\n3\r\ndef\r\n1\r\ng\r\n0\r\n\r\n' +
+            'POST /f HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n' +
+            '5\r\nworld\r\n0\r\n\r\n' +
+            'GET /up HTTP/1.1\r\n' +
+            'Upgrade: test\r\n' +
+            'Connection: Upgrade\r\n\r\nhello');
+  });
+  var response = '';
+  c.setEncoding('utf8');
+  c.on('data', function(d) {
+    response += d;
+    if (/101 Switching[^]*\r\n\r\n$/.test(response))
+      c.destroy();
+  });
+  c.on('close', function() {
+    var chunked = requests.slice(3);
+    assert.deepEqual(chunked.map(function(r) { return r.url; }),
+                     ['/d', '/e', '/f']);
+    assert.deepEqual(chunked.map(function(r) { return r.body; }),
+                     ['hello', 'abcdefg', 'world']);
+    upgrade();
+  });
+}
+
+function upgrade() {
+  var c = net.connect(common.PORT, function() {
+    c.write('GET /up HTTP/1.1\r\n' +
+            'Upgrade: test\r\n' +
+            'Connection: Upgrade\r\n\r\nhello');
+  });
+  var response = '';
+  c.setEncoding('utf8');
+  c.on('data', function(d) {
+    response += d;
+    if (/\r\n\r\n$/.test(response))
+      c.write('after upgrade');
+  });
+  c.on('end', function() {
+    assert.ok(/^HTTP\/1.1 101/.test(response));
+    assert.ok(/after upgrade$/.test(response));
+    parseError();
+  });
+}
+
+function parseError() {
+  var c = net.connect(common.PORT, function() {
+    c.write('GET / HTTP/1.1\r\nContent-Length: bad\r\n\r\n');
+  });
+  c.on('close', function() {
+    server.close();
+  });
+  c.resume();
+}
+
+process.on('exit', function() {
+  assert.equal(requests.length, 6);
+  assert.equal(upgrades, 2);
+  assert.equal(clientErrors, 1);
+});
@@ -0,0 +1,104 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var binding = process.binding('http_parser');
+var HTTPParser = binding.HTTPParser;
+var counters = binding.parserCounters;
+
+function snapshot() {
+  return {
+    created: counters[binding.kParsersCreated],
+    reused: counters[binding.kParsersReused],
+    closed: counters[binding.kParsersClosed],
+    live: counters[binding.kParsersLive],
+    maxLive: counters[binding.kParsersMaxLive],
+    heapStrings: counters[binding.kParserHeapStrings]
+  };
+}
+
+// Creating and closing a parser.
+var before = snapshot();
+var parser = new HTTPParser(HTTPParser.REQUEST);
+var after = snapshot();
+assert.equal(after.created, before.created + 1);
+assert.equal(after.live, before.live + 1);
+assert(after.maxLive >= after.live);
+
+parser.reinitialize(HTTPParser.REQUEST);
+assert.equal(snapshot().reused, before.reused);
+parser.reinitialize(HTTPParser.REQUEST);
+assert.equal(snapshot().reused, before.reused + 1);
+
+// Headers that arrive in pieces are copied to the heap.
+parser.reinitialize(HTTPParser.REQUEST);
+parser.execute(new Buffer('GET / HTTP/1.1\r\nX-Fo'));
+parser.execute(new Buffer('o: bar\r\n'));
+assert(snapshot().heapStrings > before.heapStrings);
+
+parser.close();
+after = snapshot();
+assert.equal(after.closed, before.closed + 1);
+assert.equal(after.live, before.live);
+
+// Requests made one after the other take their parsers from the pool.
+var server = http.createServer(function(req, res) {
+  res.end('ok');
+});
+
+var requests = 10;
+var start;
+
+server.listen(common.PORT, function() {
+  start = snapshot();
+  next();
+});
+
+function next() {
+  if (requests-- === 0)
+    return done();
+  http.get({
+    port: common.PORT,
+    agent: false
+  }, function(res) {
+    res.resume();
+    res.on('end', function() {
+      setImmediate(next);
+    });
+  });
+}
+
+function done() {
+  server.close();
+  var end = snapshot();
+  // A parser for each side of the first connection, after which the pool
+  // has enough.
+  assert(end.created - start.created <= 2);
+  assert(end.reused - start.reused >= 18);
+  assert.equal(end.closed, start.closed);
+}
+
+process.on('exit', function() {
+  assert.equal(requests, -1);
+});
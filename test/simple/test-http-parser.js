@@ -338,8 +338,9 @@ function expectBody(expected) {
     assert.equal(info.versionMinor, 1);
   });
 
+  // The chunks from one execute() come in one piece.
   var body_part = 0,
-      body_parts = ['123', '123456', '1234567890'];
+      body_parts = ['1231234561234567890'];
 
   function onBody(buf, start, len) {
     var body = '' + buf.slice(start, start + len);
@@ -351,6 +352,50 @@ function expectBody(expected) {
 })();
 
 
+//
+// Test more chunks in one buffer than the parser holds on to at once,
+// followed by trailers
+//
+(function() {
+  var chunks = '';
+  var expected = '';
+  for (var i = 0; i < 100; i++) {
+    var chunk = new Array(i % 7 + 2).join(String.fromCharCode(65 + i % 26));
+    chunks += chunk.length.toString(16) + CRLF + chunk + CRLF;
+    expected += chunk;
+  }
+
+  var request = Buffer(
+      'POST /it HTTP/1.1' + CRLF +
+      'Transfer-Encoding: chunked' + CRLF +
+      CRLF +
+      chunks +
+      '0' + CRLF +
+      'X-Trailer: done' + CRLF +
+      CRLF);
+
+  var parser = newParser(REQUEST);
+  var body = '';
+
+  parser[kOnHeadersComplete] = mustCall(function(info) {});
+
+  parser[kOnBody] = function(buf, start, len) {
+    body += buf.slice(start, start + len);
+  };
+
+  parser[kOnHeaders] = mustCall(function(headers, url) {
+    assert.equal(body, expected);
+    assert.deepEqual(headers, ['X-Trailer', 'done']);
+  });
+
+  parser[kOnMessageComplete] = mustCall(function() {
+    assert.equal(body, expected);
+  });
+
+  parser.execute(request, 0, request.length);
+})();
+
+
 //
 // Test chunked request body spread over multiple buffers (packets)
 //
@@ -376,8 +421,8 @@ function expectBody(expected) {
 
   var body_part = 0,
       body_parts = [
-        '123', '123456', '123456789',
-        '123456789ABC', '123456789ABCDEF'];
+        '123123456',
+        '123456789123456789ABC123456789ABCDEF'];
 
   function onBody(buf, start, len) {
     var body = '' + buf.slice(start, start + len);
@@ -557,6 +602,72 @@ function expectBody(expected) {
   parser.execute(req2, 0, req2.length);
 })();
 
+//
+// Test headers that come in a few bytes at a time, for more than one
+// message on the same parser
+//
+(function() {
+  var headers = [];
+  for (var i = 0; i < 40; i++)
+    headers.push('X-Header-' + i, new Array(i * 10 + 2).join('v'));
+  headers.push('Cookie', new Array(8000).join('c'));
+
+  var message = 'GET /' + new Array(500).join('u') + ' HTTP/1.1' + CRLF;
+  for (var i = 0; i < headers.length; i += 2)
+    message += headers[i] + ': ' + headers[i + 1] + CRLF;
+  message += CRLF;
+  var request = Buffer(message + message + message);
+
+  var parser = newParser(REQUEST);
+  var messages = 0;
+
+  parser[kOnHeadersComplete] = function(info) {
+    messages++;
+    assert.equal(info.url || parser.url, '/' + new Array(500).join('u'));
+    assert.deepEqual(parser.headers.concat(info.headers || []), headers);
+    parser.headers = [];
+    parser.url = '';
+  };
+
+  [1, 3, 7, 100].forEach(function(size) {
+    for (var i = 0; i < request.length; i += size)
+      parser.execute(request.slice(i, i + size));
+    parser.reinitialize(REQUEST);
+  });
+
+  assert.equal(messages, 12);
+})();
+
+//
+// Test a header of more than 16 KB that comes in small pieces
+//
+(function() {
+  [[20000, 100], [36000, 536], [48000, 1460]].forEach(function(test) {
+    var value = new Array(test[0] + 1).join('x');
+    var request = Buffer(
+        'GET / HTTP/1.1' + CRLF +
+        'X-Large: ' + value + CRLF +
+        CRLF);
+
+    var parser = newParser(REQUEST);
+    var messages = 0;
+
+    parser[kOnHeadersComplete] = function(info) {
+      messages++;
+      assert.deepEqual(parser.headers.concat(info.headers || []),
+                       ['X-Large', value]);
+    };
+
+    for (var i = 0; i < request.length; i += test[1]) {
+      var ret = parser.execute(request.slice(i, i + test[1]));
+      assert(!(ret instanceof Error), 'unexpected ' + ret.code);
+    }
+
+    assert.equal(messages, 1);
+  });
+})();
+
+
 // Test parser 'this' safety
 // https://github.com/joyent/node/issues/6690
 assert.throws(function() {
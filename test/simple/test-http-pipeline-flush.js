@@ -0,0 +1,74 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var http = require('http');
+var net = require('net');
+
+var REQUESTS = 8;
+var writes = 0;
+
+var server = http.createServer(function(req, res) {
+  res.end('response ' + req.url);
+});
+
+// Count the writes that reach the handle.
+server.on('connection', function(socket) {
+  var handle = socket._handle;
+  Object.keys(handle.constructor.prototype).forEach(function(name) {
+    if (!/^write/.test(name) || typeof handle[name] !== 'function')
+      return;
+    var write = handle[name];
+    handle[name] = function() {
+      writes++;
+      return write.apply(this, arguments);
+    };
+  });
+});
+
+server.listen(common.PORT, function() {
+  var request = '';
+  for (var i = 0; i < REQUESTS; i++)
+    request += 'GET /' + i + ' HTTP/1.1\r\nHost: localhost\r\n\r\n';
+
+  var conn = net.connect(common.PORT);
+  var received = '';
+  conn.setEncoding('utf8');
+  conn.write(request);
+  conn.on('data', function(chunk) {
+    received += chunk;
+    if (received.indexOf('response /' + (REQUESTS - 1)) !== -1)
+      conn.end();
+  });
+  conn.on('end', function() {
+    var responses = received.match(/response \/\d+/g);
+    assert.equal(responses.length, REQUESTS);
+    for (var i = 0; i < REQUESTS; i++)
+      assert.equal(responses[i], 'response /' + i);
+
+    // The first response goes out on its own, the responses to the
+    // requests that were pipelined behind it are written together.
+    assert.equal(writes, 2);
+    server.close();
+  });
+});
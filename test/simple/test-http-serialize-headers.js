@@ -0,0 +1,93 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var binding = process.binding('http_parser');
+
+function serialize(headers, sendDate) {
+  var state = {};
+  var flags = binding.serializeHeaders(state, 'HTTP/1.1 200 OK\r\n', headers,
+                                       !!sendDate);
+  return { flags: flags, header: state.messageHeader };
+}
+
+// Objects, arrays of pairs and multi-valued headers.
+var r = serialize({ 'Content-Type': 'text/plain', 'X-Num': 42 });
+assert.equal(r.header,
+             'HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nX-Num: 42\r\n');
+assert.equal(r.flags, 0);
+
+r = serialize([['Set-Cookie', 'a=1'], ['Set-Cookie', ['b=2', 'c=3']]]);
+assert.equal(r.header,
+             'HTTP/1.1 200 OK\r\n' +
+             'Set-Cookie: a=1\r\n' +
+             'Set-Cookie: b=2\r\n' +
+             'Set-Cookie: c=3\r\n');
+
+r = serialize(null);
+assert.equal(r.header, 'HTTP/1.1 200 OK\r\n');
+
+// Known headers are matched case-insensitively.
+r = serialize({ CONNECTION: 'Close' });
+assert.equal(r.flags, binding.kSentConnectionHeader | binding.kConnectionClose);
+r = serialize({ connection: 'keep-alive' });
+assert.equal(r.flags,
+             binding.kSentConnectionHeader | binding.kConnectionKeepAlive);
+r = serialize({ 'transfer-encoding': 'Chunked' });
+assert.equal(r.flags,
+             binding.kSentTransferEncodingHeader | binding.kChunkedEncoding);
+r = serialize({ 'Content-length': 5, 'date': 'now', 'Expect': '100-continue' });
+assert.equal(r.flags,
+             binding.kSentContentLengthHeader |
+             binding.kSentDateHeader |
+             binding.kSentExpect);
+
+// Line breaks are stripped from values, with the whitespace that follows.
+r = serialize({ 'X-Split': 'a\r\n  b\nc\r\rd' });
+assert.equal(r.header, 'HTTP/1.1 200 OK\r\nX-Split: abcd\r\n');
+
+// Latin-1 is passed through as is.
+r = serialize({ 'X-Latin1': 'café' });
+assert.equal(r.header, 'HTTP/1.1 200 OK\r\nX-Latin1: café\r\n');
+
+// Wider characters are left to the JS implementation.
+r = serialize({ 'X-Wide': '中' });
+assert.equal(r.flags, undefined);
+assert.equal(r.header, undefined);
+
+// The Date header, unless one was set explicitly.
+r = serialize({}, true);
+assert.equal(r.flags, 0);
+var m = /^HTTP\/1\.1 200 OK\r\nDate: (.+)\r\n$/.exec(r.header);
+assert.ok(m);
+assert.equal(m[1], new Date(m[1]).toUTCString());
+assert.ok(Math.abs(Date.parse(m[1]) - Date.now()) < 5000);
+
+r = serialize({ Date: 'Thu, 01 Jan 1970 00:00:00 GMT' }, true);
+assert.equal(r.header,
+             'HTTP/1.1 200 OK\r\nDate: Thu, 01 Jan 1970 00:00:00 GMT\r\n');
+
+// Exceptions thrown while converting values propagate.
+assert.throws(function() {
+  serialize({ 'X-Bad': { toString: function() { throw new Error('boom'); } } });
+}, /boom/);
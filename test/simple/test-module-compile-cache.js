@@ -0,0 +1,87 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+var spawnSync = require('child_process').spawnSync;
+
+var cacheDir = path.join(common.tmpDir, 'compile-cache');
+var modulePath = path.join(common.tmpDir, 'compile-cache-module.js');
+
+function rmrf(dir) {
+  try {
+    fs.readdirSync(dir).forEach(function(file) {
+      fs.unlinkSync(path.join(dir, file));
+    });
+    fs.rmdirSync(dir);
+  } catch (e) {}
+}
+
+function run() {
+  var env = {};
+  for (var key in process.env)
+    env[key] = process.env[key];
+  env.NODE_COMPILE_CACHE = cacheDir;
+
+  var child = spawnSync(process.execPath, [modulePath], { env: env });
+  assert.strictEqual(child.status, 0, String(child.stderr));
+  return String(child.stdout);
+}
+
+function cacheFiles() {
+  return fs.readdirSync(cacheDir).filter(function(file) {
+    return /^compile-cache-module\.js\..*\.cache$/.test(file);
+  });
+}
+
+rmrf(cacheDir);
+fs.writeFileSync(modulePath, 'console.log(require("path").sep.length);');
+
+// Cold: compiled from source, cache written
+assert.strictEqual(run(), '1\n');
+var files = cacheFiles();
+assert.strictEqual(files.length, 1);
+var cacheFile = path.join(cacheDir, files[0]);
+var cached = fs.readFileSync(cacheFile);
+assert.ok(cached.length > 0);
+
+// Warm: cache used and left alone
+assert.strictEqual(run(), '1\n');
+assert.deepEqual(fs.readFileSync(cacheFile), cached);
+
+// Corrupted: recompiled and rewritten
+var corrupted = new Buffer(cached);
+corrupted[corrupted.length - 1] ^= 0xff;
+fs.writeFileSync(cacheFile, corrupted);
+assert.strictEqual(run(), '1\n');
+assert.notDeepEqual(fs.readFileSync(cacheFile), corrupted);
+
+// Changed source: recompiled and rewritten
+fs.writeFileSync(modulePath, 'console.log(require("path").sep.length + 1);');
+assert.strictEqual(run(), '2\n');
+assert.strictEqual(cacheFiles().length, 1);
+assert.notDeepEqual(fs.readFileSync(cacheFile), cached);
+
+rmrf(cacheDir);
+fs.unlinkSync(modulePath);
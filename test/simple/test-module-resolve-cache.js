@@ -0,0 +1,153 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var path = require('path');
+var spawnSync = require('child_process').spawnSync;
+var binding = process.binding('fs');
+
+// Binding helpers used by the resolver
+var packages = path.join(common.fixturesDir, 'packages');
+var mainPackage = path.join(packages, 'main', 'package.json');
+
+assert.strictEqual(binding.internalModuleStat(mainPackage), 0);
+assert.strictEqual(binding.internalModuleStat(packages), 1);
+assert.ok(binding.internalModuleStat(path.join(packages, 'nope')) < 0);
+
+assert.strictEqual(binding.internalModuleFindFile([
+  path.join(packages, 'nope'),
+  packages,
+  mainPackage
+]), 2);
+assert.strictEqual(binding.internalModuleFindFile([packages]), -1);
+assert.strictEqual(binding.internalModuleFindFile([]), -1);
+
+assert.strictEqual(binding.internalModuleReadJSON(mainPackage),
+                   fs.readFileSync(mainPackage, 'utf8'));
+assert.strictEqual(binding.internalModuleReadJSON(path.join(packages, 'nope')),
+                   undefined);
+
+var noMain = path.join(common.tmpDir, 'no-main.json');
+fs.writeFileSync(noMain, '{"name":"no-main","version":"1.0.0"}');
+assert.strictEqual(binding.internalModuleReadJSON(noMain), '');
+fs.unlinkSync(noMain);
+
+// Persisted resolution map
+var cacheFile = path.join(common.tmpDir, 'resolve-cache.json');
+var app = path.join(common.tmpDir, 'resolve-cache-app');
+var cwd = path.join(app, 'sub');
+
+function rmrf(p) {
+  if (binding.internalModuleStat(p) === 1) {
+    fs.readdirSync(p).forEach(function(name) {
+      rmrf(path.join(p, name));
+    });
+    fs.rmdirSync(p);
+  } else if (binding.internalModuleStat(p) === 0) {
+    fs.unlinkSync(p);
+  }
+}
+
+function mkdirp(dir) {
+  if (binding.internalModuleStat(dir) === 1) return;
+  mkdirp(path.dirname(dir));
+  fs.mkdirSync(dir);
+}
+
+function run(request) {
+  var env = {};
+  for (var key in process.env)
+    env[key] = process.env[key];
+  env.NODE_RESOLVE_CACHE = cacheFile;
+
+  var script = 'console.log(require(' + JSON.stringify(request) + ').ok);';
+  var child = spawnSync(process.execPath, ['-e', script], {
+    cwd: cwd,
+    env: env
+  });
+  assert.strictEqual(child.status, 0, String(child.stderr));
+  return String(child.stdout).trim();
+}
+
+function readCache() {
+  return JSON.parse(fs.readFileSync(cacheFile, 'utf8'));
+}
+
+rmrf(app);
+rmrf(cacheFile);
+mkdirp(cwd);
+mkdirp(path.join(app, 'node_modules', 'pkg'));
+fs.writeFileSync(path.join(app, 'node_modules', 'pkg', 'package.json'),
+                 '{"main":"a.js"}');
+fs.writeFileSync(path.join(app, 'node_modules', 'pkg', 'a.js'),
+                 'exports.ok = "a";');
+fs.writeFileSync(path.join(app, 'node_modules', 'pkg', 'b.js'),
+                 'exports.ok = "b";');
+mkdirp(path.join(cwd, 'foo'));
+fs.writeFileSync(path.join(cwd, 'foo', 'index.js'), 'exports.ok = "dir";');
+
+assert.strictEqual(run('pkg'), 'a');
+var cache = readCache();
+var keys = Object.keys(cache.entries);
+assert.strictEqual(keys.length, 1);
+assert.strictEqual(cache.entries[keys[0]].filename,
+                   fs.realpathSync(path.join(app, 'node_modules', 'pkg',
+                                             'a.js')));
+
+// An unchanged tree is served from the cache without rewriting it
+var before = fs.readFileSync(cacheFile, 'utf8');
+assert.strictEqual(run('pkg'), 'a');
+assert.strictEqual(fs.readFileSync(cacheFile, 'utf8'), before);
+
+// A changed "main" is noticed
+fs.writeFileSync(path.join(app, 'node_modules', 'pkg', 'package.json'),
+                 '{"main":"b.js"}');
+assert.strictEqual(run('pkg'), 'b');
+
+// So is a package installed into a node_modules folder closer to the caller
+mkdirp(path.join(cwd, 'node_modules', 'pkg'));
+fs.writeFileSync(path.join(cwd, 'node_modules', 'pkg', 'index.js'),
+                 'exports.ok = "closer";');
+assert.strictEqual(run('pkg'), 'closer');
+
+// ...and its removal
+rmrf(path.join(cwd, 'node_modules'));
+assert.strictEqual(run('pkg'), 'b');
+
+// A file that now takes precedence over a directory
+assert.strictEqual(run('./foo'), 'dir');
+fs.writeFileSync(path.join(cwd, 'foo.js'), 'exports.ok = "file";');
+assert.strictEqual(run('./foo'), 'file');
+
+// A broken or outdated cache file is ignored and replaced
+fs.writeFileSync(cacheFile, '{');
+assert.strictEqual(run('pkg'), 'b');
+assert.strictEqual(Object.keys(readCache().entries).length, 1);
+
+fs.writeFileSync(cacheFile, JSON.stringify({ 'x': '/nope.js' }));
+assert.strictEqual(run('pkg'), 'b');
+assert.strictEqual(readCache().version, 2);
+
+rmrf(cacheFile);
+rmrf(app);
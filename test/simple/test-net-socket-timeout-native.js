@@ -0,0 +1,77 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+// Idle timeouts of TCP sockets are tracked by the handle.  Reads and writes
+// push the timeout back, and it fires again after new activity.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var T = 100;
+var timeouts = 0;
+var writes = 0;
+
+var server = net.createServer(function(c) {
+  c.on('data', function() {});
+  c.on('end', function() {
+    c.end();
+  });
+});
+
+server.listen(common.PORT, function() {
+  var socket = net.connect(common.PORT);
+
+  // Set before connect(), there is no handle yet.
+  socket.setTimeout(T);
+
+  socket.on('connect', function() {
+    assert.equal(typeof socket._handle.setIdleTimeout, 'function');
+    assert.ok(socket._idleNative);
+
+    // Keep the socket busy for a while, no timeout.
+    var interval = setInterval(function() {
+      socket.write('x');
+      if (++writes === 10)
+        clearInterval(interval);
+    }, T / 4);
+  });
+
+  socket.on('timeout', function() {
+    timeouts++;
+    assert.equal(writes, 10);
+
+    if (timeouts === 1) {
+      // Activity after a timeout rearms it.
+      socket.write('y');
+      return;
+    }
+
+    socket.setTimeout(0);
+    socket.end();
+    server.close();
+  });
+});
+
+process.on('exit', function() {
+  assert.equal(timeouts, 2);
+});
@@ -0,0 +1,76 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Sockets with different idle timeouts, and a busy socket that shares its
+// timeout with an idle one, time out in deadline order.
+
+var common = require('../common');
+var assert = require('assert');
+var net = require('net');
+
+var T = 100;
+var order = [];
+var sockets = [];
+
+var server = net.createServer(function(c) {
+  c.on('data', function() {});
+  c.on('end', function() {
+    c.end();
+  });
+});
+
+function connect(name, timeout, busy) {
+  var socket = net.connect(common.PORT);
+  socket.setTimeout(timeout);
+  sockets.push(socket);
+
+  socket.on('connect', function() {
+    if (!busy)
+      return;
+    var writes = 0;
+    var interval = setInterval(function() {
+      socket.write('x');
+      if (++writes === 16)
+        clearInterval(interval);
+    }, T / 4);
+  });
+
+  socket.on('timeout', function() {
+    order.push(name);
+    socket.setTimeout(0);
+    if (order.length === sockets.length) {
+      sockets.forEach(function(s) {
+        s.end();
+      });
+      server.close();
+    }
+  });
+}
+
+server.listen(common.PORT, function() {
+  connect('busy', T, true);
+  connect('long', 2 * T, false);
+  connect('short', T, false);
+});
+
+process.on('exit', function() {
+  assert.deepEqual(order, ['short', 'long', 'busy']);
+});
@@ -0,0 +1,195 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var qs = require('querystring');
+var vm = require('vm');
+
+// Load a second copy of the querystring module that never takes the native
+// fast path and check that both produce the same results.
+var fakeProcess = Object.create(process);
+fakeProcess.binding = function(name) {
+  if (name !== 'querystring')
+    return process.binding(name);
+  return {
+    parse: function() {},
+    stringify: function() {}
+  };
+};
+var jsQs = {};
+vm.runInThisContext('(function(exports, require, process) {' +
+                    process.binding('natives').querystring + '\n})')(
+    jsQs, require, fakeProcess);
+
+function checkParse(input, sep, eq, options) {
+  var expected = jsQs.parse(input, sep, eq, options);
+  var actual = qs.parse(input, sep, eq, options);
+  assert.deepEqual(actual, expected, JSON.stringify(input));
+  assert.deepEqual(Object.keys(actual), Object.keys(expected));
+  Object.keys(expected).forEach(function(key) {
+    assert.strictEqual(typeof actual[key], typeof expected[key]);
+  });
+}
+
+[
+  'a=b',
+  'a=b&c=d',
+  'a=b&a=c&a=d',
+  'a&b&c',
+  'a=&=b&=',
+  '&&a=b&&',
+  '&',
+  '=',
+  'a=b=c',
+  'a+b=c+d',
+  'a%20b=c%20d',
+  '%41%42%43=%61%62%63',
+  '%c3%a9t%C3%A9=%E2%82%AC',
+  '%F0%9F%98%80=%f0%9f%98%80',
+  'a=%',
+  'a=%4',
+  'a=%zz',
+  'a=%4g&b=c',
+  'a=%ff',
+  'a=%c3',
+  'a=%c3%28',
+  'a=%e0%80%80',
+  'a=%ed%a0%80',
+  'a=%f4%90%80%80',
+  'a=%c0%80',
+  'a=é',
+  'a=€',
+  'é=1&€=2',
+  '__proto__=1',
+  '__proto__=1&__proto__=2',
+  'hasOwnProperty=1&toString=2&valueOf=3',
+  'constructor=a&constructor=b',
+  '0=a&1=b&0=c',
+  new Array(2000).join('a=b&'),
+  'x=' + new Array(3000).join('abcdefghijklmnop'),
+  new Array(100).join('%e2%82%ac') + '=' + new Array(100).join('+%20')
+].forEach(function(input) {
+  checkParse(input);
+  checkParse(input, '&', '=', { maxKeys: 0 });
+  checkParse(input, '&', '=', { maxKeys: 2 });
+  checkParse(input, '&', '=', { maxKeys: 1.5 });
+  checkParse(input, '&', '=', { maxKeys: NaN });
+  checkParse(input, ';', ':');
+  checkParse(input, '=', '&');
+  checkParse(input, '&', '&');
+  checkParse(input, '+', '=');
+  checkParse(input, '&', '+');
+  checkParse(input, '&', '%');
+  checkParse(input, '%', '=');
+  checkParse(input, '&&', '=');
+  checkParse(input, 'é', '=');
+});
+
+function checkStringify(input, sep, eq, options) {
+  var expected;
+  try {
+    expected = jsQs.stringify(input, sep, eq, options);
+  } catch (e) {
+    assert(e instanceof URIError);
+    assert.throws(function() {
+      qs.stringify(input, sep, eq, options);
+    }, URIError);
+    return;
+  }
+  assert.strictEqual(qs.stringify(input, sep, eq, options), expected);
+}
+
+var withGetter = {};
+Object.defineProperty(withGetter, 'hidden', { value: 1 });
+Object.defineProperty(withGetter, 'shown', {
+  enumerable: true,
+  get: function() { return 'x y'; }
+});
+
+[
+  {},
+  { a: 'b' },
+  { a: 'b', c: 'd' },
+  { 'a b': 'c d', 'e&f': 'g=h', 'i+j': '%' },
+  { a: '-_.!~*\'()' },
+  { a: ';/?:@&=+$,#' },
+  { a: 'été', '€': '😀' },
+  { a: '\ud83d' },
+  { a: '\ude00' },
+  { a: 'x\ud83dy' },
+  { a: 1, b: -1.5, c: 0, d: -0, e: 1e21, f: 1e-7 },
+  { a: NaN, b: Infinity, c: -Infinity },
+  { a: true, b: false },
+  { a: null, b: undefined },
+  { a: {}, b: function() {}, c: new String('x'), d: new Number(1) },
+  { a: ['b', 'c', 'd'] },
+  { a: [] },
+  { a: [1, true, null, ['x'], {}, NaN] },
+  ['a', 'b'],
+  withGetter,
+  Object.create({ inherited: 1 })
+].forEach(function(input) {
+  checkStringify(input);
+  checkStringify(input, ';', ':');
+  checkStringify(input, '&amp;', '==');
+  checkStringify(input, 'é', '€');
+  checkStringify(input, new Array(20).join('&'), '=');
+});
+
+// A custom encoder or decoder bypasses the fast path.
+var calls = 0;
+qs.parse('a=b&c=d', null, null, {
+  decodeURIComponent: function(s) {
+    calls++;
+    return s;
+  }
+});
+assert.equal(calls, 4);
+
+calls = 0;
+qs.stringify({ a: 'b', c: 'd' }, null, null, {
+  encodeURIComponent: function(s) {
+    calls++;
+    return s;
+  }
+});
+assert.equal(calls, 4);
+
+// So does replacing the module's own.
+var unescape = qs.unescape;
+qs.unescape = function(s) { return s.toUpperCase(); };
+assert.deepEqual(qs.parse('a=b'), { A: 'B' });
+qs.unescape = unescape;
+
+var escape = qs.escape;
+qs.escape = function(s) { return s.toUpperCase(); };
+assert.equal(qs.stringify({ a: 'b' }), 'A=B');
+qs.escape = escape;
+
+// Exceptions from getters propagate.
+var throwing = {};
+Object.defineProperty(throwing, 'a', {
+  enumerable: true,
+  get: function() { throw new Error('boom'); }
+});
+assert.throws(function() { qs.stringify(throwing); }, /boom/);
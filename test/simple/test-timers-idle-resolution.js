@@ -0,0 +1,114 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var timers = require('timers');
+var Timer = process.binding('timer_wrap').Timer;
+
+var RESOLUTION = 50;
+
+assert.throws(function() {
+  timers.setIdleTimeoutResolution(-1);
+}, RangeError);
+assert.throws(function() {
+  timers.setIdleTimeoutResolution('nope');
+}, RangeError);
+
+timers.setIdleTimeoutResolution(RESOLUTION);
+
+var fired = {};
+
+function idle(name, msecs, unref) {
+  var item = {
+    start: Timer.now(),
+    _onTimeout: function() {
+      var elapsed = Timer.now() - item.start;
+      // Rounded up to the resolution, but never early.
+      assert.ok(elapsed >= msecs, name + ' fired after ' + elapsed + 'ms');
+      assert.equal(fired[name], undefined);
+      fired[name] = elapsed;
+    }
+  };
+  timers.enroll(item, msecs);
+  if (unref)
+    timers._unrefActive(item);
+  else
+    timers.active(item);
+  return item;
+}
+
+// Many distinct timeouts share the wheel.
+for (var i = 1; i <= 20; i++)
+  idle('ref' + i, i * 7);
+
+// Unref'd items fire as long as something else keeps the loop alive.
+idle('unref', 30, true);
+
+// Unenrolled items don't fire.
+timers.unenroll(idle('unenrolled', 20));
+
+// Refreshing an item pushes its timeout back.
+var refreshed = idle('refreshed', 60);
+setTimeout(function() {
+  refreshed.start = Timer.now();
+  timers.active(refreshed);
+}, 40);
+
+// A throwing callback doesn't keep the other due items from firing.
+var caught = 0;
+process.on('uncaughtException', function(err) {
+  assert.equal(err.message, 'boom');
+  caught++;
+});
+var thrower = idle('thrower', 10);
+thrower._onTimeout = function() {
+  fired.thrower = true;
+  throw new Error('boom');
+};
+
+// setTimeout() stays exact, its timers are not put on the wheel.
+var exactStart = Date.now();
+setTimeout(function() {
+  assert.ok(Date.now() - exactStart < 1000);
+}, 1);
+
+// Going back to exact idle timeouts, the old wheel drains on its own.
+var exact = {
+  _onTimeout: function() {
+    fired.exact = true;
+  }
+};
+timers.setIdleTimeoutResolution(0);
+timers.enroll(exact, 5);
+timers.active(exact);
+timers.setIdleTimeoutResolution(RESOLUTION);
+
+process.on('exit', function() {
+  for (var i = 1; i <= 20; i++)
+    assert.ok(fired['ref' + i] !== undefined, 'ref' + i + ' did not fire');
+  assert.ok(fired.unref !== undefined);
+  assert.ok(fired.refreshed !== undefined);
+  assert.equal(fired.unenrolled, undefined);
+  assert.ok(fired.thrower);
+  assert.ok(fired.exact);
+  assert.equal(caught, 1);
+});
@@ -0,0 +1,104 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+var assert = require('assert');
+var TimerWheel = require('_timer_wheel');
+
+function item(name) {
+  return { name: name, _idleNext: null, _idlePrev: null };
+}
+
+// Empty wheel
+var wheel = new TimerWheel();
+assert.equal(wheel.nextExpiry(), -1);
+wheel.advance(1000, assert.fail);
+assert.equal(wheel.tick, 1001);
+
+// Items fire in order of expiry, on every level of the wheel
+var expiries = [0, 1, 255, 256, 300, 16383, 16384, 20000, 1048576, 5e6,
+                67108864, 7e7, 4e9];
+var fired = [];
+wheel = new TimerWheel();
+expiries.slice().reverse().forEach(function(expiry) {
+  wheel.insert(item(expiry), expiry);
+});
+assert.equal(wheel.size, expiries.length);
+assert.equal(wheel.nextExpiry(), 0);
+
+wheel.advance(4e9, function(item) {
+  assert.ok(item._wheelExpiry <= wheel.tick);
+  fired.push(item.name);
+});
+assert.deepEqual(fired, expiries);
+assert.equal(wheel.size, 0);
+
+// Nothing fires before its expiry, also when advancing one tick at a time
+wheel = new TimerWheel();
+wheel.reset(100);
+var a = item('a');
+var b = item('b');
+var c = item('c');
+wheel.insert(a, 110);
+wheel.insert(b, 400);
+wheel.insert(c, 99);  // in the past, due right away
+fired = [];
+for (var tick = 100; tick <= 500; tick++) {
+  wheel.advance(tick, function(item) {
+    fired.push(item.name + '@' + tick);
+  });
+}
+assert.deepEqual(fired, ['c@100', 'a@110', 'b@400']);
+
+// Removed items don't fire
+wheel = new TimerWheel();
+wheel.insert(a, 10);
+wheel.insert(b, 20000);
+wheel.remove(a);
+wheel.remove(b);
+wheel.remove(b);
+assert.equal(wheel.size, 0);
+assert.equal(wheel.nextExpiry(), -1);
+wheel.advance(30000, assert.fail);
+
+// Callbacks may reinsert items, a callback that throws leaves the rest of
+// the due items for the next advance()
+wheel = new TimerWheel();
+wheel.insert(a, 5);
+wheel.insert(b, 5);
+wheel.insert(c, 6);
+fired = [];
+assert.throws(function() {
+  wheel.advance(10, function(item) {
+    fired.push(item.name);
+    if (item === a) {
+      wheel.insert(a, 8);
+      throw new Error('boom');
+    }
+  });
+});
+assert.deepEqual(fired, ['a']);
+assert.equal(wheel.size, 3);
+wheel.advance(10, function(item) {
+  fired.push(item.name);
+});
+assert.deepEqual(fired, ['a', 'b', 'c', 'a']);
+assert.equal(wheel.size, 0);
@@ -0,0 +1,103 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+
+if (!process.features.tls_ocsp) {
+  console.error('Skipping because node compiled without OpenSSL or ' +
+                'with old OpenSSL version.');
+  process.exit(0);
+}
+
+var assert = require('assert');
+var tls = require('tls');
+var fs = require('fs');
+var join = require('path').join;
+
+var key = fs.readFileSync(join(common.fixturesDir, 'keys', 'agent1-key.pem'));
+var cert = fs.readFileSync(join(common.fixturesDir, 'keys', 'agent1-cert.pem'));
+var ca = fs.readFileSync(join(common.fixturesDir, 'keys', 'ca1-cert.pem'));
+var response = fs.readFileSync(join(common.fixturesDir,
+                                    'keys',
+                                    'agent1-ocsp-response.der'));
+
+// A refresh whose 'OCSPRequest' callback is never called must not block
+// the cache forever: once ocspRefreshTimeout has passed, the next handshake
+// starts a new refresh.
+var ocspCount = 0;
+var stapled = [];
+var server = tls.createServer({
+  key: key,
+  cert: cert,
+  ca: [ca],
+  ocspCache: true,
+  ocspRefreshTimeout: 1
+}, function(cleartext) {
+  cleartext.end();
+});
+
+server.on('OCSPRequest', function(certificate, issuer, callback) {
+  // Lose the first request.
+  if (++ocspCount > 1)
+    callback(null, response);
+});
+
+server.listen(common.PORT, function() {
+  connect(function() {
+    // Still pending, no second refresh yet.
+    connect(function() {
+      assert.equal(ocspCount, 1);
+      setTimeout(afterTimeout, 2100);
+    });
+  });
+});
+
+function afterTimeout() {
+  connect(function() {
+    assert.equal(ocspCount, 2);
+    connect(function() {
+      server.close();
+    });
+  });
+}
+
+function connect(cb) {
+  var client = tls.connect({
+    port: common.PORT,
+    requestOCSP: true,
+    rejectUnauthorized: false
+  });
+  client.on('OCSPResponse', function(resp) {
+    stapled.push(resp);
+  });
+  client.on('close', cb);
+  client.resume();
+}
+
+process.on('exit', function() {
+  assert.equal(ocspCount, 2);
+  assert.equal(stapled.length, 4);
+  // Nothing to staple while the first refresh was pending...
+  assert.equal(stapled[0], null);
+  assert.equal(stapled[1], null);
+  // ...and the response from the retried one afterwards.
+  assert.equal(stapled[3].toString('hex'), response.toString('hex'));
+});
@@ -0,0 +1,115 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+var common = require('../common');
+
+if (!process.features.tls_ocsp) {
+  console.error('Skipping because node compiled without OpenSSL or ' +
+                'with old OpenSSL version.');
+  process.exit(0);
+}
+
+var assert = require('assert');
+var tls = require('tls');
+var fs = require('fs');
+var join = require('path').join;
+
+var key = fs.readFileSync(join(common.fixturesDir, 'keys', 'agent1-key.pem'));
+var cert = fs.readFileSync(join(common.fixturesDir, 'keys', 'agent1-cert.pem'));
+var ca = fs.readFileSync(join(common.fixturesDir, 'keys', 'ca1-cert.pem'));
+var response = fs.readFileSync(join(common.fixturesDir,
+                                    'keys',
+                                    'agent1-ocsp-response.der'));
+
+// SecureContext validates and caches responses.
+(function() {
+  var context = tls.createSecureContext({
+    key: key,
+    cert: cert,
+    ca: [ca]
+  }).context;
+
+  var refreshAt = context.setOCSPResponse(response);
+  assert.equal(typeof refreshAt, 'number');
+  assert.ok(refreshAt > Date.now());
+
+  assert.throws(function() {
+    context.setOCSPResponse(new Buffer('hello world'));
+  }, /Invalid OCSP response/);
+  assert.throws(function() {
+    context.setOCSPResponse('hello world');
+  }, TypeError);
+
+  context.clearOCSPResponse();
+})();
+
+// The first handshake that asks for a certificate status fills the cache,
+// the following ones are served from it without emitting 'OCSPRequest'.
+var ocspCount = 0;
+var responses = [];
+var server = tls.createServer({
+  key: key,
+  cert: cert,
+  ca: [ca],
+  ocspCache: true
+}, function(cleartext) {
+  cleartext.end();
+});
+
+server.on('OCSPRequest', function(certificate, issuer, callback) {
+  ++ocspCount;
+  assert.ok(Buffer.isBuffer(certificate));
+  assert.ok(Buffer.isBuffer(issuer));
+  callback(null, response);
+});
+
+server.listen(common.PORT, function() {
+  connect(3, function() {
+    server.close();
+  });
+});
+
+function connect(n, cb) {
+  if (n === 0)
+    return cb();
+
+  var client = tls.connect({
+    port: common.PORT,
+    requestOCSP: true,
+    rejectUnauthorized: false
+  });
+  client.on('OCSPResponse', function(resp) {
+    responses.push(resp);
+  });
+  client.on('close', function() {
+    connect(n - 1, cb);
+  });
+  client.resume();
+}
+
+process.on('exit', function() {
+  assert.equal(ocspCount, 1);
+  assert.equal(responses.length, 3);
+  responses.forEach(function(resp) {
+    assert.ok(Buffer.isBuffer(resp));
+    assert.equal(resp.toString('hex'), response.toString('hex'));
+  });
+});
@@ -0,0 +1,138 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+if (!process.features.tls_sni) {
+  console.error('Skipping because node compiled without OpenSSL or ' +
+                'with old OpenSSL version.');
+  process.exit(0);
+}
+
+var common = require('../common');
+var assert = require('assert');
+var fs = require('fs');
+var tls = require('tls');
+var SNIContextMap = process.binding('tls_wrap').SNIContextMap;
+
+function loadPEM(n) {
+  return fs.readFileSync(common.fixturesDir + '/keys/' + n + '.pem');
+}
+
+function context(n) {
+  return tls.createSecureContext({
+    key: loadPEM(n + '-key'),
+    cert: loadPEM(n + '-cert')
+  }).context;
+}
+
+var agent1 = context('agent1');
+var agent2 = context('agent2');
+var agent3 = context('agent3');
+
+// Map semantics
+var map = new SNIContextMap();
+map.add('a.example.com', agent1);
+map.add('*.test.com', agent2);
+map.add('x.test.com', agent3);
+map.add('w*b.example.org', agent3);
+map.add('a.example.com', agent3);
+
+assert.strictEqual(map.lookup('a.example.com'), agent1);
+assert.strictEqual(map.lookup('A.Example.COM'), agent1);
+assert.strictEqual(map.lookup('b.test.com'), agent2);
+assert.strictEqual(map.lookup('.test.com'), agent2);
+// First pattern added wins, as with the old RegExp list
+assert.strictEqual(map.lookup('x.test.com'), agent2);
+// Wildcards never cross a label boundary
+assert.strictEqual(map.lookup('a.b.test.com'), undefined);
+assert.strictEqual(map.lookup('test.com'), undefined);
+assert.strictEqual(map.lookup('wb.example.org'), agent3);
+assert.strictEqual(map.lookup('web.example.org'), agent3);
+assert.strictEqual(map.lookup('webs.example.org'), undefined);
+assert.strictEqual(map.lookup('example.com'), undefined);
+assert.strictEqual(map.lookup(''), undefined);
+
+assert.throws(function() { map.add('', agent1); }, TypeError);
+assert.throws(function() { map.add('a.com', {}); }, TypeError);
+
+// Lots of tenants, exact and wildcard, to exercise the per-label hash tables
+var tenants = new SNIContextMap();
+for (var i = 0; i < 5000; i++) {
+  tenants.add('tenant' + i + '.example.com', i % 2 ? agent1 : agent2);
+  tenants.add('*.tenant' + i + '.example.com', agent3);
+}
+for (var i = 0; i < 5000; i += 499) {
+  assert.strictEqual(tenants.lookup('tenant' + i + '.example.com'),
+                     i % 2 ? agent1 : agent2);
+  assert.strictEqual(tenants.lookup('www.tenant' + i + '.example.com'),
+                     agent3);
+}
+assert.strictEqual(tenants.lookup('tenant5000.example.com'), undefined);
+assert.strictEqual(tenants.lookup('a.b.tenant1.example.com'), undefined);
+
+// A custom SNICallback only runs for servernames missing from the map
+var callbackNames = [];
+var serverNames = [];
+var server = tls.createServer({
+  key: loadPEM('agent2-key'),
+  cert: loadPEM('agent2-cert'),
+  SNICallback: function(servername, cb) {
+    callbackNames.push(servername);
+    cb(null, tls.createSecureContext({
+      key: loadPEM('agent3-key'),
+      cert: loadPEM('agent3-cert')
+    }));
+  }
+}, function(c) {
+  serverNames.push(c.servername);
+});
+server.addContext('*.example.com', {
+  key: loadPEM('agent1-key'),
+  cert: loadPEM('agent1-cert')
+});
+
+var names = ['a.example.com', 'b.test.com'];
+var subjects = [];
+
+server.listen(common.PORT, function() {
+  var i = 0;
+  function next() {
+    if (i === names.length)
+      return server.close();
+
+    var client = tls.connect({
+      port: common.PORT,
+      servername: names[i++],
+      rejectUnauthorized: false
+    }, function() {
+      subjects.push(client.getPeerCertificate().subject.CN);
+      client.destroy();
+      next();
+    });
+  }
+  next();
+});
+
+process.on('exit', function() {
+  assert.deepEqual(serverNames, names);
+  assert.deepEqual(callbackNames, ['b.test.com']);
+  assert.deepEqual(subjects, ['agent1', 'agent3']);
+});
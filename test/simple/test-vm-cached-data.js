@@ -0,0 +1,93 @@
+// Copyright Joyent, Inc. and other Node contributors.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit
+// persons to whom the Software is furnished to do so, subject to the
+// following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN
+// NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE
+// USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+var common = require('../common');
+var assert = require('assert');
+var vm = require('vm');
+
+function source(n) {
+  return '(function(a, b) { return a + b + ' + n + '; })(1, 2);';
+}
+
+// Produce
+var script = new vm.Script(source(1), { produceCachedData: true });
+assert.ok(Buffer.isBuffer(script.cachedData));
+assert.ok(script.cachedData.length > 0);
+assert.strictEqual(script.cachedDataRejected, undefined);
+assert.strictEqual(script.runInThisContext(), 4);
+var cachedData = script.cachedData;
+
+// Not produced unless asked for
+assert.strictEqual(new vm.Script(source(1)).cachedData, undefined);
+
+// Consume
+script = new vm.Script(source(1), {
+  cachedData: cachedData,
+  produceCachedData: true
+});
+assert.strictEqual(script.cachedDataRejected, false);
+assert.strictEqual(script.cachedData, undefined);
+assert.strictEqual(script.runInThisContext(), 4);
+
+// Different source
+script = new vm.Script(source(2), { cachedData: cachedData });
+assert.strictEqual(script.cachedDataRejected, true);
+assert.strictEqual(script.runInThisContext(), 5);
+
+// Rejected data is replaced when asked for
+script = new vm.Script(source(3), {
+  cachedData: cachedData,
+  produceCachedData: true
+});
+assert.strictEqual(script.cachedDataRejected, true);
+assert.ok(Buffer.isBuffer(script.cachedData));
+assert.strictEqual(script.runInThisContext(), 6);
+
+// Corrupted or truncated data
+var corrupted = new Buffer(cachedData);
+corrupted[corrupted.length - 1] ^= 0xff;
+script = new vm.Script(source(1), { cachedData: corrupted });
+assert.strictEqual(script.cachedDataRejected, true);
+assert.strictEqual(script.runInThisContext(), 4);
+
+script = new vm.Script(source(1), {
+  cachedData: cachedData.slice(0, cachedData.length >>> 1)
+});
+assert.strictEqual(script.cachedDataRejected, true);
+
+script = new vm.Script(source(1), { cachedData: new Buffer(0) });
+assert.strictEqual(script.cachedDataRejected, true);
+
+assert.throws(function() {
+  new vm.Script(source(1), { cachedData: 'nope' });
+}, TypeError);
+
+// Data produced under other V8 flags is rejected.  The flag keeps its
+// default value, setting it is enough to change the flags hash.
+cachedData = new vm.Script(source(4), { produceCachedData: true }).cachedData;
+script = new vm.Script(source(4), { cachedData: cachedData });
+assert.strictEqual(script.cachedDataRejected, false);
+
+require('tracing').v8.setFlagsFromString('--max_inlined_source_size=600');
+script = new vm.Script(source(4), { cachedData: cachedData });
+assert.strictEqual(script.cachedDataRejected, true);
+assert.strictEqual(script.runInThisContext(), 7);